@@ -36,6 +36,11 @@
  * Thus, the "result" passed as a parameter must also be properly initialized.
  */
 
+/**
+ * The number of columns of a block in cfe_mat_mul_mod.
+ */
+#define CFE_MAT_BLOCK 64
+
 /**
  * Matrix of arbitrary precision (GMP) integers.
  * It represents a row-major matrix. A matrix of dimensions i, j consists of i
@@ -126,6 +131,15 @@ void cfe_mat_mul_vec(cfe_vec *res, cfe_mat *m, cfe_vec *v);
  */
 void cfe_mat_mul(cfe_mat *res, cfe_mat *m1, cfe_mat *m2);
 
+/**
+ * Matrix multiplication modulo mod, with the elements of the result reduced
+ * to [0, mod). The result must not be the same as any of the factors.
+ * Each row of the result is accumulated in blocks of CFE_MAT_BLOCK columns
+ * and reduced once per element, and the rows are split among num_threads
+ * threads (0 is treated as 1).
+ */
+void cfe_mat_mul_mod(cfe_mat *res, cfe_mat *m1, cfe_mat *m2, mpz_t mod, size_t num_threads);
+
 /**
  * Checks if all elements are < bound.
  * @return false if any element is >= bound, true otherwise
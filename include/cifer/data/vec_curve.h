@@ -97,6 +97,21 @@ void cfe_vec_mul_G1(cfe_vec_G1 *v, cfe_vec *u);
  */
 void cfe_vec_mul_vec_G1(cfe_vec_G1 *res, cfe_vec *u, cfe_vec_G1 *v);
 
+/**
+ * Calculates the sum of u[i] * v[i] over all i, where v[i] is an element
+ * in ECP_BN254. Pairs of terms are computed together with a simultaneous
+ * double scalar multiplication, and negative integers negate the points,
+ * so that short integers of either sign stay cheap. The absolute values of
+ * the integers must be smaller than the order of the group, and the sizes
+ * of u and v must match.
+ *
+ * @param res A pointer to an ECP_BN254 element (the result will be stored
+ * here)
+ * @param u A pointer to vector of integers
+ * @param v A pointer to a cfe_vec_G1 vector
+ */
+void cfe_vec_dot_G1(ECP_BN254 *res, cfe_vec *u, cfe_vec_G1 *v);
+
 /**
  * Initializes a vector of ECP2_BN254 elements of given size.
  *
@@ -239,4 +239,23 @@ cfe_error cfe_damgard_dec_multi_decrypt(mpz_t res, cfe_vec *ciphers,
                                         cfe_damgard_dec_multi_fe_key_part *fe_key_parts, cfe_mat *y,
                                         cfe_damgard_dec_multi_dec *d);
 
+/**
+ * The same as cfe_damgard_dec_multi_decrypt, but the discrete logarithm is computed
+ * with the given configuration, which sets the algorithm, the number of
+ * threads and the size of the table of baby steps.
+ *
+ * @param res The result of the decryption (the value will be stored here)
+ * @param ciphers An array of the encrypted coordinates of the vector
+ * @param fe_key_parts An array of the decryption key shares
+ * @param y A pointer to the inner-product matrix
+ * @param d A pointer to an instance of the decryptor.(*initialized* cfe_damgard_dec_multi_dec
+ * struct)
+ * @param c A pointer to the configuration of the discrete logarithm (see
+ * cfe_dlog_config); if NULL, the default configuration is used
+ * @return Error code
+ */
+cfe_error cfe_damgard_dec_multi_decrypt_with_config(mpz_t res, cfe_vec *ciphers,
+                                                    cfe_damgard_dec_multi_fe_key_part *fe_key_parts, cfe_mat *y,
+                                                    cfe_damgard_dec_multi_dec *d, cfe_dlog_config *c);
+
 #endif
@@ -228,6 +228,40 @@ void cfe_damgard_multi_ciphertext_init(cfe_vec *ciphertext, cfe_damgard_multi_cl
 cfe_error
 cfe_damgard_multi_encrypt(cfe_vec *ciphertext, cfe_damgard_multi_client *e, cfe_vec *x, cfe_vec *pub_key, cfe_vec *otp);
 
+/**
+ * Prepares the public key of the client for encryption by precomputing the
+ * powers of its elements. The prepared key can be built once and reused by
+ * cfe_damgard_multi_encrypt_prep for encrypting many vectors. It needs to
+ * be freed with cfe_fixed_base_vec_free.
+ *
+ * @param pk A pointer to an uninitialized cfe_fixed_base_vec struct
+ * @param e A pointer to an instance of the encryptor (*initialized*
+ * cfe_damgard_multi_client struct)
+ * @param pub_key A pointer to the public key vector
+ * @param memory_budget The size of the prepared key in bytes; if 0, a
+ * default size is used
+ * @return Error code
+ */
+cfe_error cfe_damgard_multi_prep_pub_key_init(cfe_fixed_base_vec *pk, cfe_damgard_multi_client *e, cfe_vec *pub_key,
+                                              size_t memory_budget);
+
+/**
+ * The same as cfe_damgard_multi_encrypt, but it uses a prepared public key
+ * (see cfe_damgard_multi_prep_pub_key_init).
+ *
+ * @param ciphertext A pointer to a vector (the resulting ciphertext will be
+ * stored here)
+ * @param e A pointer to an instance of the encryptor (*initialized*
+ * cfe_damgard_multi_client struct)
+ * @param x A pointer to the input vector
+ * @param pk A pointer to a key prepared with
+ * cfe_damgard_multi_prep_pub_key_init
+ * @param otp A pointer to the one-time pad vector
+ * @return Error code
+ */
+cfe_error cfe_damgard_multi_encrypt_prep(cfe_vec *ciphertext, cfe_damgard_multi_client *e, cfe_vec *x,
+                                         cfe_fixed_base_vec *pk, cfe_vec *otp);
+
 /**
  * Accepts the matrix cipher comprised of encrypted vectors, functional
  * encryption key, and a matrix y comprised of plaintext vectors. It returns
@@ -245,4 +279,55 @@ cfe_damgard_multi_encrypt(cfe_vec *ciphertext, cfe_damgard_multi_client *e, cfe_
 cfe_error cfe_damgard_multi_decrypt(mpz_t res, cfe_damgard_multi *m, cfe_vec *ciphertext,
                                     cfe_damgard_multi_fe_key *fe_key, cfe_mat *y);
 
+/**
+ * The same as cfe_damgard_multi_decrypt, but the discrete logarithm is computed
+ * with the given configuration, which sets the algorithm, the number of
+ * threads and the size of the table of baby steps.
+ *
+ * @param res The result of the decryption (the value will be stored here)
+ * @param m A pointer to an instance of the scheme (*initialized* cfe_damgard_multi
+ * struct)
+ * @param ciphertext An array comprised of encrypted vectors
+ * @param fe_key An functional encryption key represented as an array of
+ * the parts of functional encryption keys.
+ * @param y A pointer to the matrix comprised of plaintext inner product vectors
+ * @param c A pointer to the configuration of the discrete logarithm (see
+ * cfe_dlog_config); if NULL, the default configuration is used
+ * @return Error code
+ */
+cfe_error cfe_damgard_multi_decrypt_with_config(mpz_t res, cfe_damgard_multi *m, cfe_vec *ciphertext,
+                                                cfe_damgard_multi_fe_key *fe_key, cfe_mat *y, cfe_dlog_config *c);
+
+/**
+ * Initializes the table of baby steps needed for computing the discrete
+ * logarithm at the end of decryption. The table only depends on the scheme
+ * instance, so it can be built once and reused by
+ * cfe_damgard_multi_decrypt_with_table for decrypting many ciphertexts.
+ *
+ * @param t A pointer to an uninitialized cfe_dlog_table struct
+ * @param m A pointer to an instance of the scheme (*initialized* cfe_damgard_multi
+ * struct)
+ * @return Error code
+ */
+cfe_error cfe_damgard_multi_dlog_table_init(cfe_dlog_table *t, cfe_damgard_multi *m);
+
+/**
+ * The same as cfe_damgard_multi_decrypt, but it uses a precomputed table of
+ * baby steps (see cfe_damgard_multi_dlog_table_init) for computing the
+ * discrete logarithm.
+ *
+ * @param res The result of the decryption (the value will be stored here)
+ * @param m A pointer to an instance of the scheme (*initialized* cfe_damgard_multi
+ * struct)
+ * @param ciphertext An array comprised of encrypted vectors
+ * @param fe_key An functional encryption key represented as an array of
+ * the parts of functional encryption keys.
+ * @param y A pointer to the matrix comprised of plaintext inner product vectors
+ * @param t A pointer to a table initialized with
+ * cfe_damgard_multi_dlog_table_init
+ * @return Error code
+ */
+cfe_error cfe_damgard_multi_decrypt_with_table(mpz_t res, cfe_damgard_multi *m, cfe_vec *ciphertext,
+                                               cfe_damgard_multi_fe_key *fe_key, cfe_mat *y, cfe_dlog_table *t);
+
 #endif
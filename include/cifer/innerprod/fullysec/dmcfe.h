@@ -20,6 +20,7 @@
 
 #include "cifer/data/mat.h"
 #include "cifer/data/vec_curve.h"
+#include "cifer/internal/dlog.h"
 
 /**
  * \file
@@ -123,4 +124,74 @@ void cfe_dmcfe_derive_fe_key_part(cfe_vec_G2 *fe_key_part, cfe_dmcfe_client *c,
 cfe_error cfe_dmcfe_decrypt(mpz_t res, ECP_BN254 *ciphers, cfe_vec_G2 *key_shares,
                             char *label, size_t label_len, cfe_vec *y, mpz_t bound);
 
+/**
+ * The same as cfe_dmcfe_decrypt, but the discrete logarithm is computed
+ * with the given configuration, which sets the algorithm, the number of
+ * threads and the size of the table of baby steps.
+ *
+ * @param res The result of the decryption (the value will be stored here)
+ * @param ciphers An array of the encrypted coordinates of the vector
+ * @param key_shares An array of the decryption key shares
+ * @param label A string label of the encrypted value
+ * @param label_len The length of the label to prevent non NULL terminated strings
+ * @param y A pointer to the inner-product vector
+ * @param bound A bound on all the values of the encrypted vector and inner-product
+ * vector
+ * @param c A pointer to the configuration of the discrete logarithm (see
+ * cfe_dlog_config); if NULL, the default configuration is used
+ * @return Error code
+ */
+cfe_error cfe_dmcfe_decrypt_with_config(mpz_t res, ECP_BN254 *ciphers, cfe_vec_G2 *key_shares,
+                                        char *label, size_t label_len, cfe_vec *y, mpz_t bound, cfe_dlog_config *c);
+
+
+/**
+ * Initializes the table of baby steps for computing the discrete logarithm
+ * needed for the decryption of inner products of vectors of the given length,
+ * with all the values bounded by bound. The table can be reused for many
+ * decryptions with cfe_dmcfe_decrypt_with_table, or saved with
+ * cfe_dlog_table_FP12_BN254_save.
+ *
+ * @param t A pointer to an uninitialized cfe_dlog_table_FP12_BN254 struct;
+ * it needs to be freed with cfe_dlog_table_FP12_BN254_free
+ * @param num_clients The number of clients (the length of vectors)
+ * @param bound A bound on all the values of the encrypted vector and
+ * inner-product vector
+ * @return Error code
+ */
+cfe_error cfe_dmcfe_dlog_table_init(cfe_dlog_table_FP12_BN254 *t, size_t num_clients, mpz_t bound);
+
+/**
+ * Maps a table of baby steps saved with cfe_dlog_table_FP12_BN254_save
+ * into memory (see cfe_dlog_table_FP12_BN254_load). An error is returned if
+ * the table was not generated for the given number of clients and bound.
+ *
+ * @param t A pointer to an uninitialized cfe_dlog_table_FP12_BN254 struct;
+ * it needs to be freed with cfe_dlog_table_FP12_BN254_free
+ * @param path Path to the file with the table
+ * @param num_clients The number of clients (the length of vectors)
+ * @param bound A bound on all the values of the encrypted vector and
+ * inner-product vector
+ * @return Error code
+ */
+cfe_error cfe_dmcfe_dlog_table_load(cfe_dlog_table_FP12_BN254 *t, const char *path, size_t num_clients,
+                                    mpz_t bound);
+
+/**
+ * The same as cfe_dmcfe_decrypt, but it uses a precomputed table of baby
+ * steps (see cfe_dmcfe_dlog_table_init and cfe_dmcfe_dlog_table_load) for
+ * computing the discrete logarithm.
+ *
+ * @param res The result of the decryption (the value will be stored here)
+ * @param ciphers An array of the encrypted coordinates of the vector
+ * @param key_shares An array of the decryption key shares
+ * @param label A string label of the encrypted value
+ * @param label_len The length of the label to prevent non NULL terminated strings
+ * @param y A pointer to the inner-product vector
+ * @param t A pointer to an *initialized* table of baby steps
+ * @return Error code
+ */
+cfe_error cfe_dmcfe_decrypt_with_table(mpz_t res, ECP_BN254 *ciphers, cfe_vec_G2 *key_shares,
+                                       char *label, size_t label_len, cfe_vec *y, cfe_dlog_table_FP12_BN254 *t);
+
 #endif
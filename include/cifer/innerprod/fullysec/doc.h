@@ -28,6 +28,7 @@
  * For instantiation from the decisional Diffie-Hellman assumption (DDH), see
  * struct damgard (and its multi-input variant damgard_multi, which is a secret
  * key scheme, because a part of the secret key is required for the encryption).
+ * The same scheme over an elliptic curve is implemented by struct damgard_ec.
  *
  * For instantiation from learning with errors (LWE), see struct lwe_fs.
  *
@@ -19,6 +19,7 @@
 
 #include "cifer/data/mat.h"
 #include "cifer/data/mat_curve.h"
+#include "cifer/internal/dlog.h"
 
 /**
  * \file
@@ -200,4 +201,22 @@ cfe_error cfe_fh_multi_ipe_encrypt(cfe_vec_G1 *cipher, cfe_vec *x,
 cfe_error cfe_fh_multi_ipe_decrypt(mpz_t res, cfe_vec_G1 *ciphers, cfe_mat_G2 *fe_key,
                                    FP12_BN254 *pub_key, cfe_fh_multi_ipe *c);
 
+/**
+ * The same as cfe_fh_multi_ipe_decrypt, but the discrete logarithm is computed
+ * with the given configuration, which sets the algorithm, the number of
+ * threads and the size of the table of baby steps.
+ *
+ * @param res The result of the decryption (the value will be stored here)
+ * @param ciphers An array of the ciphertexts
+ * @param fe_key A pointer to the functional encryption key
+ * @param pub_key A pointer to the public key
+ * @param c A pointer to an instance of the scheme (*initialized*
+ * cfe_fh_multi_ipe struct)
+ * @param conf A pointer to the configuration of the discrete logarithm (see
+ * cfe_dlog_config); if NULL, the default configuration is used
+ * @return Error code
+ */
+cfe_error cfe_fh_multi_ipe_decrypt_with_config(mpz_t res, cfe_vec_G1 *ciphers, cfe_mat_G2 *fe_key,
+                                               FP12_BN254 *pub_key, cfe_fh_multi_ipe *c, cfe_dlog_config *conf);
+
 #endif
@@ -19,6 +19,7 @@
 
 #include "cifer/data/mat.h"
 #include "cifer/data/vec_curve.h"
+#include "cifer/internal/dlog.h"
 
 /**
  * \file
@@ -207,4 +208,21 @@ cfe_error cfe_fhipe_encrypt(cfe_fhipe_ciphertext *cipher, cfe_vec *x,
 cfe_error cfe_fhipe_decrypt(mpz_t res, cfe_fhipe_ciphertext *cipher,
                             cfe_fhipe_fe_key *fe_key, cfe_fhipe *c);
 
+/**
+ * The same as cfe_fhipe_decrypt, but the discrete logarithm is computed
+ * with the given configuration, which sets the algorithm, the number of
+ * threads and the size of the table of baby steps.
+ *
+ * @param res The result of the decryption (the value will be stored here)
+ * @param cipher A pointer to the ciphertext vector
+ * @param fe_key The functional encryption key
+ * @param c A pointer to an instance of the scheme (*initialized* cfe_fhipe
+ * struct)
+ * @param conf A pointer to the configuration of the discrete logarithm (see
+ * cfe_dlog_config); if NULL, the default configuration is used
+ * @return Error code
+ */
+cfe_error cfe_fhipe_decrypt_with_config(mpz_t res, cfe_fhipe_ciphertext *cipher,
+                                        cfe_fhipe_fe_key *fe_key, cfe_fhipe *c, cfe_dlog_config *conf);
+
 #endif
@@ -19,6 +19,7 @@
 
 #include "cifer/data/vec.h"
 #include "cifer/internal/errors.h"
+#include "cifer/internal/powm.h"
 
 /**
  * \file
@@ -41,6 +42,29 @@ typedef struct cfe_paillier {
     mpz_t g;
 } cfe_paillier;
 
+/**
+ * cfe_paillier_sec_params holds the secret factorization of n = p * q,
+ * which is only known to the holder of the master secret key and lets it
+ * compute modulo p^2 and q^2 instead of modulo n^2.
+ */
+typedef struct cfe_paillier_sec_params {
+    mpz_t p_square;
+    mpz_t q_square;
+    mpz_t p_order; // order of Z_p^2*, p * (p - 1)
+    mpz_t q_order; // order of Z_q^2*, q * (q - 1)
+    mpz_t q_square_inv; // inverse of q^2 modulo p^2
+} cfe_paillier_sec_params;
+
+/**
+ * cfe_paillier_prep_pub_key represents a master public key prepared for
+ * encryption, holding the precomputed powers of the generator g and of
+ * every element of the key modulo n^2.
+ */
+typedef struct cfe_paillier_prep_pub_key {
+    cfe_fixed_base g;
+    cfe_fixed_base_vec mpk;
+} cfe_paillier_prep_pub_key;
+
 /**
 * Initializes a new instance of the scheme.
 * It accepts the length of input vectors l, security parameter lambda,
@@ -62,6 +86,25 @@ typedef struct cfe_paillier {
 */
 cfe_error cfe_paillier_init(cfe_paillier *s, size_t l, size_t lambda, size_t bit_len, mpz_t bound_x, mpz_t bound_y);
 
+/**
+ * The same as cfe_paillier_init, but it also keeps the secret factors of n
+ * in sp, so that the holder of the master secret key can compute powers
+ * modulo n^2 with the Chinese remainder theorem. The secret parameters must
+ * never be given to the encryptors or decryptors.
+ *
+ * @param s A pointer to an uninitialized struct representing the scheme
+ * @param sp A pointer to an uninitialized cfe_paillier_sec_params struct;
+ * it is only initialized if the scheme is
+ * @param l The length of input vectors
+ * @param lambda The security parameter
+ * @param bit_len Number of bits for generating prime numbers
+ * @param bound_x The bound by which the coordinates of encrypted vectors are bounded
+ * @param bound_y The bound by which the coordinates of inner product vectors are bounded
+ * @return Error code
+ */
+cfe_error cfe_paillier_init_sec(cfe_paillier *s, cfe_paillier_sec_params *sp, size_t l, size_t lambda,
+                                size_t bit_len, mpz_t bound_x, mpz_t bound_y);
+
 /**
  * Frees the memory occupied by the struct members. It does not free
  * memory occupied by the struct itself.
@@ -71,6 +114,36 @@ cfe_error cfe_paillier_init(cfe_paillier *s, size_t l, size_t lambda, size_t bit
  */
 void cfe_paillier_free(cfe_paillier *s);
 
+/**
+ * Initializes the secret parameters from the prime factors p and q of n.
+ *
+ * @param sp A pointer to an uninitialized cfe_paillier_sec_params struct
+ * @param p The first prime factor of n
+ * @param q The second prime factor of n
+ */
+void cfe_paillier_sec_params_init(cfe_paillier_sec_params *sp, mpz_t p, mpz_t q);
+
+/**
+ * Frees the memory occupied by the secret parameters. It does not free
+ * memory occupied by the struct itself.
+ *
+ * @param sp A pointer to an *initialized* cfe_paillier_sec_params struct
+ */
+void cfe_paillier_sec_params_free(cfe_paillier_sec_params *sp);
+
+/**
+ * Computes res = base^e mod n^2 as two half-size exponentiations modulo
+ * p^2 and q^2. The exponent is reduced modulo the orders of the groups,
+ * so a negative exponent does not need an inversion, but the base must be
+ * coprime with n.
+ *
+ * @param res The result
+ * @param sp A pointer to an *initialized* cfe_paillier_sec_params struct
+ * @param base Base
+ * @param e Exponent
+ */
+void cfe_paillier_sec_params_powm(mpz_t res, cfe_paillier_sec_params *sp, mpz_t base, mpz_t e);
+
 /**
  * Reconstructs the scheme with the same configuration parameters from
  * an already existing Paillier scheme instance.
@@ -103,6 +176,22 @@ void cfe_paillier_master_keys_init(cfe_vec *msk, cfe_vec *mpk, cfe_paillier *s);
  */
 cfe_error cfe_paillier_generate_master_keys(cfe_vec *msk, cfe_vec *mpk, cfe_paillier *s);
 
+/**
+ * The same as cfe_paillier_generate_master_keys, but the master public key
+ * is computed with the secret parameters of the scheme (see
+ * cfe_paillier_init_sec), as powers modulo p^2 and q^2 combined with the
+ * Chinese remainder theorem.
+ *
+ * @param msk A pointer to a vector (master secret key will be stored here)
+ * @param mpk A pointer to a vector (master public key will be stored here)
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_paillier
+ * struct)
+ * @param sp A pointer to the secret parameters of the scheme
+ * @return Error code
+ */
+cfe_error cfe_paillier_generate_master_keys_sec(cfe_vec *msk, cfe_vec *mpk, cfe_paillier *s,
+                                                cfe_paillier_sec_params *sp);
+
 /**
  * Takes master secret key and input vector y, and returns the functional
  * encryption key. In case the key could not be derived, it returns an error.
@@ -140,6 +229,65 @@ void cfe_paillier_ciphertext_init(cfe_vec *ciphertext, cfe_paillier *s);
  */
 cfe_error cfe_paillier_encrypt(cfe_vec *ciphertext, cfe_paillier *s, cfe_vec *x, cfe_vec *mpk);
 
+/**
+ * Prepares the master public key for encryption by precomputing the powers
+ * of the generator g and of the elements of the key. The prepared key only
+ * depends on the public key, so it can be built once and reused by
+ * cfe_paillier_encrypt_prep and cfe_paillier_encrypt_batch for encrypting
+ * many vectors.
+ *
+ * @param pk A pointer to an uninitialized cfe_paillier_prep_pub_key struct
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_paillier
+ * struct)
+ * @param mpk A pointer to the master public key
+ * @param memory_budget The size of the precomputed powers of the elements
+ * of the key in bytes; if 0, a default size is used
+ * @return Error code
+ */
+cfe_error cfe_paillier_prep_pub_key_init(cfe_paillier_prep_pub_key *pk, cfe_paillier *s, cfe_vec *mpk,
+                                         size_t memory_budget);
+
+/**
+ * Frees the memory occupied by the prepared key. It does not free memory
+ * occupied by the struct itself.
+ *
+ * @param pk A pointer to an *initialized* cfe_paillier_prep_pub_key struct
+ */
+void cfe_paillier_prep_pub_key_free(cfe_paillier_prep_pub_key *pk);
+
+/**
+ * The same as cfe_paillier_encrypt, but it uses a prepared master public
+ * key (see cfe_paillier_prep_pub_key_init).
+ *
+ * @param ciphertext A pointer to a vector (the resulting ciphertext will be
+ * stored here)
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_paillier
+ * struct)
+ * @param x A pointer to the input vector
+ * @param pk A pointer to a key prepared with cfe_paillier_prep_pub_key_init
+ * @return Error code
+ */
+cfe_error cfe_paillier_encrypt_prep(cfe_vec *ciphertext, cfe_paillier *s, cfe_vec *x, cfe_paillier_prep_pub_key *pk);
+
+/**
+ * Encrypts n input vectors with a prepared master public key, split among
+ * the given number of threads which share the prepared key.
+ *
+ * @param ciphertexts An array of n vectors initialized with
+ * cfe_paillier_ciphertext_init (the resulting ciphertexts will be stored here)
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_paillier
+ * struct)
+ * @param xs An array of n input vectors
+ * @param n The number of input vectors
+ * @param pk A pointer to a key prepared with cfe_paillier_prep_pub_key_init
+ * @param num_threads The number of threads (0 is treated as 1)
+ * @return Error code; CFE_ERR_MALFORMED_INPUT if the size of any vector is
+ * wrong, CFE_ERR_BOUND_CHECK_FAILED if any input vector is out of bounds,
+ * in which case nothing is encrypted
+ */
+cfe_error cfe_paillier_encrypt_batch(cfe_vec *ciphertexts, cfe_paillier *s, cfe_vec *xs, size_t n,
+                                     cfe_paillier_prep_pub_key *pk, size_t num_threads);
+
 /**
  * Accepts the encrypted vector, functional encryption key, and a plaintext
  * vector y. It returns the inner product of x and y. If decryption failed, an
@@ -155,4 +303,28 @@ cfe_error cfe_paillier_encrypt(cfe_vec *ciphertext, cfe_paillier *s, cfe_vec *x,
  */
 cfe_error cfe_paillier_decrypt(mpz_t res, cfe_paillier *s, cfe_vec *ciphertext, mpz_t key, cfe_vec *y);
 
+/**
+ * Decrypts n ciphertexts with the same functional encryption key, returning
+ * the inner products of each of the encrypted vectors with y. Every
+ * ciphertext is decrypted with a single multi-exponentiation (see
+ * cfe_multi_powm) whose exponents are shared by the whole batch, and the
+ * ciphertexts are split among the given number of threads.
+ *
+ * @param res An array of n results (the values will be stored here)
+ * @param errs An array of n error codes, one for each ciphertext; it can be
+ * NULL
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_paillier
+ * struct)
+ * @param ciphertexts An array of n ciphertext vectors
+ * @param n The number of ciphertexts
+ * @param key The functional encryption key
+ * @param y A pointer to the inner product vector
+ * @param num_threads The number of threads (0 is treated as 1)
+ * @return Error code; CFE_ERR_BOUND_CHECK_FAILED if y is out of bounds, in
+ * which case nothing is decrypted, otherwise the first error of any of the
+ * ciphertexts
+ */
+cfe_error cfe_paillier_decrypt_batch(mpz_t *res, cfe_error *errs, cfe_paillier *s, cfe_vec *ciphertexts, size_t n,
+                                     mpz_t key, cfe_vec *y, size_t num_threads);
+
 #endif
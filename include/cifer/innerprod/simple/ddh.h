@@ -17,8 +17,12 @@
 #ifndef CIFER_DDH_H
 #define CIFER_DDH_H
 
+#include "cifer/data/mat.h"
 #include "cifer/data/vec.h"
+#include "cifer/internal/dlog.h"
 #include "cifer/internal/errors.h"
+#include "cifer/internal/pool.h"
+#include "cifer/internal/powm.h"
 
 /**
  * \file
@@ -35,6 +39,8 @@ typedef struct cfe_ddh {
     mpz_t g;
     mpz_t p;
     mpz_t q;
+    cfe_fixed_base g_table; // precomputed powers of g
+    cfe_small_powers msg_table; // powers of g with exponents in [-bound, bound], if built
 } cfe_ddh;
 
 /**
@@ -81,6 +87,19 @@ void cfe_ddh_free(cfe_ddh *s);
  */
 void cfe_ddh_copy(cfe_ddh *res, cfe_ddh *s);
 
+/**
+ * Builds the table of powers of g for the coordinates of input vectors,
+ * so that encryption looks them up instead of exponentiating. It is meant
+ * for encryptors which encrypt many vectors: the table holds about
+ * 2 * sqrt(2 * bound) elements of Zp, and it is left empty if the bound has
+ * more than CFE_SMALL_POWERS_MAX_BITS bits. The table is not built by
+ * cfe_ddh_init and cfe_ddh_precomp_init; once built, it is copied by
+ * cfe_ddh_copy.
+ *
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh struct)
+ */
+void cfe_ddh_msg_table_init(cfe_ddh *s);
+
 /**
  * Initializes the vectors which represent the master secret key and master
  * public key.
@@ -121,6 +140,24 @@ void cfe_ddh_generate_master_keys(cfe_vec *msk, cfe_vec *mpk, cfe_ddh *s);
  */
 cfe_error cfe_ddh_derive_fe_key(mpz_t res, cfe_ddh *s, cfe_vec *msk, cfe_vec *y);
 
+/**
+ * Derives the functional encryption keys for all the rows of the matrix Y
+ * at once, as the product of Y with the master secret key, so that the
+ * whole batch is bound checked once and each key is reduced only once.
+ * The rows of Y are split among the given number of threads.
+ *
+ * @param res A pointer to an initialized vector with one element for each
+ * row of Y (the derived keys will be stored here)
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh struct)
+ * @param msk A pointer to the master secret key
+ * @param Y A pointer to the matrix whose rows are the inner product vectors
+ * @param num_threads The number of threads (0 is treated as 1)
+ * @return Error code; CFE_ERR_MALFORMED_INPUT if the sizes do not match,
+ * CFE_ERR_BOUND_CHECK_FAILED if any row of Y is out of bounds, in which case
+ * no key is derived
+ */
+cfe_error cfe_ddh_derive_fe_keys(cfe_vec *res, cfe_ddh *s, cfe_vec *msk, cfe_mat *Y, size_t num_threads);
+
 /**
  * Encrypts input vector x with the provided master public key. It returns a
  * ciphertext vector. If encryption failed, an error is returned.
@@ -134,6 +171,67 @@ cfe_error cfe_ddh_derive_fe_key(mpz_t res, cfe_ddh *s, cfe_vec *msk, cfe_vec *y)
  */
 cfe_error cfe_ddh_encrypt(cfe_vec *ciphertext, cfe_ddh *s, cfe_vec *x, cfe_vec *mpk);
 
+/**
+ * Prepares the master public key for encryption by precomputing the powers
+ * of its elements. The prepared key only depends on the public key, so it
+ * can be built once and reused by cfe_ddh_encrypt_prep for encrypting many
+ * vectors. It needs to be freed with cfe_fixed_base_vec_free.
+ *
+ * @param pk A pointer to an uninitialized cfe_fixed_base_vec struct
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh struct)
+ * @param mpk A pointer to the master public key
+ * @param memory_budget The size of the prepared key in bytes; if 0, a
+ * default size is used
+ * @return Error code
+ */
+cfe_error cfe_ddh_prep_pub_key_init(cfe_fixed_base_vec *pk, cfe_ddh *s, cfe_vec *mpk, size_t memory_budget);
+
+/**
+ * The same as cfe_ddh_encrypt, but it uses a prepared master public key
+ * (see cfe_ddh_prep_pub_key_init).
+ *
+ * @param ciphertext A pointer to a vector (the resulting ciphertext will be
+ * stored here)
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh struct)
+ * @param x A pointer to the input vector
+ * @param pk A pointer to a key prepared with cfe_ddh_prep_pub_key_init
+ * @return Error code
+ */
+cfe_error cfe_ddh_encrypt_prep(cfe_vec *ciphertext, cfe_ddh *s, cfe_vec *x, cfe_fixed_base_vec *pk);
+
+/**
+ * Initializes a pool of the randomness of ciphertexts, that is of the
+ * tuples (g^r, mpk_1^r, ..., mpk_l^r) for random r, which do not depend on
+ * the input vector. The tuples can be computed ahead of time with
+ * cfe_pool_fill or on a background thread, so that cfe_ddh_encrypt_pooled
+ * is left with only a few multiplications. The pool keeps its own copy of
+ * the scheme and a prepared public key; it needs to be freed with
+ * cfe_pool_free.
+ *
+ * @param pool A pointer to an uninitialized cfe_pool struct
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh struct)
+ * @param mpk A pointer to the master public key
+ * @param capacity The largest number of tuples kept in the pool
+ * @param background Whether to refill the pool on a background thread
+ * @return Error code
+ */
+cfe_error cfe_ddh_pool_init(cfe_pool *pool, cfe_ddh *s, cfe_vec *mpk, size_t capacity, bool background);
+
+/**
+ * The same as cfe_ddh_encrypt, but it takes the randomness of the
+ * ciphertext from a pool (see cfe_ddh_pool_init). Every tuple of the pool
+ * is used for a single ciphertext; if the pool is empty, a fresh one is
+ * computed.
+ *
+ * @param ciphertext A pointer to a vector initialized with
+ * cfe_ddh_ciphertext_init (the resulting ciphertext will be stored here)
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh struct)
+ * @param x A pointer to the input vector
+ * @param pool A pointer to a pool initialized with cfe_ddh_pool_init
+ * @return Error code
+ */
+cfe_error cfe_ddh_encrypt_pooled(cfe_vec *ciphertext, cfe_ddh *s, cfe_vec *x, cfe_pool *pool);
+
 /**
  * Accepts the encrypted vector x, functional encryption key, and a plaintext
  * vector y. It returns the inner product of x and y. If decryption failed, an
@@ -148,4 +246,137 @@ cfe_error cfe_ddh_encrypt(cfe_vec *ciphertext, cfe_ddh *s, cfe_vec *x, cfe_vec *
  */
 cfe_error cfe_ddh_decrypt(mpz_t res, cfe_ddh *s, cfe_vec *ciphertext, mpz_t key, cfe_vec *y);
 
+/**
+ * The same as cfe_ddh_decrypt, but the discrete logarithm is computed
+ * with the given configuration, which sets the algorithm, the number of
+ * threads and the size of the table of baby steps.
+ *
+ * @param res The result of the decryption (the value will be stored here)
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh struct)
+ * @param ciphertext A pointer to the ciphertext vector
+ * @param key The functional encryption key
+ * @param y A pointer to the plaintext vector
+ * @param c A pointer to the configuration of the discrete logarithm (see
+ * cfe_dlog_config); if NULL, the default configuration is used
+ * @return Error code
+ */
+cfe_error cfe_ddh_decrypt_with_config(mpz_t res, cfe_ddh *s, cfe_vec *ciphertext, mpz_t key, cfe_vec *y,
+                                      cfe_dlog_config *c);
+
+/**
+ * Initializes the table of baby steps needed for computing the discrete
+ * logarithm at the end of decryption. The table only depends on the scheme
+ * instance, so it can be built once and reused by cfe_ddh_decrypt_with_table
+ * for decrypting many ciphertexts.
+ *
+ * @param t A pointer to an uninitialized cfe_dlog_table struct
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh struct)
+ * @return Error code
+ */
+cfe_error cfe_ddh_dlog_table_init(cfe_dlog_table *t, cfe_ddh *s);
+
+/**
+ * The same as cfe_ddh_decrypt, but it uses a precomputed table of baby steps
+ * (see cfe_ddh_dlog_table_init) for computing the discrete logarithm.
+ *
+ * @param res The result of the decryption (the value will be stored here)
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh struct)
+ * @param ciphertext A pointer to the ciphertext vector
+ * @param key The functional encryption key
+ * @param y A pointer to the plaintext vector
+ * @param t A pointer to a table initialized with cfe_ddh_dlog_table_init
+ * @return Error code
+ */
+cfe_error cfe_ddh_decrypt_with_table(mpz_t res, cfe_ddh *s, cfe_vec *ciphertext, mpz_t key, cfe_vec *y,
+                                     cfe_dlog_table *t);
+
+/**
+ * Combines n ciphertexts encrypted under the same master public key into a
+ * single ciphertext by multiplying them component-wise. As the scheme is
+ * additively homomorphic, the result is an encryption of the sum of the
+ * encrypted vectors, whose inner product with y can be obtained with a
+ * single decryption and a single discrete logarithm (see
+ * cfe_ddh_decrypt_aggregate) instead of n of each. The coordinates of the sum
+ * are bounded by n * bound, so an error is returned if the inner products
+ * of the sum, bounded by n * l * bound², could not be decrypted.
+ *
+ * @param res A pointer to a vector initialized with cfe_ddh_ciphertext_init
+ * (the result will be stored here)
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh struct)
+ * @param ciphertexts An array of n ciphertexts
+ * @param n The number of ciphertexts (at least 1)
+ * @return Error code
+ */
+cfe_error cfe_ddh_ciphertext_aggregate(cfe_vec *res, cfe_ddh *s, cfe_vec *ciphertexts, size_t n);
+
+/**
+ * The same as cfe_ddh_ciphertext_aggregate, but the ciphertexts are split
+ * among the given number of threads (see cfe_vec_prod_mod), which pays off
+ * for large arrays of ciphertexts.
+ *
+ * @param res A pointer to a vector initialized with cfe_ddh_ciphertext_init
+ * (the result will be stored here)
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh struct)
+ * @param ciphertexts An array of n ciphertexts
+ * @param n The number of ciphertexts (at least 1)
+ * @param num_threads The number of threads (0 is treated as 1)
+ * @return Error code
+ */
+cfe_error cfe_ddh_ciphertext_aggregate_parallel(cfe_vec *res, cfe_ddh *s, cfe_vec *ciphertexts, size_t n,
+                                                size_t num_threads);
+
+/**
+ * The same as cfe_ddh_decrypt, but for a ciphertext aggregated from n
+ * ciphertexts with cfe_ddh_ciphertext_aggregate; it returns the sum of the
+ * inner products of the encrypted vectors with y, searching for it within
+ * the bound n * l * bound².
+ *
+ * @param res The result of the decryption (the value will be stored here)
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh struct)
+ * @param ciphertext A pointer to the aggregated ciphertext
+ * @param key The functional encryption key
+ * @param y A pointer to the plaintext vector
+ * @param n The number of aggregated ciphertexts
+ * @return Error code
+ */
+cfe_error cfe_ddh_decrypt_aggregate(mpz_t res, cfe_ddh *s, cfe_vec *ciphertext, mpz_t key, cfe_vec *y, size_t n);
+
+/**
+ * Initializes the table of baby steps for decrypting ciphertexts aggregated
+ * from n ciphertexts, i.e. with the bound n * l * bound². The table can be
+ * used by cfe_ddh_decrypt_with_table for decrypting any ciphertext aggregated
+ * from at most n ciphertexts.
+ *
+ * @param t A pointer to an uninitialized cfe_dlog_table struct
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh struct)
+ * @param n The number of aggregated ciphertexts
+ * @return Error code
+ */
+cfe_error cfe_ddh_aggregate_dlog_table_init(cfe_dlog_table *t, cfe_ddh *s, size_t n);
+
+/**
+ * Decrypts a single ciphertext with n functional keys at once, returning
+ * the inner products of the encrypted vector with each of the vectors
+ * ys[k], whose keys are keys[k]. The tables of powers of the elements of
+ * the ciphertext are built once and shared by all the keys (see
+ * cfe_fixed_base_vec_init_batch), and all the discrete logarithms are
+ * computed with a single table of baby steps.
+ *
+ * @param res An array of n results (the values will be stored here)
+ * @param errs An array of n error codes, one for each key; it can be NULL
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh struct)
+ * @param ciphertext A pointer to the ciphertext vector
+ * @param keys An array of n functional encryption keys
+ * @param ys An array of the n plaintext vectors
+ * @param n The number of keys
+ * @param t A pointer to a table initialized with cfe_ddh_dlog_table_init, or
+ * NULL, in which case a table is built for this call
+ * @param num_threads The number of threads for the exponentiations and, if
+ * t is NULL, for the discrete logarithms; if 0, the number set by
+ * cfe_dlog_set_num_threads is used (a given table uses its own num_threads)
+ * @return Error code; the first error of any of the keys
+ */
+cfe_error cfe_ddh_decrypt_batch(mpz_t *res, cfe_error *errs, cfe_ddh *s, cfe_vec *ciphertext, mpz_t *keys, cfe_vec *ys,
+                                size_t n, cfe_dlog_table *t, size_t num_threads);
+
 #endif
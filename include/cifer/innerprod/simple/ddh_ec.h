@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2018 XLAB d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef CIFER_DDH_EC_H
+#define CIFER_DDH_EC_H
+
+#include <amcl/ecp_BN254.h>
+
+#include "cifer/data/vec.h"
+#include "cifer/data/vec_curve.h"
+#include "cifer/internal/dlog.h"
+#include "cifer/internal/errors.h"
+
+/**
+ * \file
+ * \ingroup simple
+ * \brief DDH scheme over an elliptic curve.
+ */
+
+/**
+ * cfe_ddh_ec represents the same scheme as cfe_ddh, but instantiated in the
+ * prime-order group of points of the elliptic curve BN254 (the group G1 of
+ * the pairing used by cfe_dmcfe). Group elements take 256 bits instead of
+ * the thousands of bits of a safe-prime group of comparable security, and
+ * the scheme needs no parameter generation.
+ */
+typedef struct cfe_ddh_ec {
+    size_t l;
+    mpz_t bound;
+    mpz_t order;
+} cfe_ddh_ec;
+
+/**
+ * Configures a new instance of the scheme.
+ * It returns an error if precondition 2 * l * bound² is >= order of the
+ * group.
+ * @param s A pointer to an uninitialized struct representing the scheme
+ * @param l The length of input vectors
+ * @param bound The bound by which coordinates of input vectors are bounded
+ * @return Error code
+ */
+cfe_error cfe_ddh_ec_init(cfe_ddh_ec *s, size_t l, mpz_t bound);
+
+/**
+ * Frees the memory occupied by the struct members. It does not free
+ * memory occupied by the struct itself.
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh_ec struct)
+ */
+void cfe_ddh_ec_free(cfe_ddh_ec *s);
+
+/**
+ * Reconstructs the scheme with the same configuration parameters from
+ * an already existing scheme instance.
+ * @param res A pointer to an uninitialized cfe_ddh_ec struct
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh_ec struct)
+ */
+void cfe_ddh_ec_copy(cfe_ddh_ec *res, cfe_ddh_ec *s);
+
+/**
+ * Initializes the vectors which represent the master secret key and master
+ * public key.
+ * @param msk A pointer to an uninitialized vector
+ * @param mpk A pointer to an uninitialized vector of points
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh_ec struct)
+ */
+void cfe_ddh_ec_master_keys_init(cfe_vec *msk, cfe_vec_G1 *mpk, cfe_ddh_ec *s);
+
+/**
+ * Initializes the vector of points which represents the ciphertext.
+ * @param ciphertext A pointer to an uninitialized vector of points
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh_ec struct)
+ */
+void cfe_ddh_ec_ciphertext_init(cfe_vec_G1 *ciphertext, cfe_ddh_ec *s);
+
+/**
+ * Generates a pair of master secret key and master public key for the scheme.
+ * @param msk A pointer to a vector (master secret key will be stored here)
+ * @param mpk A pointer to a vector of points (master public key will be
+ * stored here)
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh_ec struct)
+ */
+void cfe_ddh_ec_generate_master_keys(cfe_vec *msk, cfe_vec_G1 *mpk, cfe_ddh_ec *s);
+
+/**
+ * Takes master secret key and input vector y, and returns the functional
+ * encryption key. In case the key could not be derived, it returns an error.
+ * @param res The derived key (the value will be stored here)
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh_ec struct)
+ * @param msk A pointer to the master secret key
+ * @param y A pointer to the input vector
+ * @return Error code
+ */
+cfe_error cfe_ddh_ec_derive_fe_key(mpz_t res, cfe_ddh_ec *s, cfe_vec *msk, cfe_vec *y);
+
+/**
+ * Encrypts input vector x with the provided master public key. If
+ * encryption failed, an error is returned.
+ * @param ciphertext A pointer to a vector of points initialized with
+ * cfe_ddh_ec_ciphertext_init (the resulting ciphertext will be stored here)
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh_ec struct)
+ * @param x A pointer to the input vector
+ * @param mpk A pointer to the master public key
+ * @return Error code
+ */
+cfe_error cfe_ddh_ec_encrypt(cfe_vec_G1 *ciphertext, cfe_ddh_ec *s, cfe_vec *x, cfe_vec_G1 *mpk);
+
+/**
+ * Accepts the encrypted vector x, functional encryption key, and a plaintext
+ * vector y. It returns the inner product of x and y. If decryption failed, an
+ * error is returned.
+ * @param res The result of the decryption (the value will be stored here)
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh_ec struct)
+ * @param ciphertext A pointer to the ciphertext vector
+ * @param key The functional encryption key
+ * @param y A pointer to the plaintext vector
+ * @return Error code
+ */
+cfe_error cfe_ddh_ec_decrypt(mpz_t res, cfe_ddh_ec *s, cfe_vec_G1 *ciphertext, mpz_t key, cfe_vec *y);
+
+/**
+ * Initializes the table of baby steps needed for computing the discrete
+ * logarithm at the end of decryption. The table only depends on the scheme
+ * instance, so it can be built once and reused by
+ * cfe_ddh_ec_decrypt_with_table for decrypting many ciphertexts.
+ * @param t A pointer to an uninitialized cfe_dlog_table_ECP_BN254 struct
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh_ec struct)
+ * @return Error code
+ */
+cfe_error cfe_ddh_ec_dlog_table_init(cfe_dlog_table_ECP_BN254 *t, cfe_ddh_ec *s);
+
+/**
+ * The same as cfe_ddh_ec_decrypt, but it uses a precomputed table of baby
+ * steps (see cfe_ddh_ec_dlog_table_init) for computing the discrete
+ * logarithm.
+ * @param res The result of the decryption (the value will be stored here)
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_ddh_ec struct)
+ * @param ciphertext A pointer to the ciphertext vector
+ * @param key The functional encryption key
+ * @param y A pointer to the plaintext vector
+ * @param t A pointer to a table initialized with cfe_ddh_ec_dlog_table_init
+ * @return Error code
+ */
+cfe_error cfe_ddh_ec_decrypt_with_table(mpz_t res, cfe_ddh_ec *s, cfe_vec_G1 *ciphertext, mpz_t key, cfe_vec *y,
+                                        cfe_dlog_table_ECP_BN254 *t);
+
+#endif
@@ -235,4 +235,22 @@ cfe_error cfe_ddh_multi_encrypt(cfe_vec *ciphertext, cfe_ddh_multi_enc *e, cfe_v
 cfe_error
 cfe_ddh_multi_decrypt(mpz_t res, cfe_ddh_multi *m, cfe_mat *ciphertext, cfe_ddh_multi_fe_key *key, cfe_mat *y);
 
+/**
+ * The same as cfe_ddh_multi_decrypt, but the discrete logarithm is computed
+ * with the given configuration, which sets the algorithm, the number of
+ * threads and the size of the table of baby steps.
+ *
+ * @param res The result of the decryption (the value will be stored here)
+ * @param m A pointer to an instance of the scheme (*initialized* cfe_ddh_multi
+ * struct)
+ * @param ciphertext A pointer to the matrix comprised of encrypted vectors
+ * @param key A pointer to the functional encryption key
+ * @param y A pointer to the matrix comprised of plaintext vectors
+ * @param conf A pointer to the configuration of the discrete logarithm (see
+ * cfe_dlog_config); if NULL, the default configuration is used
+ * @return Error code
+ */
+cfe_error cfe_ddh_multi_decrypt_with_config(mpz_t res, cfe_ddh_multi *m, cfe_mat *ciphertext, cfe_ddh_multi_fe_key *key,
+                                            cfe_mat *y, cfe_dlog_config *conf);
+
 #endif
@@ -131,6 +131,26 @@ void cfe_lwe_fe_key_init(cfe_vec *sk_y, cfe_lwe *s);
  */
 cfe_error cfe_lwe_derive_fe_key(cfe_vec *sk_y, cfe_lwe *s, cfe_mat *SK, cfe_vec *y);
 
+/**
+ * Derives the functional encryption keys for all the rows of the matrix Y
+ * at once, as the product of Y with the transposed master secret key, so
+ * that the whole batch is bound checked once and each element of the keys
+ * is reduced only once. The rows of Y are split among the given number of
+ * threads.
+ *
+ * @param SK_Y A pointer to an initialized matrix with a row of size n for
+ * each row of Y (the row k will hold the key for the row k of Y)
+ * @param s A pointer to an instance of the scheme (*initialized*
+ * cfe_lwe struct)
+ * @param SK A pointer to the master secret key
+ * @param Y A pointer to the matrix whose rows are the inner product vectors
+ * @param num_threads The number of threads (0 is treated as 1)
+ * @return Error code; CFE_ERR_MALFORMED_INPUT if the sizes do not match,
+ * CFE_ERR_BOUND_CHECK_FAILED if any row of Y is out of bounds, in which case
+ * no key is derived
+ */
+cfe_error cfe_lwe_derive_fe_keys(cfe_mat *SK_Y, cfe_lwe *s, cfe_mat *SK, cfe_mat *Y, size_t num_threads);
+
 /**
  * Initializes the vector which represents the ciphertext.
  *
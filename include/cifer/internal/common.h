@@ -44,4 +44,16 @@ cfe_error cfe_init(void);
  */
 void *cfe_malloc(size_t size);
 
+/**
+ * Runs the worker on each of the jobs in its own thread and waits for all
+ * of them to finish. A single job is run in the calling thread, as well as
+ * any job for which a thread could not be created.
+ *
+ * @param worker The function run by each thread, taking a pointer to its job
+ * @param jobs An array of num_jobs jobs
+ * @param job_size The size of a single job in bytes
+ * @param num_jobs The number of jobs
+ */
+void cfe_run_jobs(void *(*worker)(void *), void *jobs, size_t job_size, size_t num_jobs);
+
 #endif
@@ -17,10 +17,15 @@
 #ifndef CIFER_DLOG_H
 #define CIFER_DLOG_H
 
+#include <stddef.h>
+#include <stdint.h>
 #include <gmp.h>
+#include <amcl/ecp_BN254.h>
 #include <amcl/fp12_BN254.h>
 
+#include "cifer/data/vec.h"
 #include "cifer/internal/errors.h"
+#include "cifer/internal/modctx.h"
 
 /**
  * \file
@@ -31,6 +36,230 @@
  * all rely on efficient algorithms for calculating discrete logarithms.
  */
 
+/**
+ * Sets the number of threads used by the baby-step giant-step method when
+ * the number of threads is not given explicitly. Both the baby steps and the
+ * giant steps are split among the threads, and the giant steps are stopped
+ * in all the threads as soon as one of them finds the solution. By default,
+ * a single thread is used.
+ *
+ * @param num_threads The number of threads (0 is treated as 1)
+ */
+void cfe_dlog_set_num_threads(size_t num_threads);
+
+/**
+ * Returns the number of threads used by the baby-step giant-step method
+ * when the number of threads is not given explicitly.
+ *
+ * @return The number of threads
+ */
+size_t cfe_dlog_get_num_threads(void);
+
+/**
+ * Algorithms for computing discrete logarithms in a bounded interval.
+ */
+typedef enum cfe_dlog_algorithm {
+    CFE_DLOG_AUTO = 0, // the algorithm with fewer expected steps
+    CFE_DLOG_BSGS, // baby-step giant-step method
+    CFE_DLOG_KANGAROO, // Pollard's kangaroo method
+} cfe_dlog_algorithm;
+
+/**
+ * cfe_dlog_config configures how discrete logarithms are computed, trading
+ * time for memory. By default (see cfe_dlog_config_init) the baby-step
+ * giant-step method uses sqrt(bound) + 1 baby steps. Fewer baby steps make
+ * the table smaller, but need proportionally more giant steps (bound divided
+ * by the number of baby steps). The memory budget limits the number of baby
+ * steps so that the table, together with the fingerprints held while it is
+ * built (32 bytes per baby step in the worst case), fits into the budget.
+ * With CFE_DLOG_AUTO, Pollard's kangaroo method, which needs almost no
+ * memory, is used instead when the limited table would make the
+ * baby-step giant-step method slower.
+ */
+typedef struct cfe_dlog_config {
+    size_t baby_steps; // number of baby steps, 0 for sqrt(bound) + 1
+    size_t memory_budget; // upper bound for the table in bytes, 0 for none
+    size_t num_threads; // 0 for the number set by cfe_dlog_set_num_threads
+    cfe_dlog_algorithm algorithm;
+} cfe_dlog_config;
+
+/**
+ * Initializes the configuration with the default values: the number of baby
+ * steps is derived from the bound, there is no memory budget, the number of
+ * threads set by cfe_dlog_set_num_threads is used, and the algorithm is
+ * chosen automatically.
+ *
+ * @param c A pointer to a cfe_dlog_config struct
+ */
+void cfe_dlog_config_init(cfe_dlog_config *c);
+
+/**
+ * cfe_dlog_prediction holds the predicted cost of computing a discrete
+ * logarithm in the interval [-bound, bound]. Steps are counted as group
+ * multiplications (each followed by a lookup).
+ */
+typedef struct cfe_dlog_prediction {
+    cfe_dlog_algorithm algorithm; // CFE_DLOG_BSGS or CFE_DLOG_KANGAROO
+    size_t baby_steps; // number of baby steps, 0 for the kangaroo method
+    size_t giant_steps; // number of giant steps, 0 for the kangaroo method
+    size_t table_bytes; // size of the table of baby steps, or the
+                        // approximate size of the distinguished points
+    double expected_steps; // expected number of steps
+    double max_steps; // number of steps after which the search gives up
+} cfe_dlog_prediction;
+
+/**
+ * Predicts the size of the table and the number of steps needed for
+ * computing a discrete logarithm in the interval [-bound, bound] with the
+ * given configuration. For the baby-step giant-step method, both the
+ * baby steps and the giant steps for h and h^-1 are counted; if the table
+ * is reused for many elements, only the giant steps are repeated.
+ * If the algorithm is CFE_DLOG_AUTO, the prediction is made for the
+ * algorithm which would be chosen by cfe_dlog_with_neg.
+ *
+ * @param pr A pointer to a cfe_dlog_prediction struct (the result)
+ * @param bound Bound for solution
+ * @param c A pointer to the configuration; if NULL, the default
+ * configuration is used
+ * @return Error code; CFE_ERR_DLOG_CALC_FAILED if the baby-step giant-step
+ * method was requested, but would need 2^32 or more baby or giant steps or
+ * exceed the memory budget
+ */
+cfe_error cfe_dlog_predict(cfe_dlog_prediction *pr, mpz_t bound, cfe_dlog_config *c);
+
+/**
+ * cfe_dlog_hash is a flat open addressing hash table with linear probing
+ * which maps 64-bit fingerprints of baby steps g^i to their 32-bit indices i.
+ * It is at most half full. Elements themselves are not stored, so a matching
+ * fingerprint must be verified by computing g^i.
+ */
+typedef struct cfe_dlog_hash {
+    uint64_t *keys; // fingerprints of baby steps
+    uint32_t *vals; // indices of baby steps, UINT32_MAX in empty slots
+    size_t log_capacity; // the table has 2^log_capacity slots
+} cfe_dlog_hash;
+
+/**
+ * cfe_dlog_table represents a precomputed table of baby steps for the
+ * baby-step giant-step method in the Zp group. The table is built once for
+ * a generator, modulus and bound, and can then be reused for computing
+ * discrete logarithms of many elements, so that each computation only runs
+ * the giant steps.
+ *
+ * It is a flat open addressing hash table which for each baby step g^i only
+ * stores a 64-bit fingerprint of g^i and a 32-bit index i (i.e. 24 bytes per
+ * baby step on average), regardless of the size of the modulus. Matching
+ * fingerprints are verified, so collisions cannot produce a wrong result.
+ */
+typedef struct cfe_dlog_table {
+    mpz_t g; // generator
+    mpz_t p; // modulus
+    mpz_t m; // number of baby steps
+    mpz_t z; // giant step g^(-m) mod p
+    cfe_modctx ctx; // arithmetic modulo p, in which the steps are computed
+    mp_limb_t *g_mont; // g in Montgomery form
+    mp_limb_t *z_mont; // z in Montgomery form
+    size_t giant_steps; // number of giant steps
+    cfe_dlog_hash T; // baby steps
+    size_t num_threads; // number of threads used for the giant steps
+} cfe_dlog_table;
+
+/**
+ * Initializes the table of baby steps for computing discrete logarithms with
+ * respect to generator g in the Zp group. The table covers solutions <= bound.
+ * If bound argument is nil, the bound is automatically set to the order. If
+ * order argument is nil, the order is automatically set to p-1 (in this case
+ * p must be a prime, otherwise an error is returned). An error is also
+ * returned if p is even, as the steps are computed in Montgomery form, or
+ * if the table would need 2^32 or more baby steps.
+ * The table is built with the number of threads set by
+ * cfe_dlog_set_num_threads, and the same number is stored in the table's
+ * num_threads member to be used for the giant steps (it can be changed
+ * after the table is initialized).
+ *
+ * @param t A pointer to an uninitialized cfe_dlog_table struct
+ * @param g Generator
+ * @param p Modulus
+ * @param order Order
+ * @param bound Bound for solution
+ * @return Error code
+ */
+cfe_error cfe_dlog_table_init(cfe_dlog_table *t, mpz_t g, mpz_t p, mpz_t order, mpz_t bound);
+
+/**
+ * The same as cfe_dlog_table_init, but the number of baby steps, the memory
+ * budget and the number of threads are taken from the configuration (see
+ * cfe_dlog_config). The algorithm in the configuration is ignored. An error
+ * is returned if the table does not fit into the memory budget, or if it
+ * would need 2^32 or more baby or giant steps.
+ *
+ * @param t A pointer to an uninitialized cfe_dlog_table struct
+ * @param g Generator
+ * @param p Modulus
+ * @param order Order
+ * @param bound Bound for solution
+ * @param c A pointer to the configuration; if NULL, the default
+ * configuration is used
+ * @return Error code
+ */
+cfe_error cfe_dlog_table_init_with_config(cfe_dlog_table *t, mpz_t g, mpz_t p, mpz_t order, mpz_t bound,
+                                          cfe_dlog_config *c);
+
+/**
+ * Frees the memory occupied by the table. It does not free memory occupied
+ * by the struct itself.
+ *
+ * @param t A pointer to an *initialized* cfe_dlog_table struct
+ */
+void cfe_dlog_table_free(cfe_dlog_table *t);
+
+/**
+ * Computes the discrete logarithm using a precomputed table of baby steps,
+ * i.e. it runs only the giant steps of the baby-step giant-step method.
+ * The function returns x, where h = g^x mod p and 0 <= x <= bound. If the
+ * solution was not found, it returns an error.
+ *
+ * @param res Discrete logarithm (the result value placeholder)
+ * @param h Element
+ * @param t A pointer to an *initialized* cfe_dlog_table struct
+ * @return Error code
+ */
+cfe_error cfe_dlog_table_solve(mpz_t res, mpz_t h, cfe_dlog_table *t);
+
+/**
+ * Computes the discrete logarithm using a precomputed table of baby steps,
+ * finding also negative solutions. Positive and negative solutions are
+ * searched for simultaneously with the same table.
+ * The function returns x, where h = g^x mod p and -bound <= x <= bound. If
+ * the solution was not found, it returns an error.
+ *
+ * @param res Discrete logarithm (the result value placeholder)
+ * @param h Element
+ * @param t A pointer to an *initialized* cfe_dlog_table struct
+ * @return Error code
+ */
+cfe_error cfe_dlog_table_solve_with_neg(mpz_t res, mpz_t h, cfe_dlog_table *t);
+
+/**
+ * Computes the discrete logarithms of many elements using the same
+ * precomputed table of baby steps, finding also negative solutions. The
+ * giant steps for all the elements are made together, sharing the table and
+ * the precomputed z = g^-m; each element stops as soon as its solution is
+ * found. The elements are split among t->num_threads threads.
+ *
+ * @param res An array of n initialized mpz_t values holding the discrete
+ * logarithms (the result value placeholders)
+ * @param errs An array of n error codes, set to CFE_ERR_NONE for the
+ * elements that were solved and to CFE_ERR_DLOG_NOT_FOUND for the others;
+ * it can be NULL
+ * @param h An array of n elements
+ * @param n The number of elements
+ * @param t A pointer to an *initialized* cfe_dlog_table struct
+ * @return CFE_ERR_NONE if all the discrete logarithms were found, otherwise
+ * CFE_ERR_DLOG_NOT_FOUND
+ */
+cfe_error cfe_dlog_table_solve_batch_with_neg(mpz_t *res, cfe_error *errs, mpz_t *h, size_t n, cfe_dlog_table *t);
+
 /**
  * @brief Baby-step giant-step method for computing the discrete logarithm in
  * the Zp group.
@@ -50,6 +279,23 @@
  */
 cfe_error cfe_baby_giant(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t order, mpz_t bound);
 
+/**
+ * The same as cfe_baby_giant, but it splits the baby steps and the giant
+ * steps among the given number of threads.
+ *
+ * @param res Discrete logarithm (the result value placeholder)
+ * @param h Element
+ * @param g Generator
+ * @param p Modulus
+ * @param order Order
+ * @param bound Bound for solution
+ * @param num_threads The number of threads; if 0, the number set by
+ * cfe_dlog_set_num_threads is used
+ * @return Error code
+ */
+cfe_error cfe_baby_giant_parallel(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t order, mpz_t bound,
+                                  size_t num_threads);
+
 /**
  * @brief Baby-step giant-step method for computing the discrete logarithm in
  * the Zp group finding also negative solutions.
@@ -57,6 +303,8 @@ cfe_error cfe_baby_giant(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t order, mpz_
  * It searches for a solution (-bound, bound). If bound argument is nil,
  * the bound is automatically set to p-1 and it works identically than
  * function baby_step_giant_step.
+ * Positive and negative solutions are searched for simultaneously with a
+ * single table of baby steps, checking h and h^-1 in each giant step.
  * The function returns x, where h = g^x mod p. If the solution was not found
  * within the provided bound, it returns an error.
  *
@@ -71,7 +319,118 @@ cfe_error cfe_baby_giant(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t order, mpz_
 cfe_error cfe_baby_giant_with_neg(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t _order, mpz_t bound);
 
 /**
- * @brief  Pollard's rho algorithm - simple, non-parallel version.
+ * The same as cfe_baby_giant_with_neg, but it computes the discrete
+ * logarithms of n elements with a single table of baby steps. See
+ * cfe_dlog_table_solve_batch_with_neg.
+ *
+ * @param res An array of n discrete logarithms (the result value placeholders)
+ * @param errs An array of n error codes for the elements; it can be NULL
+ * @param h An array of n elements
+ * @param n The number of elements
+ * @param g Generator
+ * @param p Modulus
+ * @param order Order
+ * @param bound Bound for solution
+ * @return Error code
+ */
+cfe_error cfe_baby_giant_batch_with_neg(mpz_t *res, cfe_error *errs, mpz_t *h, size_t n, mpz_t g, mpz_t p,
+                                        mpz_t order, mpz_t bound);
+
+/**
+ * Computes the discrete logarithms of the products of bases_i^exps[k]_i
+ * mod p for n vectors of exponents, such as a ciphertext decrypted with n
+ * functional keys. The precomputations for the bases are built once and
+ * shared by all the vectors of exponents (see
+ * cfe_fixed_base_vec_init_batch), and all the discrete logarithms are
+ * computed with a single table of baby steps.
+ *
+ * @param res An array of n discrete logarithms (the result value placeholders)
+ * @param errs An array of n error codes; on input, the vectors of exponents
+ * with an error other than CFE_ERR_NONE are skipped and keep their error,
+ * and their exponents must be 0; on output, the error of each vector
+ * @param bases A pointer to the vector of bases
+ * @param exps An array of n vectors of exponents, of the same size as bases
+ * @param n The number of vectors of exponents
+ * @param g Generator
+ * @param p Modulus
+ * @param order Order
+ * @param bound Bound for solution
+ * @param t A pointer to a table initialized for g, p, order and bound, or
+ * NULL, in which case a table is built for this call
+ * @param num_threads The number of threads for the exponentiations and, if
+ * t is NULL, for the discrete logarithms; if 0, the number set by
+ * cfe_dlog_set_num_threads is used (a given table uses its own num_threads)
+ * @return Error code; the first error of any of the vectors of exponents
+ */
+cfe_error cfe_dlog_powm_batch_with_neg(mpz_t *res, cfe_error *errs, cfe_vec *bases, cfe_vec *exps, size_t n,
+                                       mpz_t g, mpz_t p, mpz_t order, mpz_t bound, cfe_dlog_table *t,
+                                       size_t num_threads);
+
+/**
+ * The same as cfe_baby_giant_with_neg, but it splits the baby steps and the
+ * giant steps among the given number of threads.
+ *
+ * @param res Discrete logarithm (the result value placeholder)
+ * @param h Element
+ * @param g Generator
+ * @param p Modulus
+ * @param _order Order
+ * @param bound Bound for solution
+ * @param num_threads The number of threads; if 0, the number set by
+ * cfe_dlog_set_num_threads is used
+ * @return Error code
+ */
+cfe_error cfe_baby_giant_with_neg_parallel(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t _order, mpz_t bound,
+                                           size_t num_threads);
+
+/**
+ * @brief Pollard's kangaroo (lambda) method for computing the discrete
+ * logarithm in the Zp group in a bounded interval.
+ *
+ * It searches for a solution in the interval [-bound, bound] in about
+ * 2*sqrt(2*bound) group operations. Unlike the baby-step giant-step method
+ * it needs only a constant amount of memory per thread, plus a small table
+ * of distinguished points shared by all the threads, so it can be used for
+ * bounds for which the table of baby steps would not fit into memory.
+ * The function returns x, where h = g^x mod p. If the solution was not found
+ * within the provided bound, it returns an error. The walks are computed in
+ * Montgomery form, so an error is also returned for an even modulus p.
+ *
+ * @param res Discrete logarithm (the result value placeholder)
+ * @param h Element
+ * @param g Generator
+ * @param p Modulus
+ * @param bound Bound for solution
+ * @return Error code
+ */
+cfe_error cfe_kangaroo_with_neg(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t bound);
+
+/**
+ * The same as cfe_kangaroo_with_neg, but it runs a tame and a wild kangaroo
+ * in each of the given number of threads. The kangaroos of all the threads
+ * share the distinguished points, so the expected running time decreases
+ * linearly with the number of threads.
+ *
+ * @param res Discrete logarithm (the result value placeholder)
+ * @param h Element
+ * @param g Generator
+ * @param p Modulus
+ * @param bound Bound for solution
+ * @param num_threads The number of threads; if 0, the number set by
+ * cfe_dlog_set_num_threads is used
+ * @return Error code
+ */
+cfe_error cfe_kangaroo_with_neg_parallel(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t bound, size_t num_threads);
+
+/**
+ * @brief Pollard's rho algorithm.
+ *
+ * It uses the parallel variant of van Oorschot and Wiener with an adding
+ * walk of 20 random multipliers g^a_j * h^b_j and distinguished points, run
+ * in the number of threads set by cfe_dlog_set_num_threads. It needs about
+ * sqrt(pi*n/2) group operations in total. The function returns x, where
+ * h = g^x mod p and 0 <= x < n. If the solution was not found, or if the
+ * modulus p is even, it returns an error.
  *
  * @param res Discrete logarithm (the result value placeholder)
  * @param h Element
@@ -82,6 +441,169 @@ cfe_error cfe_baby_giant_with_neg(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t _o
  */
 cfe_error cfe_pollard_rho(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t n);
 
+/**
+ * A callback reporting the progress of a long computation of a discrete
+ * logarithm. It is given the number of steps (group operations) made so far
+ * and the expected total number of steps, and it can cancel the computation
+ * by returning a nonzero value.
+ */
+typedef int (*cfe_dlog_progress)(uint64_t steps, uint64_t expected_steps, void *data);
+
+/**
+ * The same as cfe_pollard_rho, but it runs a walk in each of the given
+ * number of threads, which share the distinguished points, so the expected
+ * running time decreases linearly with the number of threads.
+ * If progress is not NULL, it is called from one of the threads every 65536
+ * steps of that thread; if it returns a nonzero value, all the threads are
+ * stopped and CFE_ERR_CANCELLED is returned.
+ *
+ * @param res Discrete logarithm (the result value placeholder)
+ * @param h Element
+ * @param g Generator
+ * @param p Modulus
+ * @param n Order
+ * @param num_threads The number of threads; if 0, the number set by
+ * cfe_dlog_set_num_threads is used
+ * @param progress The progress callback or NULL
+ * @param progress_data The data passed to the progress callback
+ * @return Error code
+ */
+cfe_error cfe_pollard_rho_parallel(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t n, size_t num_threads,
+                                   cfe_dlog_progress progress, void *progress_data);
+
+/**
+ * cfe_dlog_table_FP12_BN254 represents a precomputed table of baby steps for
+ * the baby-step giant-step method in the pairing group FP12_BN254. Like
+ * cfe_dlog_table, it only stores a fingerprint and an index of each baby
+ * step. Fingerprints are read directly from the limbs of reduced elements,
+ * so no element is serialized, neither for the baby nor for the giant steps.
+ *
+ * The baby steps can be saved to a file with cfe_dlog_table_FP12_BN254_save
+ * and later mapped into memory with cfe_dlog_table_FP12_BN254_load, so that
+ * many processes share a single read-only copy of the table.
+ */
+typedef struct cfe_dlog_table_FP12_BN254 {
+    FP12_BN254 g; // generator
+    FP12_BN254 z; // giant step g^(-m)
+    size_t m; // number of baby steps
+    size_t giant_steps; // number of giant steps
+    mpz_t bound; // bound for solution
+    cfe_dlog_hash T; // baby steps
+    size_t num_threads; // number of threads used for the giant steps
+    void *map; // file mapping holding the baby steps, NULL if allocated
+    size_t map_len; // length of the file mapping
+} cfe_dlog_table_FP12_BN254;
+
+/**
+ * Initializes the table of baby steps for computing discrete logarithms with
+ * respect to generator g in the group FP12_BN254. The table covers solutions
+ * in the interval [-bound, bound]. An error is returned if the table would
+ * need 2^32 or more baby steps. As with cfe_dlog_table_init, the number of
+ * threads set by cfe_dlog_set_num_threads is used and stored in the table.
+ *
+ * @param t A pointer to an uninitialized cfe_dlog_table_FP12_BN254 struct
+ * @param g Generator
+ * @param bound Bound for solution
+ * @return Error code
+ */
+cfe_error cfe_dlog_table_FP12_BN254_init(cfe_dlog_table_FP12_BN254 *t, FP12_BN254 *g, mpz_t bound);
+
+/**
+ * The same as cfe_dlog_table_FP12_BN254_init, but configured as
+ * cfe_dlog_table_init_with_config.
+ *
+ * @param t A pointer to an uninitialized cfe_dlog_table_FP12_BN254 struct
+ * @param g Generator
+ * @param bound Bound for solution
+ * @param c A pointer to the configuration; if NULL, the default
+ * configuration is used
+ * @return Error code
+ */
+cfe_error cfe_dlog_table_FP12_BN254_init_with_config(cfe_dlog_table_FP12_BN254 *t, FP12_BN254 *g, mpz_t bound,
+                                                     cfe_dlog_config *c);
+
+/**
+ * Frees the memory occupied by the table, or unmaps the file if the table
+ * was loaded with cfe_dlog_table_FP12_BN254_load. It does not free memory
+ * occupied by the struct itself.
+ *
+ * @param t A pointer to an *initialized* cfe_dlog_table_FP12_BN254 struct
+ */
+void cfe_dlog_table_FP12_BN254_free(cfe_dlog_table_FP12_BN254 *t);
+
+/**
+ * Version of the format of the files written by
+ * cfe_dlog_table_FP12_BN254_save.
+ */
+#define CFE_DLOG_TABLE_VERSION 1
+
+/**
+ * Saves the table to a file. The file starts with a header holding a magic
+ * string, the format version, the generator and the bound, which is
+ * followed by the raw fingerprints and indices of the baby steps. The file
+ * is written in the byte order of the machine, so it can only be loaded on
+ * machines with the same byte order. The table is written to the file
+ * path followed by ".tmp", which then replaces the file, so processes
+ * which have the file mapped keep a complete table.
+ *
+ * @param t A pointer to an *initialized* cfe_dlog_table_FP12_BN254 struct
+ * @param path Path to the file
+ * @return Error code; CFE_ERR_INIT if the file could not be written
+ */
+cfe_error cfe_dlog_table_FP12_BN254_save(cfe_dlog_table_FP12_BN254 *t, const char *path);
+
+/**
+ * Initializes the table of baby steps from a file written by
+ * cfe_dlog_table_FP12_BN254_save. Instead of being read, the file is mapped
+ * into memory read-only, so loading is instant and all the processes using
+ * the same file share a single copy of it in the page cache. The file must
+ * have been written for the same generator and bound, in the same format
+ * version, and its table must be consistent, with all the indices below
+ * the number of baby steps and at least one empty slot; otherwise an error
+ * is returned. The number of baby steps is
+ * taken from the file, so tables built with cfe_dlog_table_init_with_config
+ * can be loaded as well. The table must be freed with
+ * cfe_dlog_table_FP12_BN254_free, which unmaps the file.
+ *
+ * @param t A pointer to an uninitialized cfe_dlog_table_FP12_BN254 struct
+ * @param path Path to the file
+ * @param g Generator
+ * @param bound Bound for solution
+ * @return Error code; CFE_ERR_INIT if the file could not be mapped and
+ * CFE_ERR_MALFORMED_INPUT if it does not match the generator and bound or
+ * its table is damaged
+ */
+cfe_error cfe_dlog_table_FP12_BN254_load(cfe_dlog_table_FP12_BN254 *t, const char *path, FP12_BN254 *g,
+                                         mpz_t bound);
+
+/**
+ * Computes the discrete logarithm in the group FP12_BN254 using a
+ * precomputed table of baby steps. Positive and negative solutions are
+ * searched for simultaneously. The function returns x, where h = g^x and
+ * -bound <= x <= bound. If the solution was not found, it returns an error.
+ *
+ * @param res Discrete logarithm (the result value placeholder)
+ * @param h Element
+ * @param t A pointer to an *initialized* cfe_dlog_table_FP12_BN254 struct
+ * @return Error code
+ */
+cfe_error cfe_dlog_table_FP12_BN254_solve_with_neg(mpz_t res, FP12_BN254 *h, cfe_dlog_table_FP12_BN254 *t);
+
+/**
+ * The same as cfe_dlog_table_solve_batch_with_neg, but in the group
+ * FP12_BN254.
+ *
+ * @param res An array of n discrete logarithms (the result value placeholders)
+ * @param errs An array of n error codes for the elements; it can be NULL
+ * @param h An array of n elements
+ * @param n The number of elements
+ * @param t A pointer to an *initialized* cfe_dlog_table_FP12_BN254 struct
+ * @return CFE_ERR_NONE if all the discrete logarithms were found, otherwise
+ * CFE_ERR_DLOG_NOT_FOUND
+ */
+cfe_error cfe_dlog_table_FP12_BN254_solve_batch_with_neg(mpz_t *res, cfe_error *errs, FP12_BN254 *h, size_t n,
+                                                         cfe_dlog_table_FP12_BN254 *t);
+
 /**
  * @brief Baby-step giant-step method for computing the discrete logarithm in
  * the pairing group FP12_BN254 finding also negative solutions.
@@ -98,4 +620,167 @@ cfe_error cfe_pollard_rho(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t n);
  */
 cfe_error cfe_baby_giant_FP12_BN256_with_neg(mpz_t res, FP12_BN254 *h, FP12_BN254 *g, mpz_t bound);
 
+/**
+ * The same as cfe_baby_giant_FP12_BN256_with_neg, but it computes the
+ * discrete logarithms of n elements with a single table of baby steps. See
+ * cfe_dlog_table_solve_batch_with_neg.
+ *
+ * @param res An array of n discrete logarithms (the result value placeholders)
+ * @param errs An array of n error codes for the elements; it can be NULL
+ * @param h An array of n elements
+ * @param n The number of elements
+ * @param g Generator
+ * @param bound Bound for solution
+ * @return Error code
+ */
+cfe_error cfe_baby_giant_FP12_BN256_batch_with_neg(mpz_t *res, cfe_error *errs, FP12_BN254 *h, size_t n,
+                                                   FP12_BN254 *g, mpz_t bound);
+
+/**
+ * cfe_dlog_table_ECP_BN254 represents a precomputed table of baby steps for
+ * the baby-step giant-step method in the elliptic curve group ECP_BN254.
+ * The fingerprint of a point is read from its affine x coordinate, which is
+ * the same for the points i*g and -i*g. A single table of m baby steps thus
+ * covers the 2m - 1 multiples of g in (-m, m), and every giant step moves
+ * by 2m - 1 instead of m, halving the number of giant steps compared to
+ * cfe_dlog_table_FP12_BN254.
+ */
+typedef struct cfe_dlog_table_ECP_BN254 {
+    ECP_BN254 g; // generator
+    ECP_BN254 z; // giant step -(2m - 1)*g
+    size_t m; // number of baby steps
+    size_t giant_steps; // number of giant steps in each direction
+    mpz_t bound; // bound for solution
+    cfe_dlog_hash T; // baby steps
+    size_t num_threads; // number of threads used for the giant steps
+} cfe_dlog_table_ECP_BN254;
+
+/**
+ * Initializes the table of baby steps for computing discrete logarithms with
+ * respect to generator g in the group ECP_BN254. The table covers solutions
+ * in the interval [-bound, bound]. An error is returned if the table would
+ * need 2^32 or more baby steps. As with cfe_dlog_table_init, the number of
+ * threads set by cfe_dlog_set_num_threads is used and stored in the table.
+ *
+ * @param t A pointer to an uninitialized cfe_dlog_table_ECP_BN254 struct
+ * @param g Generator
+ * @param bound Bound for solution
+ * @return Error code
+ */
+cfe_error cfe_dlog_table_ECP_BN254_init(cfe_dlog_table_ECP_BN254 *t, ECP_BN254 *g, mpz_t bound);
+
+/**
+ * The same as cfe_dlog_table_ECP_BN254_init, but configured as
+ * cfe_dlog_table_init_with_config.
+ *
+ * @param t A pointer to an uninitialized cfe_dlog_table_ECP_BN254 struct
+ * @param g Generator
+ * @param bound Bound for solution
+ * @param c A pointer to the configuration (see cfe_dlog_config); if NULL, the
+ * default configuration is used
+ * @return Error code
+ */
+cfe_error cfe_dlog_table_ECP_BN254_init_with_config(cfe_dlog_table_ECP_BN254 *t, ECP_BN254 *g, mpz_t bound,
+                                                    cfe_dlog_config *c);
+
+/**
+ * Frees the memory occupied by the table. It does not free memory occupied
+ * by the struct itself.
+ *
+ * @param t A pointer to an *initialized* cfe_dlog_table_ECP_BN254 struct
+ */
+void cfe_dlog_table_ECP_BN254_free(cfe_dlog_table_ECP_BN254 *t);
+
+/**
+ * Computes the discrete logarithm in the group ECP_BN254 using a
+ * precomputed table of baby steps. It searches for a solution in the
+ * interval [-bound, bound], where bound is the one the table was
+ * initialized with.
+ *
+ * @param res Discrete logarithm (the result value placeholder)
+ * @param h Element
+ * @param t A pointer to an *initialized* cfe_dlog_table_ECP_BN254 struct
+ * @return Error code
+ */
+cfe_error cfe_dlog_table_ECP_BN254_solve_with_neg(mpz_t res, ECP_BN254 *h, cfe_dlog_table_ECP_BN254 *t);
+
+/**
+ * @brief Baby-step giant-step method for computing the discrete logarithm in
+ * the elliptic curve group ECP_BN254 finding also negative solutions.
+ *
+ * It searches for a solution [-bound, bound]. The function returns x, where
+ * h = x*g in the group. If the solution was not found within the provided
+ * bound, it returns an error.
+ *
+ * @param res Discrete logarithm (the result value placeholder)
+ * @param h Element
+ * @param g Generator
+ * @param bound Bound for solution
+ * @return Error code
+ */
+cfe_error cfe_baby_giant_ECP_BN254_with_neg(mpz_t res, ECP_BN254 *h, ECP_BN254 *g, mpz_t bound);
+
+
+/**
+ * @brief Pollard's kangaroo (lambda) method for computing the discrete
+ * logarithm in the pairing group FP12_BN254 in a bounded interval.
+ *
+ * The same as cfe_kangaroo_with_neg, but in the group FP12_BN254.
+ *
+ * @param res Discrete logarithm (the result value placeholder)
+ * @param h Element
+ * @param g Generator
+ * @param bound Bound for solution
+ * @return Error code
+ */
+cfe_error cfe_kangaroo_FP12_BN254_with_neg(mpz_t res, FP12_BN254 *h, FP12_BN254 *g, mpz_t bound);
+
+/**
+ * The same as cfe_kangaroo_FP12_BN254_with_neg, but it runs a tame and a
+ * wild kangaroo in each of the given number of threads.
+ *
+ * @param res Discrete logarithm (the result value placeholder)
+ * @param h Element
+ * @param g Generator
+ * @param bound Bound for solution
+ * @param num_threads The number of threads; if 0, the number set by
+ * cfe_dlog_set_num_threads is used
+ * @return Error code
+ */
+cfe_error cfe_kangaroo_FP12_BN254_with_neg_parallel(mpz_t res, FP12_BN254 *h, FP12_BN254 *g, mpz_t bound,
+                                                   size_t num_threads);
+
+/**
+ * Computes the discrete logarithm x, where h = g^x mod p and
+ * -bound <= x <= bound, with the algorithm, number of threads and table
+ * size given by the configuration (see cfe_dlog_config). With
+ * CFE_DLOG_AUTO, the algorithm with fewer expected steps is chosen as
+ * predicted by cfe_dlog_predict. If bound argument is nil, the baby-step
+ * giant-step method is used as in cfe_baby_giant_with_neg.
+ *
+ * @param res Discrete logarithm (the result value placeholder)
+ * @param h Element
+ * @param g Generator
+ * @param p Modulus
+ * @param order Order
+ * @param bound Bound for solution
+ * @param c A pointer to the configuration; if NULL, the default
+ * configuration is used
+ * @return Error code
+ */
+cfe_error cfe_dlog_with_neg(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t order, mpz_t bound, cfe_dlog_config *c);
+
+/**
+ * The same as cfe_dlog_with_neg, but in the group FP12_BN254.
+ *
+ * @param res Discrete logarithm (the result value placeholder)
+ * @param h Element
+ * @param g Generator
+ * @param bound Bound for solution
+ * @param c A pointer to the configuration; if NULL, the default
+ * configuration is used
+ * @return Error code
+ */
+cfe_error cfe_dlog_FP12_BN254_with_neg(mpz_t res, FP12_BN254 *h, FP12_BN254 *g, mpz_t bound, cfe_dlog_config *c);
+
 #endif
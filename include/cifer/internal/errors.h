@@ -49,6 +49,7 @@ typedef enum cfe_error {
     CFE_ERR_CORRUPTED_BOOL_EXPRESSION,
     CFE_ERR_NO_SOLUTION_EXISTS,
     CFE_ERR_NO_INVERSE,
+    CFE_ERR_CANCELLED,
 } cfe_error;
 
 #endif
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2018 XLAB d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef CIFER_MODCTX_H
+#define CIFER_MODCTX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <gmp.h>
+
+#include "cifer/internal/errors.h"
+
+/**
+ * \file
+ * \ingroup internal
+ * \brief Montgomery arithmetic modulo a fixed odd modulus.
+ */
+
+/**
+ * cfe_modctx holds the constants for Montgomery multiplication modulo a
+ * fixed odd modulus m of n limbs. Elements are arrays of exactly n limbs
+ * holding a*R mod m, where R = 2^(n*GMP_NUMB_BITS), and are multiplied with
+ * GMP's mpn functions followed by a Montgomery reduction. Unlike mpz_mul
+ * followed by mpz_mod, a product needs no allocation and no division, so
+ * long chains of multiplications (exponentiations, walks of discrete
+ * logarithm algorithms) keep their elements in this form and only convert
+ * at the ends.
+ *
+ * Elements are always fully reduced, so two elements are equal if and
+ * only if their limbs are, and the limbs can be used as a fingerprint of
+ * the element.
+ */
+typedef struct cfe_modctx {
+    size_t n; // number of limbs of the modulus
+    mp_limb_t *m; // modulus
+    mp_limb_t m_inv; // -m^(-1) mod 2^GMP_NUMB_BITS
+    mp_limb_t *r2; // R^2 mod m
+    mp_limb_t *one; // R mod m, the Montgomery form of 1
+} cfe_modctx;
+
+/**
+ * Initializes the context for the modulus m.
+ *
+ * @param ctx A pointer to an uninitialized cfe_modctx struct
+ * @param m Modulus
+ * @return Error code; CFE_ERR_MALFORMED_INPUT if m is even or smaller
+ * than 3, in which case ctx is left uninitialized
+ */
+cfe_error cfe_modctx_init(cfe_modctx *ctx, mpz_t m);
+
+/**
+ * Copies the context.
+ *
+ * @param res A pointer to an uninitialized cfe_modctx struct
+ * @param ctx A pointer to an *initialized* cfe_modctx struct
+ */
+void cfe_modctx_copy(cfe_modctx *res, cfe_modctx *ctx);
+
+/**
+ * Frees the memory occupied by the context. It does not free memory
+ * occupied by the struct itself.
+ *
+ * @param ctx A pointer to an *initialized* cfe_modctx struct
+ */
+void cfe_modctx_free(cfe_modctx *ctx);
+
+/**
+ * Allocates an array of count elements, i.e. count * n limbs. It needs to
+ * be freed with free.
+ *
+ * @param ctx A pointer to an *initialized* cfe_modctx struct
+ * @param count The number of elements
+ * @return A pointer to the first element
+ */
+mp_limb_t *cfe_modctx_alloc(cfe_modctx *ctx, size_t count);
+
+/**
+ * Converts an integer into the Montgomery form, r = a*R mod m. Any integer
+ * can be converted; it is reduced modulo m first.
+ *
+ * @param ctx A pointer to an *initialized* cfe_modctx struct
+ * @param r The element (n limbs)
+ * @param a The integer
+ */
+void cfe_modctx_set(cfe_modctx *ctx, mp_limb_t *r, mpz_t a);
+
+/**
+ * Converts an element back from the Montgomery form, r = a/R mod m.
+ *
+ * @param ctx A pointer to an *initialized* cfe_modctx struct
+ * @param r The integer (the result will be stored here)
+ * @param a The element (n limbs)
+ */
+void cfe_modctx_get(cfe_modctx *ctx, mpz_t r, mp_limb_t *a);
+
+/**
+ * Sets r to the Montgomery form of 1.
+ *
+ * @param ctx A pointer to an *initialized* cfe_modctx struct
+ * @param r The element (n limbs)
+ */
+void cfe_modctx_set_one(cfe_modctx *ctx, mp_limb_t *r);
+
+/**
+ * Returns true if a is the Montgomery form of 1.
+ *
+ * @param ctx A pointer to an *initialized* cfe_modctx struct
+ * @param a The element (n limbs)
+ * @return true if a represents 1, false otherwise
+ */
+bool cfe_modctx_is_one(cfe_modctx *ctx, mp_limb_t *a);
+
+/**
+ * Computes the product r = a*b of two elements in the Montgomery form. Any
+ * of the elements may be the same.
+ *
+ * @param ctx A pointer to an *initialized* cfe_modctx struct
+ * @param r The product (n limbs)
+ * @param a The first factor (n limbs)
+ * @param b The second factor (n limbs)
+ */
+void cfe_modctx_mul(cfe_modctx *ctx, mp_limb_t *r, mp_limb_t *a, mp_limb_t *b);
+
+/**
+ * Computes the square r = a*a of an element in the Montgomery form. The
+ * elements may be the same.
+ *
+ * @param ctx A pointer to an *initialized* cfe_modctx struct
+ * @param r The square (n limbs)
+ * @param a The element (n limbs)
+ */
+void cfe_modctx_sqr(cfe_modctx *ctx, mp_limb_t *r, mp_limb_t *a);
+
+#endif
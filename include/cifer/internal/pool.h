@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2018 XLAB d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CIFER_POOL_H
+#define CIFER_POOL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cifer/data/vec.h"
+
+/**
+ * \file
+ * \ingroup internal
+ * \brief A pool of precomputed values.
+ *
+ * Values that do not depend on the input, such as the randomness of a
+ * ciphertext, can be computed ahead of time (offline), either at once or on
+ * a background thread, so that only cheap operations are left for the time
+ * the input arrives (online).
+ */
+
+/**
+ * A function computing a fresh value of the pool from the data of the pool.
+ * It can be called from several threads at once, so it must not modify
+ * the data.
+ */
+typedef void (*cfe_pool_fill_fn)(cfe_vec *elem, void *data);
+
+/**
+ * A function freeing the data of the pool.
+ */
+typedef void (*cfe_pool_free_fn)(void *data);
+
+/**
+ * cfe_pool holds a bounded number of precomputed values, each of them a
+ * vector of the same size. Every value is handed out at most once. The
+ * background thread refers to the struct, so it must not be moved while
+ * the pool is in use.
+ */
+typedef struct cfe_pool {
+    cfe_vec *elems; // ring buffer of the values
+    size_t capacity; // the size of the buffer
+    size_t elem_size; // the size of each value
+    size_t head; // the position of the oldest value
+    size_t len; // the number of values in the pool
+    cfe_pool_fill_fn fill;
+    cfe_pool_free_fn free_data;
+    void *data;
+    pthread_mutex_t lock;
+    pthread_cond_t not_full;
+    bool background; // whether a background thread refills the pool
+    bool stop;
+    pthread_t thread;
+} cfe_pool;
+
+/**
+ * Initializes an empty pool. If background is true, a thread is started
+ * that keeps the pool full; if the thread cannot be started, the pool has
+ * to be filled with cfe_pool_fill.
+ *
+ * @param p A pointer to an uninitialized cfe_pool struct
+ * @param capacity The largest number of values in the pool
+ * @param elem_size The size of each value
+ * @param fill A function computing a value
+ * @param free_data A function freeing data when the pool is freed, or NULL
+ * @param data Data passed to fill
+ * @param background Whether to refill the pool on a background thread
+ */
+void cfe_pool_init(cfe_pool *p, size_t capacity, size_t elem_size, cfe_pool_fill_fn fill,
+                   cfe_pool_free_fn free_data, void *data, bool background);
+
+/**
+ * Starts the background thread which keeps the pool full, if it is not
+ * running yet, such as for a pool initialized without it.
+ *
+ * @param p A pointer to an *initialized* cfe_pool struct
+ * @return true if the background thread is running, false if it could not
+ * be started
+ */
+bool cfe_pool_start(cfe_pool *p);
+
+/**
+ * Fills the pool up to its capacity in the calling thread.
+ *
+ * @param p A pointer to an *initialized* cfe_pool struct
+ */
+void cfe_pool_fill(cfe_pool *p);
+
+/**
+ * Takes a value out of the pool. If the pool is empty, the value is
+ * computed in the calling thread.
+ *
+ * @param res A pointer to an *initialized* vector of size elem_size, where
+ * the value is stored
+ * @param p A pointer to an *initialized* cfe_pool struct
+ */
+void cfe_pool_take(cfe_vec *res, cfe_pool *p);
+
+/**
+ * Takes a value out of the pool if there is one, without computing it.
+ *
+ * @param res A pointer to an *initialized* vector of size elem_size, where
+ * the value is stored
+ * @param p A pointer to an *initialized* cfe_pool struct
+ * @return true if a value was taken, false if the pool is empty
+ */
+bool cfe_pool_try_take(cfe_vec *res, cfe_pool *p);
+
+/**
+ * Returns the number of values currently in the pool.
+ *
+ * @param p A pointer to an *initialized* cfe_pool struct
+ * @return The number of values
+ */
+size_t cfe_pool_len(cfe_pool *p);
+
+/**
+ * Stops the background thread and frees the memory occupied by the pool
+ * and its data. It does not free memory occupied by the struct itself.
+ *
+ * @param p A pointer to an *initialized* cfe_pool struct
+ */
+void cfe_pool_free(cfe_pool *p);
+
+#endif
@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2018 XLAB d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CIFER_POWM_H
+#define CIFER_POWM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <gmp.h>
+
+#include "cifer/data/vec.h"
+#include "cifer/internal/errors.h"
+#include "cifer/internal/modctx.h"
+
+/**
+ * \file
+ * \ingroup internal
+ * \brief Modular exponentiation with a fixed base.
+ */
+
+/**
+ * The default number of teeth of the comb used by cfe_fixed_base_init.
+ */
+#define CFE_FIXED_BASE_TEETH 8
+
+/**
+ * The default number of tables of the comb used by cfe_fixed_base_init.
+ */
+#define CFE_FIXED_BASE_TABLES 2
+
+/**
+ * cfe_fixed_base holds a precomputation for computing powers g^e mod p of a
+ * fixed base g, using the comb method of Lim and Lee.
+ *
+ * An exponent of at most bits bits is split into h pieces of a = bits / h
+ * bits (rounded up), and each piece into v blocks of b = a / v bits. The
+ * table t (t < v) holds for every nonzero h-bit number u the product of
+ * g^(2^(j*a + t*b)) over all the bits j set in u. A power is then computed
+ * with only b squarings and at most v*b multiplications, instead of the
+ * bits squarings of a generic exponentiation. The precomputation holds
+ * v * (2^h - 1) elements of Zp in Montgomery form, so the modulus must be
+ * odd; for an even modulus all the powers are computed by mpz_powm.
+ */
+typedef struct cfe_fixed_base {
+    mpz_t g; // base
+    mpz_t p; // modulus
+    size_t bits; // maximal bit length of exponents covered by the tables
+    size_t h; // number of pieces of the exponent (teeth of the comb)
+    size_t v; // number of tables
+    size_t a; // bit length of a piece
+    size_t b; // bit length of a block
+    cfe_modctx ctx; // arithmetic modulo p
+    mp_limb_t *tables; // v tables of 2^h elements, the first one of each unused,
+                       // or NULL if p is even
+} cfe_fixed_base;
+
+/**
+ * Builds the precomputation for the base g and modulus p with the default
+ * parameters CFE_FIXED_BASE_TEETH and CFE_FIXED_BASE_TABLES. Exponents
+ * with more than bits bits are handled by a generic exponentiation.
+ *
+ * @param fb A pointer to an uninitialized cfe_fixed_base struct
+ * @param g Base
+ * @param p Modulus
+ * @param bits The maximal bit length of exponents
+ */
+void cfe_fixed_base_init(cfe_fixed_base *fb, mpz_t g, mpz_t p, size_t bits);
+
+/**
+ * Builds the precomputation with the given number of teeth h and tables v,
+ * which trade the size of the tables, v * (2^h - 1) elements, for the
+ * speed of exponentiation.
+ *
+ * @param fb A pointer to an uninitialized cfe_fixed_base struct
+ * @param g Base
+ * @param p Modulus
+ * @param bits The maximal bit length of exponents
+ * @param h The number of teeth (between 1 and 16)
+ * @param v The number of tables (at least 1)
+ */
+void cfe_fixed_base_init_params(cfe_fixed_base *fb, mpz_t g, mpz_t p, size_t bits, size_t h, size_t v);
+
+/**
+ * Copies the precomputation.
+ *
+ * @param res A pointer to an uninitialized cfe_fixed_base struct
+ * @param fb A pointer to an *initialized* cfe_fixed_base struct
+ */
+void cfe_fixed_base_copy(cfe_fixed_base *res, cfe_fixed_base *fb);
+
+/**
+ * Frees the memory occupied by the precomputation. It does not free memory
+ * occupied by the struct itself.
+ *
+ * @param fb A pointer to an *initialized* cfe_fixed_base struct
+ */
+void cfe_fixed_base_free(cfe_fixed_base *fb);
+
+/**
+ * Computes res = g^e mod p. A negative exponent gives the inverse of
+ * g^(-e), as with mpz_powm.
+ *
+ * @param res The result (it can be the same as e)
+ * @param fb A pointer to an *initialized* cfe_fixed_base struct
+ * @param e Exponent
+ */
+void cfe_fixed_base_powm(mpz_t res, cfe_fixed_base *fb, mpz_t e);
+
+/**
+ * cfe_fixed_base_vec holds the precomputations for a vector of bases with a
+ * common modulus, such as a public key, whose powers are needed many times.
+ */
+typedef struct cfe_fixed_base_vec {
+    size_t size;
+    cfe_fixed_base *bases;
+} cfe_fixed_base_vec;
+
+/**
+ * Returns the largest number of teeth of a comb with CFE_FIXED_BASE_TABLES
+ * tables (but at least 1 and at most 16) whose precomputation modulo a
+ * mod_bits-bit modulus fits into memory_budget bytes.
+ *
+ * @param mod_bits The bit length of the modulus
+ * @param memory_budget The size of the precomputation in bytes
+ * @return The number of teeth
+ */
+size_t cfe_fixed_base_teeth(size_t mod_bits, size_t memory_budget);
+
+/**
+ * Builds the precomputations for all the elements of the vector bases.
+ * Memory use grows linearly with the size of the vector, so it can be
+ * limited with memory_budget.
+ *
+ * @param fbv A pointer to an uninitialized cfe_fixed_base_vec struct
+ * @param bases A pointer to the vector of bases
+ * @param p Modulus
+ * @param bits The maximal bit length of exponents
+ * @param memory_budget The size of all the precomputations together in
+ * bytes; if 0, each base uses CFE_FIXED_BASE_TEETH teeth
+ */
+void cfe_fixed_base_vec_init(cfe_fixed_base_vec *fbv, cfe_vec *bases, mpz_t p, size_t bits, size_t memory_budget);
+
+/**
+ * Frees the memory occupied by the precomputations. It does not free
+ * memory occupied by the struct itself.
+ *
+ * @param fbv A pointer to an *initialized* cfe_fixed_base_vec struct
+ */
+void cfe_fixed_base_vec_free(cfe_fixed_base_vec *fbv);
+
+/**
+ * Builds the precomputations for the elements of the vector bases which are
+ * to be used for uses exponentiations, such as the elements of a ciphertext
+ * raised to the exponents of many functional keys. The exponents of the base
+ * i have at most bits[i] bits, and the number of teeth and tables of each
+ * comb is chosen to minimize the cost of building it together with the
+ * cost of all the exponentiations.
+ *
+ * @param fbv A pointer to an uninitialized cfe_fixed_base_vec struct
+ * @param bases A pointer to the vector of bases
+ * @param p Modulus
+ * @param bits An array with the maximal bit length of exponents of each base
+ * @param uses The expected number of exponentiations of each base
+ */
+void cfe_fixed_base_vec_init_batch(cfe_fixed_base_vec *fbv, cfe_vec *bases, mpz_t p, size_t *bits, size_t uses);
+
+/**
+ * Computes the product of bases_i^exps_i mod p over all the bases of the
+ * precomputations. The powers with negative exponents are inverted together
+ * with a single modular inversion.
+ *
+ * @param res The result
+ * @param fbv A pointer to an *initialized* cfe_fixed_base_vec struct
+ * @param exps A pointer to the vector of exponents, of the same size as
+ * the vector of bases
+ * @return Error code; CFE_ERR_MALFORMED_INPUT if the sizes differ,
+ * CFE_ERR_NO_INVERSE if a base with a negative exponent is not invertible
+ */
+cfe_error cfe_fixed_base_vec_powm(mpz_t res, cfe_fixed_base_vec *fbv, cfe_vec *exps);
+
+/**
+ * Computes res[k] = cfe_fixed_base_vec_powm(fbv, exps[k]) for n vectors of
+ * exponents, split among the given number of threads. The precomputations
+ * are only read, so they are shared by all the threads.
+ *
+ * @param res An array of n results
+ * @param errs An array of n error codes, one for each vector of exponents;
+ * it can be NULL
+ * @param fbv A pointer to an *initialized* cfe_fixed_base_vec struct
+ * @param exps An array of n vectors of exponents
+ * @param n The number of vectors of exponents
+ * @param num_threads The number of threads (0 is treated as 1)
+ * @return Error code; the first error of any of the exponentiations
+ */
+cfe_error cfe_fixed_base_vec_powm_batch(mpz_t *res, cfe_error *errs, cfe_fixed_base_vec *fbv, cfe_vec *exps,
+                                        size_t n, size_t num_threads);
+
+/**
+ * Computes the product of bases_i^exps_i mod m over all i with a single
+ * interleaved (Straus) exponentiation: all the powers share one sequence of
+ * squarings, and each base is multiplied in through a fixed window whose
+ * size is chosen from the bit length of its exponent, so that small
+ * exponents cost only a few multiplications. A single exponent much longer
+ * than all the others is computed separately by mpz_powm. Bases with
+ * negative exponents are inverted together with a single modular inversion.
+ *
+ * @param res The result
+ * @param bases A pointer to the vector of bases
+ * @param exps A pointer to the vector of exponents, of the same size as bases
+ * @param m Modulus
+ * @return Error code; CFE_ERR_MALFORMED_INPUT if m is not an odd number
+ * greater than 1, CFE_ERR_NO_INVERSE if a base with a negative exponent
+ * is not invertible modulo m
+ */
+cfe_error cfe_multi_powm(mpz_t res, cfe_vec *bases, cfe_vec *exps, mpz_t m);
+
+/**
+ * The largest bit length of a bound for which cfe_small_powers_init
+ * builds the tables; for larger bounds the tables are left empty.
+ */
+#define CFE_SMALL_POWERS_MAX_BITS 24
+
+/**
+ * The largest number of exponents for which cfe_small_powers_init builds
+ * a single table instead of a split one.
+ */
+#define CFE_SMALL_POWERS_SINGLE 256
+
+/**
+ * cfe_small_powers holds the powers g^k mod p for all k in [-bound, bound],
+ * so that raising g to a small (possibly negative) exponent becomes a table
+ * lookup.
+ *
+ * For small bounds a single table holds all the powers. Otherwise the
+ * exponent k + bound is split into its low and high low_bits-bit halves,
+ * and g^k is the product of one element of the table of low powers g^j and
+ * one of the table of high powers g^(i*2^low_bits - bound). The two tables
+ * hold about 2 * sqrt(2 * bound) elements of Zp.
+ */
+typedef struct cfe_small_powers {
+    mpz_t p; // modulus
+    mpz_t bound; // bound on the absolute value of the exponents
+    size_t low_bits; // bit length of the low half of an exponent
+    size_t low_len; // number of low powers, 0 if the tables are empty
+    size_t high_len; // number of high powers, 0 if a single table is used
+    mpz_t *low; // low powers, or all the powers g^(j - bound)
+    mpz_t *high; // high powers
+} cfe_small_powers;
+
+/**
+ * Builds the tables of powers g^k mod p for k in [-bound, bound]. If the
+ * bound has more than CFE_SMALL_POWERS_MAX_BITS bits, the tables are left
+ * empty and cfe_small_powers_get always fails.
+ *
+ * @param t A pointer to an uninitialized cfe_small_powers struct
+ * @param g Base
+ * @param p Modulus
+ * @param bound The bound on the absolute value of the exponents
+ */
+void cfe_small_powers_init(cfe_small_powers *t, mpz_t g, mpz_t p, mpz_t bound);
+
+/**
+ * Initializes empty tables, for which cfe_small_powers_get always fails,
+ * so that they can be built later with cfe_small_powers_init after
+ * freeing them.
+ *
+ * @param t A pointer to an uninitialized cfe_small_powers struct
+ * @param p Modulus
+ * @param bound The bound on the absolute value of the exponents
+ */
+void cfe_small_powers_init_empty(cfe_small_powers *t, mpz_t p, mpz_t bound);
+
+/**
+ * Copies the tables.
+ *
+ * @param res A pointer to an uninitialized cfe_small_powers struct
+ * @param t A pointer to an *initialized* cfe_small_powers struct
+ */
+void cfe_small_powers_copy(cfe_small_powers *res, cfe_small_powers *t);
+
+/**
+ * Frees the memory occupied by the tables. It does not free memory
+ * occupied by the struct itself.
+ *
+ * @param t A pointer to an *initialized* cfe_small_powers struct
+ */
+void cfe_small_powers_free(cfe_small_powers *t);
+
+/**
+ * Looks up res = g^k mod p. It returns false and leaves res untouched if
+ * k is not covered by the tables.
+ *
+ * @param res The result (it can be the same as k)
+ * @param t A pointer to an *initialized* cfe_small_powers struct
+ * @param k Exponent
+ * @return true if k is in the tables, false otherwise
+ */
+bool cfe_small_powers_get(mpz_t res, cfe_small_powers *t, mpz_t k);
+
+#endif
@@ -18,6 +18,7 @@
 #define CIFER_PRIME_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <gmp.h>
 
 #include "cifer/internal/errors.h"
@@ -28,6 +29,17 @@
  * \brief Prime number related functions.
  */
 
+/**
+ * The bound on the small primes by which the candidates are sieved in
+ * cfe_get_prime.
+ */
+#define CFE_PRIME_SIEVE_LIMIT (1 << 16)
+
+/**
+ * The number of consecutive odd candidates which are sieved at once.
+ */
+#define CFE_PRIME_SIEVE_SIZE 8192
+
 /**
  * Checks whether the number passed as argument is a safe prime.
  *
@@ -38,7 +50,13 @@ bool cfe_is_safe_prime(mpz_t p);
 
 /**
  * Sets the first argument to a prime with specified bit length.
- * The prime will be a safe prime if the safe parameter is true.
+ * The prime will be a safe prime if the safe parameter is true. The
+ * candidates are sieved by the primes below CFE_PRIME_SIEVE_LIMIT (for a
+ * safe prime p both p and (p-1)/2 are sieved), and the remaining ones pass a
+ * Fermat test before the Miller-Rabin tests. The search uses the number of
+ * threads set by cfe_prime_set_num_threads. If a cache of primes of the
+ * same bit length and kind is registered and not empty, the prime is taken
+ * from it instead (see cfe_prime_cache_register).
  *
  * @param res The safe prime (result value is stored here)
  * @param bits Bit length of the safe prime
@@ -47,4 +65,33 @@ bool cfe_is_safe_prime(mpz_t p);
  */
 cfe_error cfe_get_prime(mpz_t res, size_t bits, bool safe);
 
+/**
+ * The same as cfe_get_prime, but the search is split among the given
+ * number of threads, each trying its own random candidates. All the
+ * threads stop as soon as one of them finds a prime.
+ *
+ * @param res The prime (result value is stored here)
+ * @param bits Bit length of the prime
+ * @param safe Boolean value if the prime will be safe or not
+ * @param num_threads The number of threads; if 0, the number set by
+ * cfe_prime_set_num_threads is used
+ * @return Error code
+ */
+cfe_error cfe_get_prime_parallel(mpz_t res, size_t bits, bool safe, size_t num_threads);
+
+/**
+ * Sets the number of threads used by cfe_get_prime, and thus by the
+ * generation of the parameters of the schemes. The default is 1.
+ *
+ * @param num_threads The number of threads (0 is treated as 1)
+ */
+void cfe_prime_set_num_threads(size_t num_threads);
+
+/**
+ * Returns the number of threads set by cfe_prime_set_num_threads.
+ *
+ * @return The number of threads
+ */
+size_t cfe_prime_get_num_threads(void);
+
 #endif
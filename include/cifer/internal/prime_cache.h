@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2018 XLAB d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CIFER_PRIME_CACHE_H
+#define CIFER_PRIME_CACHE_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <gmp.h>
+
+#include "cifer/internal/errors.h"
+#include "cifer/internal/pool.h"
+
+/**
+ * \file
+ * \ingroup internal
+ * \brief A cache of primes generated ahead of time.
+ *
+ * The parameters of the schemes (DDH, Damgard, LWE, Paillier) are built
+ * from random primes, whose search takes an unpredictable amount of time.
+ * A cache keeps primes of a given bit length in a pool, which can be
+ * refilled on a background thread and kept in a file between runs. While a
+ * cache is registered, cfe_get_prime takes its primes from it, so the
+ * initialization of the schemes only searches for a prime when the cache is
+ * empty.
+ */
+
+/**
+ * cfe_prime_cache holds primes of a single bit length, either all safe
+ * primes or all primes. Every prime is handed out at most once, also
+ * across runs: a prime is removed from the file before it is handed out,
+ * and a file can only be used by a single cache at a time, which holds a
+ * lock on it (the file path followed by ".lock") while it is open. The
+ * primes of Paillier schemes are their secret keys, so the file is only
+ * readable by its owner. The background thread and the list of registered
+ * caches refer to the struct, so it must not be moved while it is in use.
+ */
+typedef struct cfe_prime_cache {
+    size_t bits; // bit length of the primes
+    bool safe; // whether the primes are safe primes
+    char *path; // file where the primes are kept, or NULL
+    int lock_fd; // the locked lock file, or -1
+    pthread_mutex_t file_lock; // serializes taking primes and writing the file
+    cfe_pool pool;
+    size_t refs; // number of threads using the cache through the registry
+    struct cfe_prime_cache *next; // the next registered cache
+} cfe_prime_cache;
+
+/**
+ * Initializes a cache of primes of the given bit length. If path is not
+ * NULL, the file is locked and the primes kept in it are loaded into the
+ * cache; each of them is checked for its bit length and (safe) primality
+ * with the same number of rounds as generated primes, and those which fail
+ * are dropped. A missing file gives an empty cache. If background is true,
+ * a thread is started that keeps the cache full.
+ *
+ * @param c A pointer to an uninitialized cfe_prime_cache struct
+ * @param bits The bit length of the primes
+ * @param safe Whether the primes are safe primes
+ * @param capacity The largest number of primes in the cache
+ * @param path The file where the primes are kept, or NULL
+ * @param background Whether to refill the cache on a background thread
+ * @return Error code; CFE_ERR_PRECONDITION_FAILED if there are no primes of
+ * the given bit length, CFE_ERR_INIT if the file cannot be read or it is
+ * already used by another cache, in this or any other process
+ */
+cfe_error cfe_prime_cache_init(cfe_prime_cache *c, size_t bits, bool safe, size_t capacity, const char *path,
+                               bool background);
+
+/**
+ * Fills the cache up to its capacity in the calling thread and saves it.
+ *
+ * @param c A pointer to an *initialized* cfe_prime_cache struct
+ * @return Error code; CFE_ERR_INIT if the file cannot be written
+ */
+cfe_error cfe_prime_cache_fill(cfe_prime_cache *c);
+
+/**
+ * Takes a prime out of the cache and saves the remaining ones before
+ * returning it; if the file cannot be written, it is removed instead, so
+ * that the prime is never handed out again. If the cache is empty, a prime
+ * is searched for in the calling thread.
+ *
+ * @param res The prime (result value is stored here)
+ * @param c A pointer to an *initialized* cfe_prime_cache struct
+ */
+void cfe_prime_cache_take(mpz_t res, cfe_prime_cache *c);
+
+/**
+ * Returns the number of primes currently in the cache.
+ *
+ * @param c A pointer to an *initialized* cfe_prime_cache struct
+ * @return The number of primes
+ */
+size_t cfe_prime_cache_len(cfe_prime_cache *c);
+
+/**
+ * Writes the primes currently in the cache to its file, one hexadecimal
+ * number per line. The file is replaced at once, so that it is never left
+ * partly written. It does nothing if the cache has no file.
+ *
+ * @param c A pointer to an *initialized* cfe_prime_cache struct
+ * @return Error code; CFE_ERR_INIT if the file cannot be written
+ */
+cfe_error cfe_prime_cache_save(cfe_prime_cache *c);
+
+/**
+ * Registers the cache, so that cfe_get_prime takes the primes of its bit
+ * length and kind from it while it is not empty.
+ *
+ * @param c A pointer to an *initialized* cfe_prime_cache struct
+ */
+void cfe_prime_cache_register(cfe_prime_cache *c);
+
+/**
+ * Removes the cache from the registered ones, waiting for the calls of
+ * cfe_get_prime which are taking a prime from it. It does nothing if the
+ * cache is not registered.
+ *
+ * @param c A pointer to an *initialized* cfe_prime_cache struct
+ */
+void cfe_prime_cache_unregister(cfe_prime_cache *c);
+
+/**
+ * Takes a prime from a registered cache of the given bit length and kind,
+ * if there is one which is not empty. It is called by cfe_get_prime.
+ *
+ * @param res The prime (result value is stored here)
+ * @param bits The bit length of the prime
+ * @param safe Whether the prime is a safe prime
+ * @return true if a prime was taken, false otherwise
+ */
+bool cfe_prime_cache_take_registered(mpz_t res, size_t bits, bool safe);
+
+/**
+ * Unregisters the cache, saves it, stops the background thread and frees
+ * the memory occupied by the cache. Primes found by the background thread
+ * after the cache was last saved are lost. It does not free memory
+ * occupied by the struct itself.
+ *
+ * @param c A pointer to an *initialized* cfe_prime_cache struct
+ */
+void cfe_prime_cache_free(cfe_prime_cache *c);
+
+#endif
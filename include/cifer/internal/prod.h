@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2018 XLAB d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CIFER_PROD_H
+#define CIFER_PROD_H
+
+#include <stddef.h>
+#include <gmp.h>
+
+#include "cifer/data/vec.h"
+#include "cifer/internal/errors.h"
+
+/**
+ * \file
+ * \ingroup internal
+ * \brief Products of many vectors modulo an odd modulus.
+ */
+
+/**
+ * The smallest number of vectors multiplied by each thread of
+ * cfe_vec_prod_mod; fewer threads are used for fewer vectors.
+ */
+#define CFE_PROD_MIN_PER_THREAD 16
+
+/**
+ * Computes the component-wise product of n vectors of the same size modulo
+ * m, i.e. res_j = vecs[0]_j * ... * vecs[n-1]_j mod m, such as the product
+ * of many ciphertexts encrypted under the same public key.
+ *
+ * The vectors are split into ranges among the threads, each multiplying its
+ * range in Montgomery form. The coordinates are not converted into
+ * Montgomery form one by one; instead, the powers of the Montgomery radix
+ * that the products accumulate are removed with a single multiplication at
+ * the end. The partial products of the threads are then combined pairwise,
+ * as a tree.
+ *
+ * @param res A pointer to an *initialized* vector of the same size as the
+ * vectors (the result will be stored here)
+ * @param vecs An array of n vectors
+ * @param n The number of vectors (at least 1)
+ * @param m Modulus
+ * @param num_threads The number of threads (0 is treated as 1)
+ * @return Error code; CFE_ERR_MALFORMED_INPUT if n is 0, if the sizes of
+ * the vectors differ, or if m is not an odd number greater than 1
+ */
+cfe_error cfe_vec_prod_mod(cfe_vec *res, cfe_vec *vecs, size_t n, mpz_t m, size_t num_threads);
+
+#endif
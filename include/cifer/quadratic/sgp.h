@@ -30,6 +30,7 @@
 
 #include "cifer/data/vec.h"
 #include "cifer/internal/errors.h"
+#include "cifer/internal/dlog.h"
 #include "cifer/data/vec_curve.h"
 
 /**
@@ -177,4 +178,65 @@ cfe_error cfe_sgp_encrypt(cfe_sgp_cipher *cipher, cfe_sgp *s, cfe_vec *x, cfe_ve
  */
 cfe_error cfe_sgp_decrypt(mpz_t res, cfe_sgp *s, cfe_sgp_cipher *cipher, ECP2_BN254 *key, cfe_mat *f);
 
+/**
+ * The same as cfe_sgp_decrypt, but the discrete logarithm is computed
+ * with the given configuration, which sets the algorithm, the number of
+ * threads and the size of the table of baby steps.
+ *
+ * @param res The result of the decryption (the value will be stored here)
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_sgp
+ * struct)
+ * @param cipher A pointer to the ciphertext
+ * @param key A pointer to the functional encryption key
+ * @param f A pointer to the matrix of the quadratic polynomial
+ * @param c A pointer to the configuration of the discrete logarithm (see
+ * cfe_dlog_config); if NULL, the default configuration is used
+ * @return Error code
+ */
+cfe_error cfe_sgp_decrypt_with_config(mpz_t res, cfe_sgp *s, cfe_sgp_cipher *cipher, ECP2_BN254 *key, cfe_mat *f,
+                                      cfe_dlog_config *c);
+
+/**
+ * Initializes the table of baby steps for computing the discrete logarithm
+ * needed for the decryption. The table depends only on the parameters of the
+ * scheme, so it can be reused for many decryptions with
+ * cfe_sgp_decrypt_with_table, or saved with cfe_dlog_table_FP12_BN254_save.
+ *
+ * @param t A pointer to an uninitialized cfe_dlog_table_FP12_BN254 struct;
+ * it needs to be freed with cfe_dlog_table_FP12_BN254_free
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_sgp
+ * struct)
+ * @return Error code
+ */
+cfe_error cfe_sgp_dlog_table_init(cfe_dlog_table_FP12_BN254 *t, cfe_sgp *s);
+
+/**
+ * Maps a table of baby steps saved with cfe_dlog_table_FP12_BN254_save
+ * into memory (see cfe_dlog_table_FP12_BN254_load). An error is returned if
+ * the table was not generated for the parameters of the scheme.
+ *
+ * @param t A pointer to an uninitialized cfe_dlog_table_FP12_BN254 struct;
+ * it needs to be freed with cfe_dlog_table_FP12_BN254_free
+ * @param path Path to the file with the table
+ * @param s A pointer to an instance of the scheme (*initialized* cfe_sgp
+ * struct)
+ * @return Error code
+ */
+cfe_error cfe_sgp_dlog_table_load(cfe_dlog_table_FP12_BN254 *t, const char *path, cfe_sgp *s);
+
+/**
+ * The same as cfe_sgp_decrypt, but it uses a precomputed table of baby steps
+ * (see cfe_sgp_dlog_table_init and cfe_sgp_dlog_table_load) for computing
+ * the discrete logarithm.
+ *
+ * @param res The result of the decryption (the value will be stored here)
+ * @param cipher A pointer to the ciphertext
+ * @param key A pointer to the functional encryption key
+ * @param f A pointer to the matrix of the quadratic polynomial
+ * @param t A pointer to an *initialized* table of baby steps
+ * @return Error code
+ */
+cfe_error cfe_sgp_decrypt_with_table(mpz_t res, cfe_sgp_cipher *cipher, ECP2_BN254 *key, cfe_mat *f,
+                                     cfe_dlog_table_FP12_BN254 *t);
+
 #endif
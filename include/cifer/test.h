@@ -20,10 +20,15 @@
 #include <munit.h>
 
 MunitSuite prime_suite;
+MunitSuite prime_cache_suite;
 MunitSuite keygen_suite;
 MunitSuite matrix_suite;
 MunitSuite vector_suite;
 MunitSuite dlog_suite;
+MunitSuite modctx_suite;
+MunitSuite pool_suite;
+MunitSuite powm_suite;
+MunitSuite prod_suite;
 MunitSuite big_suite;
 MunitSuite string_suite;
 MunitSuite uniform_suite;
@@ -37,6 +42,8 @@ MunitSuite ddh_suite;
 MunitSuite damgard_suite;
 MunitSuite ddh_multi_suite;
 MunitSuite damgard_multi_suite;
+MunitSuite ddh_ec_suite;
+MunitSuite damgard_ec_suite;
 MunitSuite lwe_suite;
 MunitSuite lwe_fully_secure_suite;
 MunitSuite ring_lwe_suite;
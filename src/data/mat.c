@@ -281,6 +281,74 @@ void cfe_mat_mul(cfe_mat *res, cfe_mat *m1, cfe_mat *m2) {
     mpz_clears(sum, prod, x, y, NULL);
 }
 
+// a range of rows of the product computed by a single thread
+typedef struct cfe_mat_mul_job {
+    cfe_mat *res;
+    cfe_mat *m1;
+    cfe_mat *m2;
+    mpz_ptr mod;
+    size_t from;
+    size_t to;
+} cfe_mat_mul_job;
+
+static void *cfe_mat_mul_worker(void *arg) {
+    cfe_mat_mul_job *job = (cfe_mat_mul_job *) arg;
+    cfe_mat *m1 = job->m1;
+    cfe_mat *m2 = job->m2;
+
+    // the row i of the result is the sum of the rows k of m2 multiplied by
+    // the elements m1[i][k], so both matrices are read along their rows
+    for (size_t i = job->from; i < job->to; i++) {
+        cfe_vec *row = &job->res->mat[i];
+        for (size_t from = 0; from < m2->cols; from += CFE_MAT_BLOCK) {
+            size_t to = from + CFE_MAT_BLOCK < m2->cols ? from + CFE_MAT_BLOCK : m2->cols;
+            for (size_t j = from; j < to; j++) {
+                mpz_set_ui(row->vec[j], 0);
+            }
+            for (size_t k = 0; k < m1->cols; k++) {
+                mpz_ptr x = m1->mat[i].vec[k];
+                if (mpz_sgn(x) == 0) {
+                    continue;
+                }
+                for (size_t j = from; j < to; j++) {
+                    mpz_addmul(row->vec[j], x, m2->mat[k].vec[j]);
+                }
+            }
+            for (size_t j = from; j < to; j++) {
+                mpz_mod(row->vec[j], row->vec[j], job->mod);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+void cfe_mat_mul_mod(cfe_mat *res, cfe_mat *m1, cfe_mat *m2, mpz_t mod, size_t num_threads) {
+    assert(m1->cols == m2->rows);
+    assert(m1->rows == res->rows);
+    assert(m2->cols == res->cols);
+
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+    if (num_threads > m1->rows) {
+        num_threads = m1->rows > 0 ? m1->rows : 1;
+    }
+
+    cfe_mat_mul_job *jobs = (cfe_mat_mul_job *) cfe_malloc(num_threads * sizeof(cfe_mat_mul_job));
+    for (size_t t = 0; t < num_threads; t++) {
+        jobs[t].res = res;
+        jobs[t].m1 = m1;
+        jobs[t].m2 = m2;
+        jobs[t].mod = mod;
+        jobs[t].from = t * m1->rows / num_threads;
+        jobs[t].to = (t + 1) * m1->rows / num_threads;
+    }
+    cfe_run_jobs(cfe_mat_mul_worker, jobs, sizeof(cfe_mat_mul_job), num_threads);
+
+    free(jobs);
+}
+
 void cfe_mat_extract_submatrix(cfe_mat *min, cfe_mat *m, size_t i, size_t j) {
     assert(i < m->rows && j < m->cols);
     assert(min->rows == m->rows - 1 && min->cols == m->cols - 1);
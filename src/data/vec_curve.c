@@ -74,6 +74,40 @@ void cfe_vec_mul_vec_G1(cfe_vec_G1 *res, cfe_vec *u, cfe_vec_G1 *v) {
     }
 }
 
+void cfe_vec_dot_G1(ECP_BN254 *res, cfe_vec *u, cfe_vec_G1 *v) {
+    assert(v->size == u->size);
+    mpz_t abs_x;
+    mpz_init(abs_x);
+
+    ECP_BN254 P, Q;
+    BIG_256_56 x, y;
+    ECP_BN254_inf(res);
+    for (size_t i = 0; i < u->size; i += 2) {
+        ECP_BN254_copy(&P, &(v->vec[i]));
+        if (mpz_sgn(u->vec[i]) < 0) {
+            ECP_BN254_neg(&P);
+        }
+        mpz_abs(abs_x, u->vec[i]);
+        BIG_256_56_from_mpz(x, abs_x);
+
+        if (i + 1 < u->size) {
+            ECP_BN254_copy(&Q, &(v->vec[i + 1]));
+            if (mpz_sgn(u->vec[i + 1]) < 0) {
+                ECP_BN254_neg(&Q);
+            }
+            mpz_abs(abs_x, u->vec[i + 1]);
+            BIG_256_56_from_mpz(y, abs_x);
+            ECP_BN254_mul2(&P, &Q, x, y);
+        } else {
+            ECP_BN254_mul(&P, x);
+        }
+
+        ECP_BN254_add(res, &P);
+    }
+
+    mpz_clear(abs_x);
+}
+
 void cfe_vec_G2_init(cfe_vec_G2 *v, size_t size) {
     v->size = size;
     v->vec = (ECP2_BN254 *) cfe_malloc(size * sizeof(ECP2_BN254));
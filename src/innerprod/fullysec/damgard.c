@@ -19,7 +19,9 @@
 
 #include "cifer/innerprod/fullysec/damgard.h"
 #include "cifer/internal/keygen.h"
+#include "cifer/internal/common.h"
 #include "cifer/internal/dlog.h"
+#include "cifer/internal/prod.h"
 #include "cifer/sample/uniform.h"
 
 
@@ -50,6 +52,9 @@ cfe_error cfe_damgard_init(cfe_damgard *s, size_t l, size_t modulus_len, mpz_t b
     mpz_init(s->h);
     cfe_uniform_sample_range_i_mpz(s->h, 1, s->p);
     mpz_powm(s->h, key.g, s->h, s->p);
+    cfe_fixed_base_init(&s->g_table, s->g, s->p, mpz_sizeinbase(s->p, 2));
+    cfe_fixed_base_init(&s->h_table, s->h, s->p, mpz_sizeinbase(s->p, 2));
+    cfe_small_powers_init_empty(&s->msg_table, s->p, s->bound);
 
     cleanup:
     cfe_elgamal_free(&key);
@@ -104,6 +109,9 @@ cfe_error cfe_damgard_precomp_init(cfe_damgard *s, size_t l, size_t modulus_len,
 
     s->l = l;
     mpz_set(s->bound, bound);
+    cfe_fixed_base_init(&s->g_table, s->g, s->p, mpz_sizeinbase(s->p, 2));
+    cfe_fixed_base_init(&s->h_table, s->h, s->p, mpz_sizeinbase(s->p, 2));
+    cfe_small_powers_init_empty(&s->msg_table, s->p, s->bound);
 
     cleanup:
     mpz_clear(check);
@@ -113,6 +121,9 @@ cfe_error cfe_damgard_precomp_init(cfe_damgard *s, size_t l, size_t modulus_len,
 
 void cfe_damgard_free(cfe_damgard *s) {
     mpz_clears(s->bound, s->g, s->p, s->h, s->q, NULL);
+    cfe_fixed_base_free(&s->g_table);
+    cfe_fixed_base_free(&s->h_table);
+    cfe_small_powers_free(&s->msg_table);
 }
 
 // res should be uninitialized!
@@ -123,6 +134,14 @@ void cfe_damgard_copy(cfe_damgard *res, cfe_damgard *s) {
     mpz_init_set(res->p, s->p);
     mpz_init_set(res->h, s->h);
     mpz_init_set(res->q, s->q);
+    cfe_fixed_base_copy(&res->g_table, &s->g_table);
+    cfe_fixed_base_copy(&res->h_table, &s->h_table);
+    cfe_small_powers_copy(&res->msg_table, &s->msg_table);
+}
+
+void cfe_damgard_msg_table_init(cfe_damgard *s) {
+    cfe_small_powers_free(&s->msg_table);
+    cfe_small_powers_init(&s->msg_table, s->g, s->p, s->bound);
 }
 
 void cfe_damgard_sec_key_init(cfe_damgard_sec_key *msk, cfe_damgard *s) {
@@ -149,8 +168,8 @@ void cfe_damgard_generate_master_keys(cfe_damgard_sec_key *msk, cfe_vec *mpk, cf
         cfe_uniform_sample_range_i_mpz(t_i, 2, p_min_1);
         cfe_vec_set(&msk->t, t_i, i);
 
-        mpz_powm(y1, s->g, s_i, s->p);
-        mpz_powm(y2, s->h, t_i, s->p);
+        cfe_fixed_base_powm(y1, &s->g_table, s_i);
+        cfe_fixed_base_powm(y2, &s->h_table, t_i);
 
         mpz_mul(r, y1, y2);
         mpz_mod(r, r, s->p);
@@ -187,11 +206,55 @@ cfe_error cfe_damgard_derive_fe_key(cfe_damgard_fe_key *fe_key, cfe_damgard *s,
     return CFE_ERR_NONE;
 }
 
+cfe_error cfe_damgard_derive_fe_keys(cfe_damgard_fe_key *res, cfe_damgard *s, cfe_damgard_sec_key *msk, cfe_mat *Y,
+                                     size_t num_threads) {
+    if (Y->cols != s->l || msk->s.size != s->l || msk->t.size != s->l) {
+        return CFE_ERR_MALFORMED_INPUT;
+    }
+    if (!cfe_mat_check_bound(Y, s->bound)) {
+        return CFE_ERR_BOUND_CHECK_FAILED;
+    }
+
+    mpz_t p_min_1;
+    mpz_init(p_min_1);
+    mpz_sub_ui(p_min_1, s->p, 1);
+
+    // both parts of all the keys are the product of Y with the matrix
+    // whose columns are the parts of the master secret key
+    cfe_mat msk_cols, keys;
+    cfe_mat_init(&msk_cols, s->l, 2);
+    cfe_mat_init(&keys, Y->rows, 2);
+    for (size_t i = 0; i < s->l; i++) {
+        mpz_set(msk_cols.mat[i].vec[0], msk->s.vec[i]);
+        mpz_set(msk_cols.mat[i].vec[1], msk->t.vec[i]);
+    }
+
+    cfe_mat_mul_mod(&keys, Y, &msk_cols, p_min_1, num_threads);
+    for (size_t k = 0; k < Y->rows; k++) {
+        mpz_set(res[k].key1, keys.mat[k].vec[0]);
+        mpz_set(res[k].key2, keys.mat[k].vec[1]);
+    }
+
+    mpz_clear(p_min_1);
+    cfe_mat_frees(&msk_cols, &keys, NULL);
+    return CFE_ERR_NONE;
+}
+
 void cfe_damgard_ciphertext_init(cfe_vec *ciphertext, cfe_damgard *s) {
     cfe_vec_init(ciphertext, s->l + 2);
 }
 
-cfe_error cfe_damgard_encrypt(cfe_vec *ciphertext, cfe_damgard *s, cfe_vec *x, cfe_vec *mpk) {
+// computes g^x_i for a coordinate of the input vector
+static void cfe_damgard_msg_powm(mpz_t res, cfe_damgard *s, mpz_t x_i) {
+    if (!cfe_small_powers_get(res, &s->msg_table, x_i)) {
+        cfe_fixed_base_powm(res, &s->g_table, x_i);
+    }
+}
+
+// encrypts x with the master public key, using the prepared key pk
+// instead if it is not NULL
+static cfe_error cfe_damgard_encrypt_with(cfe_vec *ciphertext, cfe_damgard *s, cfe_vec *x, cfe_vec *mpk,
+                                          cfe_fixed_base_vec *pk) {
     if (!cfe_vec_check_bound(x, s->bound)) {
         return CFE_ERR_BOUND_CHECK_FAILED;
     }
@@ -200,17 +263,21 @@ cfe_error cfe_damgard_encrypt(cfe_vec *ciphertext, cfe_damgard *s, cfe_vec *x, c
     mpz_inits(r, ct, t1, t2, NULL);
     cfe_uniform_sample_range_i_mpz(r, 1, s->p);
 
-    mpz_powm(ct, s->g, r, s->p);
+    cfe_fixed_base_powm(ct, &s->g_table, r);
     cfe_vec_set(ciphertext, ct, 0);
-    mpz_powm(ct, s->h, r, s->p);
+    cfe_fixed_base_powm(ct, &s->h_table, r);
     cfe_vec_set(ciphertext, ct, 1);
 
     for (size_t i = 0; i < s->l; i++) {
-        cfe_vec_get(t1, mpk, i);
-        mpz_powm(t1, t1, r, s->p);
+        if (pk != NULL) {
+            cfe_fixed_base_powm(t1, &pk->bases[i], r);
+        } else {
+            cfe_vec_get(t1, mpk, i);
+            mpz_powm(t1, t1, r, s->p);
+        }
 
         cfe_vec_get(t2, x, i);
-        mpz_powm(t2, s->g, t2, s->p);
+        cfe_damgard_msg_powm(t2, s, t2);
 
         mpz_mul(ct, t1, t2);
         mpz_mod(ct, ct, s->p);
@@ -221,44 +288,274 @@ cfe_error cfe_damgard_encrypt(cfe_vec *ciphertext, cfe_damgard *s, cfe_vec *x, c
     return CFE_ERR_NONE;
 }
 
+cfe_error cfe_damgard_encrypt(cfe_vec *ciphertext, cfe_damgard *s, cfe_vec *x, cfe_vec *mpk) {
+    return cfe_damgard_encrypt_with(ciphertext, s, x, mpk, NULL);
+}
 
-cfe_error cfe_damgard_decrypt(mpz_t res, cfe_damgard *s, cfe_vec *ciphertext, cfe_damgard_fe_key *key, cfe_vec *y) {
-    if (!cfe_vec_check_bound(y, s->bound)) {
+cfe_error cfe_damgard_prep_pub_key_init(cfe_fixed_base_vec *pk, cfe_damgard *s, cfe_vec *mpk, size_t memory_budget) {
+    if (mpk->size != s->l) {
+        return CFE_ERR_MALFORMED_PUB_KEY;
+    }
+
+    cfe_fixed_base_vec_init(pk, mpk, s->p, mpz_sizeinbase(s->p, 2), memory_budget);
+    return CFE_ERR_NONE;
+}
+
+cfe_error cfe_damgard_encrypt_prep(cfe_vec *ciphertext, cfe_damgard *s, cfe_vec *x, cfe_fixed_base_vec *pk) {
+    if (pk->size != s->l) {
+        return CFE_ERR_MALFORMED_PUB_KEY;
+    }
+
+    return cfe_damgard_encrypt_with(ciphertext, s, x, NULL, pk);
+}
+
+// the scheme and the prepared public key a pool of randomness uses
+typedef struct cfe_damgard_pool_data {
+    cfe_damgard s;
+    cfe_fixed_base_vec pk;
+} cfe_damgard_pool_data;
+
+// computes (g^r, h^r, mpk_1^r, ..., mpk_l^r) for a fresh random r
+static void cfe_damgard_pool_fill(cfe_vec *elem, void *data) {
+    cfe_damgard_pool_data *d = (cfe_damgard_pool_data *) data;
+    mpz_t r;
+    mpz_init(r);
+    cfe_uniform_sample_range_i_mpz(r, 1, d->s.p);
+
+    cfe_fixed_base_powm(elem->vec[0], &d->s.g_table, r);
+    cfe_fixed_base_powm(elem->vec[1], &d->s.h_table, r);
+    for (size_t i = 0; i < d->s.l; i++) {
+        cfe_fixed_base_powm(elem->vec[i + 2], &d->pk.bases[i], r);
+    }
+
+    mpz_clear(r);
+}
+
+static void cfe_damgard_pool_data_free(void *data) {
+    cfe_damgard_pool_data *d = (cfe_damgard_pool_data *) data;
+    cfe_fixed_base_vec_free(&d->pk);
+    cfe_damgard_free(&d->s);
+    free(d);
+}
+
+cfe_error cfe_damgard_pool_init(cfe_pool *pool, cfe_damgard *s, cfe_vec *mpk, size_t capacity, bool background) {
+    if (mpk->size != s->l) {
+        return CFE_ERR_MALFORMED_PUB_KEY;
+    }
+
+    cfe_damgard_pool_data *d = (cfe_damgard_pool_data *) cfe_malloc(sizeof(cfe_damgard_pool_data));
+    cfe_damgard_copy(&d->s, s);
+    cfe_fixed_base_vec_init(&d->pk, mpk, s->p, mpz_sizeinbase(s->p, 2), 0);
+    cfe_pool_init(pool, capacity, s->l + 2, cfe_damgard_pool_fill, cfe_damgard_pool_data_free, d, background);
+
+    return CFE_ERR_NONE;
+}
+
+cfe_error cfe_damgard_encrypt_pooled(cfe_vec *ciphertext, cfe_damgard *s, cfe_vec *x, cfe_pool *pool) {
+    if (!cfe_vec_check_bound(x, s->bound)) {
         return CFE_ERR_BOUND_CHECK_FAILED;
     }
+    if (x->size != s->l || ciphertext->size != s->l + 2 || pool->elem_size != s->l + 2) {
+        return CFE_ERR_MALFORMED_INPUT;
+    }
 
-    mpz_t num, ct, t1, t2, denom, denom_inv, r, bound;
-    mpz_inits(num, ct, t1, t2, denom, denom_inv, r, bound, NULL);
+    // the ciphertext starts as (g^r, h^r, mpk_1^r, ..., mpk_l^r)
+    cfe_pool_take(ciphertext, pool);
 
-    mpz_set_ui(num, 1);
+    mpz_t t;
+    mpz_init(t);
+    for (size_t i = 0; i < s->l; i++) {
+        cfe_damgard_msg_powm(t, s, x->vec[i]);
+        mpz_mul(ciphertext->vec[i + 2], ciphertext->vec[i + 2], t);
+        mpz_mod(ciphertext->vec[i + 2], ciphertext->vec[i + 2], s->p);
+    }
+    mpz_clear(t);
 
-    for (size_t i = 2; i < ciphertext->size; i++) {
-        cfe_vec_get(ct, ciphertext, i);
-        cfe_vec_get(r, y, i - 2);
+    return CFE_ERR_NONE;
+}
 
-        mpz_powm(t1, ct, r, s->p);
 
-        mpz_mul(num, num, t1);
-        mpz_mod(num, num, s->p);
+// computes g^<x,y> from the ciphertext, the functional encryption key and y
+// as a single multi-exponentiation ct_0^(-key1) * ct_1^(-key2) * prod ct_i^(y_i)
+static cfe_error cfe_damgard_decrypt_elem(mpz_t res, cfe_damgard *s, cfe_vec *ciphertext, cfe_damgard_fe_key *key,
+                                          cfe_vec *y) {
+    if (ciphertext->size != s->l + 2 || y->size != s->l) {
+        return CFE_ERR_MALFORMED_INPUT;
     }
 
-    cfe_vec_get(t1, ciphertext, 0);
-    mpz_powm(t1, t1, key->key1, s->p);
+    cfe_vec exps;
+    cfe_vec_init(&exps, ciphertext->size);
+    mpz_neg(exps.vec[0], key->key1);
+    mpz_neg(exps.vec[1], key->key2);
+    for (size_t i = 0; i < s->l; i++) {
+        mpz_set(exps.vec[i + 2], y->vec[i]);
+    }
 
-    cfe_vec_get(t2, ciphertext, 1);
-    mpz_powm(t2, t2, key->key2, s->p);
+    cfe_error err = cfe_multi_powm(res, ciphertext, &exps, s->p);
+    cfe_vec_free(&exps);
 
-    mpz_mul(denom, t1, t2);
-    mpz_mod(denom, denom, s->p);
-    mpz_invert(denom_inv, denom, s->p);
-    mpz_mul(r, denom_inv, num);
-    mpz_mod(r, r, s->p);
+    return err ? CFE_ERR_MALFORMED_CIPHER : CFE_ERR_NONE;
+}
+
+cfe_error cfe_damgard_decrypt(mpz_t res, cfe_damgard *s, cfe_vec *ciphertext, cfe_damgard_fe_key *key, cfe_vec *y) {
+    return cfe_damgard_decrypt_with_config(res, s, ciphertext, key, y, NULL);
+}
 
+// sets bound to the bound n * l * bound² on the inner products of a sum
+// of n vectors, which must be below the order of the group for the
+// discrete logarithm to be unique
+static cfe_error cfe_damgard_sum_bound(mpz_t bound, cfe_damgard *s, size_t n) {
     mpz_pow_ui(bound, s->bound, 2);
     mpz_mul_ui(bound, bound, s->l);
+    mpz_mul_ui(bound, bound, n);
 
-    cfe_error err = cfe_baby_giant_with_neg(res, r, s->g, s->p, s->q, bound);
+    return mpz_cmp(bound, s->q) > 0 ? CFE_ERR_PRECONDITION_FAILED : CFE_ERR_NONE;
+}
+
+// decrypts a ciphertext of the sum of n vectors
+static cfe_error cfe_damgard_decrypt_sum(mpz_t res, cfe_damgard *s, cfe_vec *ciphertext, cfe_damgard_fe_key *key,
+                                         cfe_vec *y, size_t n, cfe_dlog_config *c) {
+    if (!cfe_vec_check_bound(y, s->bound)) {
+        return CFE_ERR_BOUND_CHECK_FAILED;
+    }
+
+    mpz_t r, bound;
+    mpz_inits(r, bound, NULL);
+
+    cfe_error err = cfe_damgard_sum_bound(bound, s, n);
+    if (err) {
+        goto cleanup;
+    }
+
+    err = cfe_damgard_decrypt_elem(r, s, ciphertext, key, y);
+    if (err) {
+        goto cleanup;
+    }
+
+    err = cfe_dlog_with_neg(res, r, s->g, s->p, s->q, bound, c);
+
+    cleanup:
+    mpz_clears(r, bound, NULL);
+    return err;
+}
+
+cfe_error cfe_damgard_decrypt_with_config(mpz_t res, cfe_damgard *s, cfe_vec *ciphertext, cfe_damgard_fe_key *key,
+                                          cfe_vec *y, cfe_dlog_config *c) {
+    return cfe_damgard_decrypt_sum(res, s, ciphertext, key, y, 1, c);
+}
+
+cfe_error cfe_damgard_dlog_table_init(cfe_dlog_table *t, cfe_damgard *s) {
+    return cfe_damgard_aggregate_dlog_table_init(t, s, 1);
+}
+
+cfe_error cfe_damgard_decrypt_with_table(mpz_t res, cfe_damgard *s, cfe_vec *ciphertext, cfe_damgard_fe_key *key,
+                                         cfe_vec *y, cfe_dlog_table *t) {
+    if (!cfe_vec_check_bound(y, s->bound)) {
+        return CFE_ERR_BOUND_CHECK_FAILED;
+    }
+
+    mpz_t r;
+    mpz_init(r);
+
+    cfe_error err = cfe_damgard_decrypt_elem(r, s, ciphertext, key, y);
+    if (!err) {
+        err = cfe_dlog_table_solve_with_neg(res, r, t);
+    }
+
+    mpz_clear(r);
+    return err;
+}
+
+cfe_error cfe_damgard_ciphertext_aggregate(cfe_vec *res, cfe_damgard *s, cfe_vec *ciphertexts, size_t n) {
+    return cfe_damgard_ciphertext_aggregate_parallel(res, s, ciphertexts, n, 1);
+}
+
+cfe_error cfe_damgard_ciphertext_aggregate_parallel(cfe_vec *res, cfe_damgard *s, cfe_vec *ciphertexts, size_t n,
+                                                    size_t num_threads) {
+    if (n == 0) {
+        return CFE_ERR_MALFORMED_INPUT;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (ciphertexts[i].size != s->l + 2) {
+            return CFE_ERR_MALFORMED_CIPHER;
+        }
+    }
+
+    mpz_t bound;
+    mpz_init(bound);
+
+    cfe_error err = cfe_damgard_sum_bound(bound, s, n);
+    if (!err) {
+        err = cfe_vec_prod_mod(res, ciphertexts, n, s->p, num_threads);
+    }
+
+    mpz_clear(bound);
+    return err;
+}
+
+cfe_error cfe_damgard_decrypt_aggregate(mpz_t res, cfe_damgard *s, cfe_vec *ciphertext, cfe_damgard_fe_key *key,
+                                        cfe_vec *y, size_t n) {
+    return cfe_damgard_decrypt_sum(res, s, ciphertext, key, y, n, NULL);
+}
+
+cfe_error cfe_damgard_aggregate_dlog_table_init(cfe_dlog_table *t, cfe_damgard *s, size_t n) {
+    mpz_t bound;
+    mpz_init(bound);
+
+    cfe_error err = cfe_damgard_sum_bound(bound, s, n);
+    if (!err) {
+        err = cfe_dlog_table_init(t, s->g, s->p, s->q, bound);
+    }
+
+    mpz_clear(bound);
+    return err;
+}
+
+cfe_error cfe_damgard_decrypt_batch(mpz_t *res, cfe_error *errs, cfe_damgard *s, cfe_vec *ciphertext,
+                                    cfe_damgard_fe_key *keys, cfe_vec *ys, size_t n, cfe_dlog_table *t,
+                                    size_t num_threads) {
+    if (n == 0) {
+        return CFE_ERR_NONE;
+    }
+    if (ciphertext->size != s->l + 2) {
+        return CFE_ERR_MALFORMED_INPUT;
+    }
+
+    cfe_error *errs_all = errs != NULL ? errs : (cfe_error *) cfe_malloc(n * sizeof(cfe_error));
+    cfe_vec *exps = (cfe_vec *) cfe_malloc(n * sizeof(cfe_vec));
+
+    // the exponents of the elements of the ciphertext for each key; the
+    // exponents of invalid pairs are left 0
+    for (size_t k = 0; k < n; k++) {
+        cfe_vec_init(&exps[k], ciphertext->size);
+        errs_all[k] = CFE_ERR_NONE;
+        if (ys[k].size != s->l) {
+            errs_all[k] = CFE_ERR_MALFORMED_INPUT;
+        } else if (!cfe_vec_check_bound(&ys[k], s->bound)) {
+            errs_all[k] = CFE_ERR_BOUND_CHECK_FAILED;
+        } else {
+            mpz_neg(exps[k].vec[0], keys[k].key1);
+            mpz_neg(exps[k].vec[1], keys[k].key2);
+            for (size_t i = 0; i < s->l; i++) {
+                mpz_set(exps[k].vec[i + 2], ys[k].vec[i]);
+            }
+        }
+    }
+
+    mpz_t bound;
+    mpz_init(bound);
+    cfe_damgard_sum_bound(bound, s, 1);
+    cfe_error err = cfe_dlog_powm_batch_with_neg(res, errs_all, ciphertext, exps, n, s->g, s->p, s->q, bound, t,
+                                                 num_threads);
+    mpz_clear(bound);
+
+    for (size_t k = 0; k < n; k++) {
+        cfe_vec_free(&exps[k]);
+    }
+    free(exps);
+    if (errs == NULL) {
+        free(errs_all);
+    }
 
-    mpz_clears(num, ct, t1, t2, denom, denom_inv, r, bound, NULL);
     return err;
 }
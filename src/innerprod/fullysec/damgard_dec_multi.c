@@ -174,6 +174,12 @@ void cfe_damgard_dec_multi_dec_free(cfe_damgard_dec_multi_dec *d) {
 cfe_error cfe_damgard_dec_multi_decrypt(mpz_t res, cfe_vec *ciphers,
                                         cfe_damgard_dec_multi_fe_key_part *fe_key_parts,
                                         cfe_mat *y, cfe_damgard_dec_multi_dec *d) {
+    return cfe_damgard_dec_multi_decrypt_with_config(res, ciphers, fe_key_parts, y, d, NULL);
+}
+
+cfe_error cfe_damgard_dec_multi_decrypt_with_config(mpz_t res, cfe_vec *ciphers,
+                                                    cfe_damgard_dec_multi_fe_key_part *fe_key_parts,
+                                                    cfe_mat *y, cfe_damgard_dec_multi_dec *d, cfe_dlog_config *c) {
     if (!cfe_mat_check_bound(y, d->scheme.bound)) {
         return CFE_ERR_BOUND_CHECK_FAILED;
     }
@@ -192,7 +198,7 @@ cfe_error cfe_damgard_dec_multi_decrypt(mpz_t res, cfe_vec *ciphers,
     }
     mpz_mod(key.z, key.z, d->scheme.scheme.q);
 
-    cfe_error err = cfe_damgard_multi_decrypt(res, &(d->scheme), ciphers, &key, y);
+    cfe_error err = cfe_damgard_multi_decrypt_with_config(res, &(d->scheme), ciphers, &key, y, c);
 
     mpz_clear(key.z);
     free(key.keys);
@@ -145,7 +145,10 @@ void cfe_damgard_multi_ciphertext_init(cfe_vec *ciphertext, cfe_damgard_multi_cl
     cfe_damgard_ciphertext_init(ciphertext, &e->scheme);
 }
 
-cfe_error cfe_damgard_multi_encrypt(cfe_vec *ciphertext, cfe_damgard_multi_client *e, cfe_vec *x, cfe_vec *pub_key, cfe_vec *otp) {
+// encrypts x with the public key, using the prepared key pk instead if it
+// is not NULL
+static cfe_error cfe_damgard_multi_encrypt_with(cfe_vec *ciphertext, cfe_damgard_multi_client *e, cfe_vec *x,
+                                                cfe_vec *pub_key, cfe_fixed_base_vec *pk, cfe_vec *otp) {
     if (!cfe_vec_check_bound(x, e->bound)) {
         return CFE_ERR_BOUND_CHECK_FAILED;
     }
@@ -156,56 +159,125 @@ cfe_error cfe_damgard_multi_encrypt(cfe_vec *ciphertext, cfe_damgard_multi_clien
     cfe_vec_add(&otp_add_x, x, otp);
     cfe_vec_mod(&otp_add_x, &otp_add_x, e->scheme.q);
 
-    cfe_error err = cfe_damgard_encrypt(ciphertext, &e->scheme, &otp_add_x, pub_key);
+    cfe_error err;
+    if (pk != NULL) {
+        err = cfe_damgard_encrypt_prep(ciphertext, &e->scheme, &otp_add_x, pk);
+    } else {
+        err = cfe_damgard_encrypt(ciphertext, &e->scheme, &otp_add_x, pub_key);
+    }
 
     cfe_vec_free(&otp_add_x);
     return err;
 }
 
-cfe_error cfe_damgard_multi_decrypt(mpz_t res, cfe_damgard_multi *m, cfe_vec *ciphertext, cfe_damgard_multi_fe_key *fe_key,
-                                    cfe_mat *y) {
-    if (!cfe_mat_check_bound(y, m->bound)) {
-        return CFE_ERR_BOUND_CHECK_FAILED;
-    }
+cfe_error cfe_damgard_multi_encrypt(cfe_vec *ciphertext, cfe_damgard_multi_client *e, cfe_vec *x, cfe_vec *pub_key, cfe_vec *otp) {
+    return cfe_damgard_multi_encrypt_with(ciphertext, e, x, pub_key, NULL, otp);
+}
 
-    mpz_t order, bound, z_exp, z_exp_inv, r, num, denom, denom_inv, t1, t2;
-    mpz_inits(order, bound, z_exp, z_exp_inv, r, num, denom, denom_inv, t1, t2, NULL);
-    mpz_set_ui(r, 1);
+cfe_error cfe_damgard_multi_prep_pub_key_init(cfe_fixed_base_vec *pk, cfe_damgard_multi_client *e, cfe_vec *pub_key,
+                                              size_t memory_budget) {
+    return cfe_damgard_prep_pub_key_init(pk, &e->scheme, pub_key, memory_budget);
+}
+
+cfe_error cfe_damgard_multi_encrypt_prep(cfe_vec *ciphertext, cfe_damgard_multi_client *e, cfe_vec *x,
+                                         cfe_fixed_base_vec *pk, cfe_vec *otp) {
+    return cfe_damgard_multi_encrypt_with(ciphertext, e, x, NULL, pk, otp);
+}
 
+// computes g^(sum of inner products) from the ciphertexts, the functional
+// encryption key and y, as a single multi-exponentiation over all the
+// ciphertexts and g^(-z)
+static cfe_error cfe_damgard_multi_decrypt_elem(mpz_t r, cfe_damgard_multi *m, cfe_vec *ciphertext,
+                                                cfe_damgard_multi_fe_key *fe_key, cfe_mat *y) {
+    size_t l = m->scheme.l;
     for (size_t i = 0; i < m->num_clients; i++) {
-        mpz_set_ui(num, 1);
+        if (ciphertext[i].size != l + 2) {
+            return CFE_ERR_MALFORMED_CIPHER;
+        }
+    }
+
+    cfe_vec bases, exps;
+    cfe_vec_inits(m->num_clients * (l + 2) + 1, &bases, &exps, NULL);
 
-        for (size_t j = 0; j < m->scheme.l; j++) {
-            mpz_powm(t1, ciphertext[i].vec[j+2], y->mat[i].vec[j], m->scheme.p);
-            mpz_mul(num, num, t1);
-            mpz_mod(num, num, m->scheme.p);
+    for (size_t i = 0; i < m->num_clients; i++) {
+        size_t off = i * (l + 2);
+        for (size_t j = 0; j < l + 2; j++) {
+            mpz_set(bases.vec[off + j], ciphertext[i].vec[j]);
+        }
+        mpz_neg(exps.vec[off], fe_key->keys[i].key1);
+        mpz_neg(exps.vec[off + 1], fe_key->keys[i].key2);
+        for (size_t j = 0; j < l; j++) {
+            mpz_set(exps.vec[off + j + 2], y->mat[i].vec[j]);
         }
+    }
+    mpz_set(bases.vec[bases.size - 1], m->scheme.g);
+    mpz_neg(exps.vec[exps.size - 1], fe_key->z);
+
+    cfe_error err = cfe_multi_powm(r, &bases, &exps, m->scheme.p);
+    cfe_vec_frees(&bases, &exps, NULL);
+
+    return err ? CFE_ERR_MALFORMED_CIPHER : CFE_ERR_NONE;
+}
+
+cfe_error cfe_damgard_multi_decrypt(mpz_t res, cfe_damgard_multi *m, cfe_vec *ciphertext, cfe_damgard_multi_fe_key *fe_key,
+                                    cfe_mat *y) {
+    return cfe_damgard_multi_decrypt_with_config(res, m, ciphertext, fe_key, y, NULL);
+}
 
-        mpz_powm(t1, ciphertext[i].vec[0], fe_key->keys[i].key1, m->scheme.p);
-        mpz_powm(t2, ciphertext[i].vec[1], fe_key->keys[i].key2, m->scheme.p);
-        mpz_mul(denom, t1, t2);
-        mpz_mod(denom, denom, m->scheme.p);
+cfe_error cfe_damgard_multi_decrypt_with_config(mpz_t res, cfe_damgard_multi *m, cfe_vec *ciphertext,
+                                                cfe_damgard_multi_fe_key *fe_key, cfe_mat *y, cfe_dlog_config *c) {
+    if (!cfe_mat_check_bound(y, m->bound)) {
+        return CFE_ERR_BOUND_CHECK_FAILED;
+    }
 
-        mpz_invert(denom_inv, denom, m->scheme.p);
+    mpz_t order, bound, r;
+    mpz_inits(order, bound, r, NULL);
 
-        mpz_mul(r, r, num);
-        mpz_mul(r, r, denom_inv);
-        mpz_mod(r, r, m->scheme.p);
+    cfe_error err = cfe_damgard_multi_decrypt_elem(r, m, ciphertext, fe_key, y);
+    if (err) {
+        goto cleanup;
     }
 
-    mpz_powm(z_exp, m->scheme.g, fe_key->z, m->scheme.p);
-    mpz_invert(z_exp_inv, z_exp, m->scheme.p);
+    mpz_sub_ui(order, m->scheme.p, 1);
+    mpz_pow_ui(bound, m->bound, 2);
+    mpz_mul_ui(bound, bound, m->num_clients*m->scheme.l);
 
-    mpz_mul(r, r, z_exp_inv);
-    mpz_mod(r, r, m->scheme.p);
+    err = cfe_dlog_with_neg(res, r, m->scheme.g, m->scheme.p, order, bound, c);
 
+    cleanup:
+    mpz_clears(order, bound, r, NULL);
+
+    return err;
+}
+
+cfe_error cfe_damgard_multi_dlog_table_init(cfe_dlog_table *t, cfe_damgard_multi *m) {
+    mpz_t order, bound;
+    mpz_inits(order, bound, NULL);
 
     mpz_sub_ui(order, m->scheme.p, 1);
     mpz_pow_ui(bound, m->bound, 2);
     mpz_mul_ui(bound, bound, m->num_clients*m->scheme.l);
 
-    cfe_error err = cfe_baby_giant_with_neg(res, r, m->scheme.g, m->scheme.p, order, bound);
-    mpz_clears(order, bound, z_exp, z_exp_inv, r, num, denom, denom_inv, t1, t2, NULL);
+    cfe_error err = cfe_dlog_table_init(t, m->scheme.g, m->scheme.p, order, bound);
+    mpz_clears(order, bound, NULL);
+
+    return err;
+}
+
+cfe_error cfe_damgard_multi_decrypt_with_table(mpz_t res, cfe_damgard_multi *m, cfe_vec *ciphertext,
+                                               cfe_damgard_multi_fe_key *fe_key, cfe_mat *y, cfe_dlog_table *t) {
+    if (!cfe_mat_check_bound(y, m->bound)) {
+        return CFE_ERR_BOUND_CHECK_FAILED;
+    }
+
+    mpz_t r;
+    mpz_init(r);
+
+    cfe_error err = cfe_damgard_multi_decrypt_elem(r, m, ciphertext, fe_key, y);
+    if (!err) {
+        err = cfe_dlog_table_solve_with_neg(res, r, t);
+    }
+    mpz_clear(r);
 
     return err;
 }
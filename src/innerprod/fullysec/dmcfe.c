@@ -146,8 +146,10 @@ void cfe_dmcfe_derive_fe_key_part(cfe_vec_G2 *fe_key_part, cfe_dmcfe_client *c,
     mpz_clear(tmp);
 }
 
-cfe_error cfe_dmcfe_decrypt(mpz_t res, ECP_BN254 *ciphers, cfe_vec_G2 *key_shares,
-                            char *label, size_t label_len, cfe_vec *y, mpz_t bound) {
+// computes s = e(g1, g2)^<x,y>, whose discrete logarithm is the result of
+// the decryption
+static void cfe_dmcfe_decrypt_elem(FP12_BN254 *s, ECP_BN254 *ciphers, cfe_vec_G2 *key_shares,
+                                   char *label, size_t label_len, cfe_vec *y) {
     cfe_vec_G2 keys_sum;
     cfe_vec_G2_init(&keys_sum, 2);
     for (size_t i = 0; i < 2; i++) {
@@ -158,10 +160,9 @@ cfe_error cfe_dmcfe_decrypt(mpz_t res, ECP_BN254 *ciphers, cfe_vec_G2 *key_share
             ECP2_BN254_add(&(keys_sum.vec[i]), &(key_shares[k].vec[i]));
         }
     }
-    ECP_BN254 ciphers_sum, cipher_i, gen1, h;
+    ECP_BN254 ciphers_sum, cipher_i, h;
     ECP2_BN254 gen2;
-    FP12_BN254 s, t, pair;
-    ECP_BN254_generator(&gen1);
+    FP12_BN254 t, pair;
     ECP2_BN254_generator(&gen2);
     ECP_BN254_inf(&ciphers_sum);
     BIG_256_56 y_i;
@@ -177,8 +178,8 @@ cfe_error cfe_dmcfe_decrypt(mpz_t res, ECP_BN254 *ciphers, cfe_vec_G2 *key_share
         ECP_BN254_add(&ciphers_sum, &cipher_i);
     }
 
-    PAIR_BN254_ate(&s, &gen2, &ciphers_sum);
-    PAIR_BN254_fexp(&s);
+    PAIR_BN254_ate(s, &gen2, &ciphers_sum);
+    PAIR_BN254_fexp(s);
 
     cfe_string label_for_hash, str_i;
     cfe_string label_str = {label, label_len};
@@ -195,21 +196,76 @@ cfe_error cfe_dmcfe_decrypt(mpz_t res, ECP_BN254 *ciphers, cfe_vec_G2 *key_share
         cfe_string_free(&str_i);
     }
     FP12_BN254_inv(&t, &t);
-    FP12_BN254_mul(&s, &t);
+    FP12_BN254_mul(s, &t);
+
+    mpz_clears(y_i_mod, order, NULL);
+    cfe_vec_G2_free(&keys_sum);
+}
+
+// sets gt = e(g1, g2) and res_bound to the bound on the result
+static void cfe_dmcfe_dlog_params(FP12_BN254 *gt, mpz_t res_bound, size_t num_clients, mpz_t bound) {
+    ECP_BN254 gen1;
+    ECP2_BN254 gen2;
+    ECP_BN254_generator(&gen1);
+    ECP2_BN254_generator(&gen2);
+    PAIR_BN254_ate(gt, &gen2, &gen1);
+    PAIR_BN254_fexp(gt);
 
-    PAIR_BN254_ate(&pair, &gen2, &gen1);
-    PAIR_BN254_fexp(&pair);
+    mpz_pow_ui(res_bound, bound, 2);
+    mpz_mul_ui(res_bound, res_bound, num_clients);
+}
+
+cfe_error cfe_dmcfe_decrypt(mpz_t res, ECP_BN254 *ciphers, cfe_vec_G2 *key_shares,
+                            char *label, size_t label_len, cfe_vec *y, mpz_t bound) {
+    return cfe_dmcfe_decrypt_with_config(res, ciphers, key_shares, label, label_len, y, bound, NULL);
+}
+
+cfe_error cfe_dmcfe_decrypt_with_config(mpz_t res, ECP_BN254 *ciphers, cfe_vec_G2 *key_shares, char *label,
+                                        size_t label_len, cfe_vec *y, mpz_t bound, cfe_dlog_config *c) {
+    FP12_BN254 s, pair;
+    cfe_dmcfe_decrypt_elem(&s, ciphers, key_shares, label, label_len, y);
 
     mpz_t res_bound;
     mpz_init(res_bound);
-    mpz_pow_ui(res_bound, bound, 2);
-    mpz_mul_ui(res_bound, res_bound, y->size);
+    cfe_dmcfe_dlog_params(&pair, res_bound, y->size, bound);
 
     cfe_error err;
-    err = cfe_baby_giant_FP12_BN256_with_neg(res, &s, &pair, res_bound);
+    err = cfe_dlog_FP12_BN254_with_neg(res, &s, &pair, res_bound, c);
 
-    mpz_clears(res_bound, y_i_mod, order, NULL);
-    cfe_vec_G2_free(&keys_sum);
+    mpz_clear(res_bound);
+
+    return err;
+}
+
+cfe_error cfe_dmcfe_dlog_table_init(cfe_dlog_table_FP12_BN254 *t, size_t num_clients, mpz_t bound) {
+    FP12_BN254 gt;
+    mpz_t res_bound;
+    mpz_init(res_bound);
+    cfe_dmcfe_dlog_params(&gt, res_bound, num_clients, bound);
+
+    cfe_error err = cfe_dlog_table_FP12_BN254_init(t, &gt, res_bound);
+    mpz_clear(res_bound);
+
+    return err;
+}
+
+cfe_error cfe_dmcfe_dlog_table_load(cfe_dlog_table_FP12_BN254 *t, const char *path, size_t num_clients,
+                                    mpz_t bound) {
+    FP12_BN254 gt;
+    mpz_t res_bound;
+    mpz_init(res_bound);
+    cfe_dmcfe_dlog_params(&gt, res_bound, num_clients, bound);
+
+    cfe_error err = cfe_dlog_table_FP12_BN254_load(t, path, &gt, res_bound);
+    mpz_clear(res_bound);
 
     return err;
 }
+
+cfe_error cfe_dmcfe_decrypt_with_table(mpz_t res, ECP_BN254 *ciphers, cfe_vec_G2 *key_shares,
+                                       char *label, size_t label_len, cfe_vec *y, cfe_dlog_table_FP12_BN254 *t) {
+    FP12_BN254 s;
+    cfe_dmcfe_decrypt_elem(&s, ciphers, key_shares, label, label_len, y);
+
+    return cfe_dlog_table_FP12_BN254_solve_with_neg(res, &s, t);
+}
@@ -263,6 +263,11 @@ cfe_error cfe_fh_multi_ipe_encrypt(cfe_vec_G1 *cipher, cfe_vec *x,
 
 cfe_error cfe_fh_multi_ipe_decrypt(mpz_t res, cfe_vec_G1 *ciphers, cfe_mat_G2 *fe_key,
                                    FP12_BN254 *pub_key, cfe_fh_multi_ipe *c) {
+    return cfe_fh_multi_ipe_decrypt_with_config(res, ciphers, fe_key, pub_key, c, NULL);
+}
+
+cfe_error cfe_fh_multi_ipe_decrypt_with_config(mpz_t res, cfe_vec_G1 *ciphers, cfe_mat_G2 *fe_key, FP12_BN254 *pub_key,
+                                               cfe_fh_multi_ipe *c, cfe_dlog_config *conf) {
     FP12_BN254 sum, paired;
     FP12_BN254_one(&sum);
 
@@ -279,7 +284,7 @@ cfe_error cfe_fh_multi_ipe_decrypt(mpz_t res, cfe_vec_G1 *ciphers, cfe_mat_G2 *f
     mpz_mul(res_bound, c->bound_x, c->bound_y);
     mpz_mul_ui(res_bound, res_bound, c->num_clients * c->vec_len);
 
-    cfe_error err = cfe_baby_giant_FP12_BN256_with_neg(res, &sum, pub_key, res_bound);
+    cfe_error err = cfe_dlog_FP12_BN254_with_neg(res, &sum, pub_key, res_bound, conf);
 
     mpz_clear(res_bound);
 
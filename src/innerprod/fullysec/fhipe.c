@@ -197,6 +197,11 @@ cfe_error cfe_fhipe_encrypt(cfe_fhipe_ciphertext *cipher, cfe_vec *x, cfe_fhipe_
 }
 
 cfe_error cfe_fhipe_decrypt(mpz_t res, cfe_fhipe_ciphertext *cipher, cfe_fhipe_fe_key *fe_key, cfe_fhipe *c) {
+    return cfe_fhipe_decrypt_with_config(res, cipher, fe_key, c, NULL);
+}
+
+cfe_error cfe_fhipe_decrypt_with_config(mpz_t res, cfe_fhipe_ciphertext *cipher, cfe_fhipe_fe_key *fe_key, cfe_fhipe *c,
+                                        cfe_dlog_config *conf) {
     FP12_BN254 d1, d2, paired_i;
     PAIR_BN254_ate(&d1, &cipher->c1, &fe_key->k1);
     PAIR_BN254_fexp(&d1);
@@ -213,7 +218,7 @@ cfe_error cfe_fhipe_decrypt(mpz_t res, cfe_fhipe_ciphertext *cipher, cfe_fhipe_f
     mpz_mul(res_bound, c->bound_x, c->bound_y);
     mpz_mul_ui(res_bound, res_bound, c->l);
 
-    cfe_error err = cfe_baby_giant_FP12_BN256_with_neg(res, &d2, &d1, res_bound);
+    cfe_error err = cfe_dlog_FP12_BN254_with_neg(res, &d2, &d1, res_bound, conf);
 
     mpz_clear(res_bound);
 
@@ -18,12 +18,16 @@
 #include <gmp.h>
 
 #include "cifer/innerprod/fullysec/paillier.h"
+#include "cifer/internal/common.h"
+#include "cifer/internal/powm.h"
 #include "cifer/internal/prime.h"
 #include "cifer/sample/uniform.h"
 #include "cifer/sample/normal_double_constant.h"
 #include "cifer/sample/normal_cdt.h"
 
-cfe_error cfe_paillier_init(cfe_paillier *s, size_t l, size_t lambda, size_t bit_len, mpz_t bound_x, mpz_t bound_y) {
+// initializes the scheme, keeping the secret primes in sp if it is not NULL
+static cfe_error cfe_paillier_init_with(cfe_paillier *s, cfe_paillier_sec_params *sp, size_t l, size_t lambda,
+                                        size_t bit_len, mpz_t bound_x, mpz_t bound_y) {
     mpz_t p, q, n, n_square, check, g_prime, g, n_to_5, k_sigma;
     mpz_inits(p, q, n, n_square, check, g_prime, g, n_to_5, k_sigma, NULL);
 
@@ -99,12 +103,25 @@ cfe_error cfe_paillier_init(cfe_paillier *s, size_t l, size_t lambda, size_t bit
     s->lambda = lambda;
     mpz_init_set(s->g, g);
 
+    if (sp != NULL) {
+        cfe_paillier_sec_params_init(sp, p, q);
+    }
+
     cleanup:
     mpz_clears(p, q, n, n_square, check, g_prime, g, n_to_5, k_sigma, NULL);
     mpf_clears(sigma, sigma_cdt, k_sigma_f, NULL);
     return err;
 }
 
+cfe_error cfe_paillier_init(cfe_paillier *s, size_t l, size_t lambda, size_t bit_len, mpz_t bound_x, mpz_t bound_y) {
+    return cfe_paillier_init_with(s, NULL, l, lambda, bit_len, bound_x, bound_y);
+}
+
+cfe_error cfe_paillier_init_sec(cfe_paillier *s, cfe_paillier_sec_params *sp, size_t l, size_t lambda,
+                                size_t bit_len, mpz_t bound_x, mpz_t bound_y) {
+    return cfe_paillier_init_with(s, sp, l, lambda, bit_len, bound_x, bound_y);
+}
+
 void cfe_paillier_free(cfe_paillier *s) {
     mpz_clears(s->n, s->n_square, s->bound_x, s->bound_y, s->g, s->k_sigma, NULL);
     mpf_clear(s->sigma);
@@ -154,6 +171,81 @@ cfe_error cfe_paillier_generate_master_keys(cfe_vec *msk, cfe_vec *mpk, cfe_pail
     return CFE_ERR_NONE;
 }
 
+void cfe_paillier_sec_params_init(cfe_paillier_sec_params *sp, mpz_t p, mpz_t q) {
+    mpz_inits(sp->p_square, sp->q_square, sp->p_order, sp->q_order, sp->q_square_inv, NULL);
+    mpz_mul(sp->p_square, p, p);
+    mpz_mul(sp->q_square, q, q);
+
+    // the order of Z_p^2* is p * (p - 1)
+    mpz_sub_ui(sp->p_order, p, 1);
+    mpz_mul(sp->p_order, sp->p_order, p);
+    mpz_sub_ui(sp->q_order, q, 1);
+    mpz_mul(sp->q_order, sp->q_order, q);
+
+    mpz_invert(sp->q_square_inv, sp->q_square, sp->p_square);
+}
+
+void cfe_paillier_sec_params_free(cfe_paillier_sec_params *sp) {
+    mpz_clears(sp->p_square, sp->q_square, sp->p_order, sp->q_order, sp->q_square_inv, NULL);
+}
+
+// combines the residues res_p modulo p^2 and res_q modulo q^2 into
+// res modulo n^2
+static void cfe_paillier_crt(mpz_t res, cfe_paillier_sec_params *sp, mpz_t res_p, mpz_t res_q) {
+    mpz_sub(res, res_p, res_q);
+    mpz_mul(res, res, sp->q_square_inv);
+    mpz_mod(res, res, sp->p_square);
+    mpz_mul(res, res, sp->q_square);
+    mpz_add(res, res, res_q);
+}
+
+void cfe_paillier_sec_params_powm(mpz_t res, cfe_paillier_sec_params *sp, mpz_t base, mpz_t e) {
+    mpz_t e_red, res_p, res_q;
+    mpz_inits(e_red, res_p, res_q, NULL);
+
+    // reducing the exponent modulo the order also makes it nonnegative,
+    // so no inversion is needed
+    mpz_mod(e_red, e, sp->p_order);
+    mpz_powm(res_p, base, e_red, sp->p_square);
+    mpz_mod(e_red, e, sp->q_order);
+    mpz_powm(res_q, base, e_red, sp->q_square);
+    cfe_paillier_crt(res, sp, res_p, res_q);
+
+    mpz_clears(e_red, res_p, res_q, NULL);
+}
+
+cfe_error cfe_paillier_generate_master_keys_sec(cfe_vec *msk, cfe_vec *mpk, cfe_paillier *s,
+                                                cfe_paillier_sec_params *sp) {
+    if (msk->size != s->l || mpk->size != s->l) {
+        return CFE_ERR_MALFORMED_INPUT;
+    }
+
+    cfe_normal_double_constant sampler;
+    cfe_normal_double_constant_init(&sampler, s->k_sigma);
+    cfe_normal_double_constant_sample_vec(msk, &sampler);
+
+    // all the powers of g modulo p^2 and q^2 use the same fixed-base tables
+    cfe_fixed_base g_p, g_q;
+    cfe_fixed_base_init(&g_p, s->g, sp->p_square, mpz_sizeinbase(sp->p_order, 2));
+    cfe_fixed_base_init(&g_q, s->g, sp->q_square, mpz_sizeinbase(sp->q_order, 2));
+
+    mpz_t e_red, res_p, res_q;
+    mpz_inits(e_red, res_p, res_q, NULL);
+    for (size_t i = 0; i < s->l; i++) {
+        mpz_mod(e_red, msk->vec[i], sp->p_order);
+        cfe_fixed_base_powm(res_p, &g_p, e_red);
+        mpz_mod(e_red, msk->vec[i], sp->q_order);
+        cfe_fixed_base_powm(res_q, &g_q, e_red);
+        cfe_paillier_crt(mpk->vec[i], sp, res_p, res_q);
+    }
+
+    mpz_clears(e_red, res_p, res_q, NULL);
+    cfe_fixed_base_free(&g_p);
+    cfe_fixed_base_free(&g_q);
+    cfe_normal_double_constant_free(&sampler);
+    return CFE_ERR_NONE;
+}
+
 cfe_error cfe_paillier_derive_fe_key(mpz_t fe_key, cfe_paillier *s, cfe_vec *msk, cfe_vec *y) {
     if (!cfe_vec_check_bound(y, s->bound_y)) {
         return CFE_ERR_BOUND_CHECK_FAILED;
@@ -167,52 +259,156 @@ void cfe_paillier_ciphertext_init(cfe_vec *ciphertext, cfe_paillier *s) {
     cfe_vec_init(ciphertext, s->l + 1);
 }
 
-cfe_error cfe_paillier_encrypt(cfe_vec *ciphertext, cfe_paillier *s, cfe_vec *x, cfe_vec *mpk) {
+// encrypts x with the master public key, using the prepared key pk
+// instead if it is not NULL
+static cfe_error cfe_paillier_encrypt_with(cfe_vec *ciphertext, cfe_paillier *s, cfe_vec *x, cfe_vec *mpk,
+                                           cfe_paillier_prep_pub_key *pk) {
     if (!cfe_vec_check_bound(x, s->bound_x)) {
         return CFE_ERR_BOUND_CHECK_FAILED;
     }
 
-    mpz_t n_div_4, r, c_0, c_i, x_i, mpk_i, tmp1, tmp2;
-    mpz_inits(n_div_4, r, c_0, c_i, x_i, mpk_i, tmp1, tmp2, NULL);
+    mpz_t n_div_4, r, c_i, t;
+    mpz_inits(n_div_4, r, c_i, t, NULL);
     mpz_div_ui(n_div_4, s->n, 4);
     cfe_uniform_sample(r, n_div_4);
 
-    mpz_powm(c_0, s->g, r, s->n_square);
-    cfe_vec_set(ciphertext, c_0, 0);
+    if (pk != NULL) {
+        cfe_fixed_base_powm(c_i, &pk->g, r);
+    } else {
+        mpz_powm(c_i, s->g, r, s->n_square);
+    }
+    cfe_vec_set(ciphertext, c_i, 0);
 
     for (size_t i = 0; i < s->l; i++) {
-        cfe_vec_get(x_i, x, i);
-        mpz_mul(tmp1, x_i, s->n);
-        mpz_add_ui(tmp1, tmp1, 1);
-        cfe_vec_get(mpk_i, mpk, i);
-        mpz_powm(tmp2, mpk_i, r, s->n_square);
-        mpz_mul(c_i, tmp1, tmp2);
-        mpz_mod(c_i, c_i, s->n_square);
+        if (pk != NULL) {
+            cfe_fixed_base_powm(c_i, &pk->mpk.bases[i], r);
+        } else {
+            mpz_powm(c_i, mpk->vec[i], r, s->n_square);
+        }
+
+        // (1 + x_i * n) * c_i = c_i + n * (x_i * c_i mod n) mod n^2,
+        // so the message only costs a product modulo n
+        mpz_mod(t, c_i, s->n);
+        mpz_mul(t, t, x->vec[i]);
+        mpz_mod(t, t, s->n);
+        mpz_addmul(c_i, t, s->n);
+        if (mpz_cmp(c_i, s->n_square) >= 0) {
+            mpz_sub(c_i, c_i, s->n_square);
+        }
         cfe_vec_set(ciphertext, c_i, i + 1);
     }
 
-    mpz_clears(n_div_4, r, c_0, c_i, x_i, mpk_i, tmp1, tmp2, NULL);
+    mpz_clears(n_div_4, r, c_i, t, NULL);
     return CFE_ERR_NONE;
 }
 
-cfe_error cfe_paillier_decrypt(mpz_t res, cfe_paillier *s, cfe_vec *ciphertext, mpz_t key, cfe_vec *y) {
-    if (!cfe_vec_check_bound(y, s->bound_y)) {
-        return CFE_ERR_BOUND_CHECK_FAILED;
+cfe_error cfe_paillier_encrypt(cfe_vec *ciphertext, cfe_paillier *s, cfe_vec *x, cfe_vec *mpk) {
+    return cfe_paillier_encrypt_with(ciphertext, s, x, mpk, NULL);
+}
+
+cfe_error cfe_paillier_prep_pub_key_init(cfe_paillier_prep_pub_key *pk, cfe_paillier *s, cfe_vec *mpk,
+                                         size_t memory_budget) {
+    if (mpk->size != s->l) {
+        return CFE_ERR_MALFORMED_PUB_KEY;
+    }
+
+    // the randomness of ciphertexts is below n / 4
+    size_t bits = mpz_sizeinbase(s->n, 2);
+    cfe_fixed_base_init(&pk->g, s->g, s->n_square, bits);
+    cfe_fixed_base_vec_init(&pk->mpk, mpk, s->n_square, bits, memory_budget);
+    return CFE_ERR_NONE;
+}
+
+void cfe_paillier_prep_pub_key_free(cfe_paillier_prep_pub_key *pk) {
+    cfe_fixed_base_free(&pk->g);
+    cfe_fixed_base_vec_free(&pk->mpk);
+}
+
+cfe_error cfe_paillier_encrypt_prep(cfe_vec *ciphertext, cfe_paillier *s, cfe_vec *x, cfe_paillier_prep_pub_key *pk) {
+    if (pk->mpk.size != s->l) {
+        return CFE_ERR_MALFORMED_PUB_KEY;
     }
 
-    mpz_t key_neg, c_0, c_i, y_i, tmp, half_n;
-    mpz_inits(key_neg, c_0, c_i, y_i, tmp, half_n, NULL);
-    mpz_neg(key_neg, key);
-    cfe_vec_get(c_0, ciphertext, 0);
-    mpz_powm(res, c_0, key_neg, s->n_square);
+    return cfe_paillier_encrypt_with(ciphertext, s, x, NULL, pk);
+}
+
+// a range of vectors encrypted by a single thread
+typedef struct cfe_paillier_encrypt_job {
+    cfe_vec *ciphertexts;
+    cfe_paillier *s;
+    cfe_vec *xs;
+    cfe_paillier_prep_pub_key *pk;
+    size_t from;
+    size_t to;
+} cfe_paillier_encrypt_job;
+
+static void *cfe_paillier_encrypt_worker(void *arg) {
+    cfe_paillier_encrypt_job *job = (cfe_paillier_encrypt_job *) arg;
+    for (size_t k = job->from; k < job->to; k++) {
+        cfe_paillier_encrypt_with(&job->ciphertexts[k], job->s, &job->xs[k], NULL, job->pk);
+    }
+
+    return NULL;
+}
+
+cfe_error cfe_paillier_encrypt_batch(cfe_vec *ciphertexts, cfe_paillier *s, cfe_vec *xs, size_t n,
+                                     cfe_paillier_prep_pub_key *pk, size_t num_threads) {
+    if (pk->mpk.size != s->l) {
+        return CFE_ERR_MALFORMED_PUB_KEY;
+    }
+    for (size_t k = 0; k < n; k++) {
+        if (xs[k].size != s->l || ciphertexts[k].size != s->l + 1) {
+            return CFE_ERR_MALFORMED_INPUT;
+        }
+        if (!cfe_vec_check_bound(&xs[k], s->bound_x)) {
+            return CFE_ERR_BOUND_CHECK_FAILED;
+        }
+    }
+
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+    if (num_threads > n) {
+        num_threads = n > 0 ? n : 1;
+    }
+
+    cfe_paillier_encrypt_job *jobs = (cfe_paillier_encrypt_job *) cfe_malloc(
+            num_threads * sizeof(cfe_paillier_encrypt_job));
+    for (size_t t = 0; t < num_threads; t++) {
+        jobs[t].ciphertexts = ciphertexts;
+        jobs[t].s = s;
+        jobs[t].xs = xs;
+        jobs[t].pk = pk;
+        jobs[t].from = t * n / num_threads;
+        jobs[t].to = (t + 1) * n / num_threads;
+    }
+    cfe_run_jobs(cfe_paillier_encrypt_worker, jobs, sizeof(cfe_paillier_encrypt_job), num_threads);
 
-    for (size_t i = 1; i < ciphertext->size; i++) {
-        cfe_vec_get(c_i, ciphertext, i);
-        cfe_vec_get(y_i, y, i - 1);
-        mpz_powm(tmp, c_i, y_i, s->n_square);
-        mpz_mul(res, res, tmp);
-        mpz_mod(res, res, s->n_square);
+    free(jobs);
+    return CFE_ERR_NONE;
+}
+
+// sets the exponents of the elements of a ciphertext for decryption,
+// (-key, y_1, ..., y_l)
+static void cfe_paillier_decrypt_exps(cfe_vec *exps, mpz_t key, cfe_vec *y) {
+    mpz_neg(exps->vec[0], key);
+    for (size_t i = 0; i < y->size; i++) {
+        mpz_set(exps->vec[i + 1], y->vec[i]);
     }
+}
+
+// computes c_0^(-key) * prod c_i^(y_i) as a single multi-exponentiation,
+// and recovers the inner product from it
+static cfe_error cfe_paillier_decrypt_exps_powm(mpz_t res, cfe_paillier *s, cfe_vec *ciphertext, cfe_vec *exps) {
+    if (ciphertext->size != exps->size) {
+        return CFE_ERR_MALFORMED_INPUT;
+    }
+    if (cfe_multi_powm(res, ciphertext, exps, s->n_square)) {
+        return CFE_ERR_MALFORMED_CIPHER;
+    }
+
+    mpz_t half_n;
+    mpz_init(half_n);
 
     mpz_sub_ui(res, res, 1);
     mpz_mod(res, res, s->n_square);
@@ -223,6 +419,88 @@ cfe_error cfe_paillier_decrypt(mpz_t res, cfe_paillier *s, cfe_vec *ciphertext,
         mpz_sub(res, res, s->n);
     }
 
-    mpz_clears(key_neg, c_0, c_i, y_i, tmp, half_n, NULL);
+    mpz_clear(half_n);
     return CFE_ERR_NONE;
 }
+
+cfe_error cfe_paillier_decrypt(mpz_t res, cfe_paillier *s, cfe_vec *ciphertext, mpz_t key, cfe_vec *y) {
+    if (!cfe_vec_check_bound(y, s->bound_y)) {
+        return CFE_ERR_BOUND_CHECK_FAILED;
+    }
+
+    cfe_vec exps;
+    cfe_vec_init(&exps, y->size + 1);
+    cfe_paillier_decrypt_exps(&exps, key, y);
+    cfe_error err = cfe_paillier_decrypt_exps_powm(res, s, ciphertext, &exps);
+    cfe_vec_free(&exps);
+
+    return err;
+}
+
+// a range of ciphertexts decrypted by a single thread
+typedef struct cfe_paillier_decrypt_job {
+    mpz_t *res;
+    cfe_error *errs;
+    cfe_paillier *s;
+    cfe_vec *ciphertexts;
+    cfe_vec *exps;
+    size_t from;
+    size_t to;
+} cfe_paillier_decrypt_job;
+
+static void *cfe_paillier_decrypt_worker(void *arg) {
+    cfe_paillier_decrypt_job *job = (cfe_paillier_decrypt_job *) arg;
+    for (size_t k = job->from; k < job->to; k++) {
+        job->errs[k] = cfe_paillier_decrypt_exps_powm(job->res[k], job->s, &job->ciphertexts[k], job->exps);
+    }
+
+    return NULL;
+}
+
+cfe_error cfe_paillier_decrypt_batch(mpz_t *res, cfe_error *errs, cfe_paillier *s, cfe_vec *ciphertexts, size_t n,
+                                     mpz_t key, cfe_vec *y, size_t num_threads) {
+    if (!cfe_vec_check_bound(y, s->bound_y)) {
+        return CFE_ERR_BOUND_CHECK_FAILED;
+    }
+    if (n == 0) {
+        return CFE_ERR_NONE;
+    }
+
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+    if (num_threads > n) {
+        num_threads = n;
+    }
+
+    // the exponents are the same for all the ciphertexts
+    cfe_vec exps;
+    cfe_vec_init(&exps, y->size + 1);
+    cfe_paillier_decrypt_exps(&exps, key, y);
+
+    cfe_error *errs_all = errs != NULL ? errs : (cfe_error *) cfe_malloc(n * sizeof(cfe_error));
+    cfe_paillier_decrypt_job *jobs = (cfe_paillier_decrypt_job *) cfe_malloc(
+            num_threads * sizeof(cfe_paillier_decrypt_job));
+    for (size_t t = 0; t < num_threads; t++) {
+        jobs[t].res = res;
+        jobs[t].errs = errs_all;
+        jobs[t].s = s;
+        jobs[t].ciphertexts = ciphertexts;
+        jobs[t].exps = &exps;
+        jobs[t].from = t * n / num_threads;
+        jobs[t].to = (t + 1) * n / num_threads;
+    }
+    cfe_run_jobs(cfe_paillier_decrypt_worker, jobs, sizeof(cfe_paillier_decrypt_job), num_threads);
+
+    cfe_error err = CFE_ERR_NONE;
+    for (size_t k = 0; k < n && !err; k++) {
+        err = errs_all[k];
+    }
+
+    if (errs == NULL) {
+        free(errs_all);
+    }
+    free(jobs);
+    cfe_vec_free(&exps);
+    return err;
+}
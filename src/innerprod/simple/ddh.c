@@ -19,7 +19,9 @@
 
 #include "cifer/innerprod/simple/ddh.h"
 #include "cifer/internal/keygen.h"
+#include "cifer/internal/common.h"
 #include "cifer/internal/dlog.h"
+#include "cifer/internal/prod.h"
 #include "cifer/sample/uniform.h"
 
 cfe_error cfe_ddh_init(cfe_ddh *s, size_t l, size_t modulus_len, mpz_t bound) {
@@ -48,6 +50,8 @@ cfe_error cfe_ddh_init(cfe_ddh *s, size_t l, size_t modulus_len, mpz_t bound) {
     mpz_set(s->p, key.p);
     mpz_sub_ui(s->q, s->p, 1);
     mpz_div_ui(s->q, s->q, 2);
+    cfe_fixed_base_init(&s->g_table, s->g, s->p, mpz_sizeinbase(s->q, 2));
+    cfe_small_powers_init_empty(&s->msg_table, s->p, s->bound);
 
     cleanup:
     cfe_elgamal_free(&key);
@@ -96,6 +100,8 @@ cfe_error cfe_ddh_precomp_init(cfe_ddh *s, size_t l, size_t modulus_len, mpz_t b
 
     s->l = l;
     mpz_set(s->bound, bound);
+    cfe_fixed_base_init(&s->g_table, s->g, s->p, mpz_sizeinbase(s->q, 2));
+    cfe_small_powers_init_empty(&s->msg_table, s->p, s->bound);
 
     cleanup:
     mpz_clear(check);
@@ -110,10 +116,19 @@ void cfe_ddh_copy(cfe_ddh *res, cfe_ddh *s) {
     mpz_init_set(res->g, s->g);
     mpz_init_set(res->p, s->p);
     mpz_init_set(res->q, s->q);
+    cfe_fixed_base_copy(&res->g_table, &s->g_table);
+    cfe_small_powers_copy(&res->msg_table, &s->msg_table);
 }
 
 void cfe_ddh_free(cfe_ddh *s) {
     mpz_clears(s->bound, s->g, s->p, s->q, NULL);
+    cfe_fixed_base_free(&s->g_table);
+    cfe_small_powers_free(&s->msg_table);
+}
+
+void cfe_ddh_msg_table_init(cfe_ddh *s) {
+    cfe_small_powers_free(&s->msg_table);
+    cfe_small_powers_init(&s->msg_table, s->g, s->p, s->bound);
 }
 
 void cfe_ddh_master_keys_init(cfe_vec *msk, cfe_vec *mpk, cfe_ddh *s) {
@@ -131,7 +146,7 @@ void cfe_ddh_generate_master_keys(cfe_vec *msk, cfe_vec *mpk, cfe_ddh *s) {
         cfe_uniform_sample_range_i_mpz(x, 2, s->q);
         cfe_vec_set(msk, x, i);
 
-        mpz_powm(x, s->g, x, s->p);
+        cfe_fixed_base_powm(x, &s->g_table, x);
         cfe_vec_set(mpk, x, i);
     }
 
@@ -148,7 +163,42 @@ cfe_error cfe_ddh_derive_fe_key(mpz_t res, cfe_ddh *s, cfe_vec *msk, cfe_vec *y)
     return CFE_ERR_NONE;
 }
 
-cfe_error cfe_ddh_encrypt(cfe_vec *ciphertext, cfe_ddh *s, cfe_vec *x, cfe_vec *mpk) {
+cfe_error cfe_ddh_derive_fe_keys(cfe_vec *res, cfe_ddh *s, cfe_vec *msk, cfe_mat *Y, size_t num_threads) {
+    if (Y->cols != s->l || msk->size != s->l || res->size != Y->rows) {
+        return CFE_ERR_MALFORMED_INPUT;
+    }
+    if (!cfe_mat_check_bound(Y, s->bound)) {
+        return CFE_ERR_BOUND_CHECK_FAILED;
+    }
+
+    // the keys are the product of Y with the master secret key as a column
+    cfe_mat msk_col, keys;
+    cfe_mat_init(&msk_col, s->l, 1);
+    cfe_mat_init(&keys, Y->rows, 1);
+    for (size_t i = 0; i < s->l; i++) {
+        mpz_set(msk_col.mat[i].vec[0], msk->vec[i]);
+    }
+
+    cfe_mat_mul_mod(&keys, Y, &msk_col, s->q, num_threads);
+    for (size_t k = 0; k < Y->rows; k++) {
+        mpz_set(res->vec[k], keys.mat[k].vec[0]);
+    }
+
+    cfe_mat_frees(&msk_col, &keys, NULL);
+    return CFE_ERR_NONE;
+}
+
+// computes g^x_i for a coordinate of the input vector
+static void cfe_ddh_msg_powm(mpz_t res, cfe_ddh *s, mpz_t x_i) {
+    if (!cfe_small_powers_get(res, &s->msg_table, x_i)) {
+        cfe_fixed_base_powm(res, &s->g_table, x_i);
+    }
+}
+
+// encrypts x with the master public key, using the prepared key pk
+// instead if it is not NULL
+static cfe_error cfe_ddh_encrypt_with(cfe_vec *ciphertext, cfe_ddh *s, cfe_vec *x, cfe_vec *mpk,
+                                      cfe_fixed_base_vec *pk) {
     if (!cfe_vec_check_bound(x, s->bound)) {
         return CFE_ERR_BOUND_CHECK_FAILED;
     }
@@ -157,15 +207,19 @@ cfe_error cfe_ddh_encrypt(cfe_vec *ciphertext, cfe_ddh *s, cfe_vec *x, cfe_vec *
     mpz_inits(r, ct, t1, t2, NULL);
     cfe_uniform_sample_range_i_mpz(r, 1, s->q);
 
-    mpz_powm(ct, s->g, r, s->p);
+    cfe_fixed_base_powm(ct, &s->g_table, r);
     cfe_vec_set(ciphertext, ct, 0);
 
     for (size_t i = 0; i < s->l; i++) {
-        cfe_vec_get(t1, mpk, i);
-        mpz_powm(t1, t1, r, s->p);
+        if (pk != NULL) {
+            cfe_fixed_base_powm(t1, &pk->bases[i], r);
+        } else {
+            cfe_vec_get(t1, mpk, i);
+            mpz_powm(t1, t1, r, s->p);
+        }
 
         cfe_vec_get(t2, x, i);
-        mpz_powm(t2, s->g, t2, s->p);
+        cfe_ddh_msg_powm(t2, s, t2);
 
         mpz_mul(ct, t1, t2);
         mpz_mod(ct, ct, s->p);
@@ -176,38 +230,271 @@ cfe_error cfe_ddh_encrypt(cfe_vec *ciphertext, cfe_ddh *s, cfe_vec *x, cfe_vec *
     return CFE_ERR_NONE;
 }
 
-cfe_error cfe_ddh_decrypt(mpz_t res, cfe_ddh *s, cfe_vec *ciphertext, mpz_t key, cfe_vec *y) {
-    if (!cfe_vec_check_bound(y, s->bound)) {
+cfe_error cfe_ddh_encrypt(cfe_vec *ciphertext, cfe_ddh *s, cfe_vec *x, cfe_vec *mpk) {
+    return cfe_ddh_encrypt_with(ciphertext, s, x, mpk, NULL);
+}
+
+cfe_error cfe_ddh_prep_pub_key_init(cfe_fixed_base_vec *pk, cfe_ddh *s, cfe_vec *mpk, size_t memory_budget) {
+    if (mpk->size != s->l) {
+        return CFE_ERR_MALFORMED_PUB_KEY;
+    }
+
+    cfe_fixed_base_vec_init(pk, mpk, s->p, mpz_sizeinbase(s->q, 2), memory_budget);
+    return CFE_ERR_NONE;
+}
+
+cfe_error cfe_ddh_encrypt_prep(cfe_vec *ciphertext, cfe_ddh *s, cfe_vec *x, cfe_fixed_base_vec *pk) {
+    if (pk->size != s->l) {
+        return CFE_ERR_MALFORMED_PUB_KEY;
+    }
+
+    return cfe_ddh_encrypt_with(ciphertext, s, x, NULL, pk);
+}
+
+// the scheme and the prepared public key a pool of randomness uses
+typedef struct cfe_ddh_pool_data {
+    cfe_ddh s;
+    cfe_fixed_base_vec pk;
+} cfe_ddh_pool_data;
+
+// computes (g^r, mpk_1^r, ..., mpk_l^r) for a fresh random r
+static void cfe_ddh_pool_fill(cfe_vec *elem, void *data) {
+    cfe_ddh_pool_data *d = (cfe_ddh_pool_data *) data;
+    mpz_t r;
+    mpz_init(r);
+    cfe_uniform_sample_range_i_mpz(r, 1, d->s.q);
+
+    cfe_fixed_base_powm(elem->vec[0], &d->s.g_table, r);
+    for (size_t i = 0; i < d->s.l; i++) {
+        cfe_fixed_base_powm(elem->vec[i + 1], &d->pk.bases[i], r);
+    }
+
+    mpz_clear(r);
+}
+
+static void cfe_ddh_pool_data_free(void *data) {
+    cfe_ddh_pool_data *d = (cfe_ddh_pool_data *) data;
+    cfe_fixed_base_vec_free(&d->pk);
+    cfe_ddh_free(&d->s);
+    free(d);
+}
+
+cfe_error cfe_ddh_pool_init(cfe_pool *pool, cfe_ddh *s, cfe_vec *mpk, size_t capacity, bool background) {
+    if (mpk->size != s->l) {
+        return CFE_ERR_MALFORMED_PUB_KEY;
+    }
+
+    cfe_ddh_pool_data *d = (cfe_ddh_pool_data *) cfe_malloc(sizeof(cfe_ddh_pool_data));
+    cfe_ddh_copy(&d->s, s);
+    cfe_fixed_base_vec_init(&d->pk, mpk, s->p, mpz_sizeinbase(s->q, 2), 0);
+    cfe_pool_init(pool, capacity, s->l + 1, cfe_ddh_pool_fill, cfe_ddh_pool_data_free, d, background);
+
+    return CFE_ERR_NONE;
+}
+
+cfe_error cfe_ddh_encrypt_pooled(cfe_vec *ciphertext, cfe_ddh *s, cfe_vec *x, cfe_pool *pool) {
+    if (!cfe_vec_check_bound(x, s->bound)) {
         return CFE_ERR_BOUND_CHECK_FAILED;
     }
+    if (x->size != s->l || ciphertext->size != s->l + 1 || pool->elem_size != s->l + 1) {
+        return CFE_ERR_MALFORMED_INPUT;
+    }
 
-    mpz_t num, ct, t1, denom, denom_inv, r, bound;
-    mpz_inits(num, ct, t1, denom, denom_inv, r, bound, NULL);
+    // the ciphertext starts as (g^r, mpk_1^r, ..., mpk_l^r)
+    cfe_pool_take(ciphertext, pool);
 
-    mpz_set_ui(num, 1);
+    mpz_t t;
+    mpz_init(t);
+    for (size_t i = 0; i < s->l; i++) {
+        cfe_ddh_msg_powm(t, s, x->vec[i]);
+        mpz_mul(ciphertext->vec[i + 1], ciphertext->vec[i + 1], t);
+        mpz_mod(ciphertext->vec[i + 1], ciphertext->vec[i + 1], s->p);
+    }
+    mpz_clear(t);
 
-    for (size_t i = 1; i < ciphertext->size; i++) {
-        cfe_vec_get(ct, ciphertext, i);
-        cfe_vec_get(r, y, i - 1);
+    return CFE_ERR_NONE;
+}
 
-        mpz_powm(t1, ct, r, s->p);
+// computes g^<x,y> from the ciphertext, the functional encryption key and y
+// as a single multi-exponentiation ct_0^(-key) * prod ct_i^(y_i)
+static cfe_error cfe_ddh_decrypt_elem(mpz_t res, cfe_ddh *s, cfe_vec *ciphertext, mpz_t key, cfe_vec *y) {
+    if (ciphertext->size != s->l + 1 || y->size != s->l) {
+        return CFE_ERR_MALFORMED_INPUT;
+    }
 
-        mpz_mul(num, num, t1);
-        mpz_mod(num, num, s->p);
+    cfe_vec exps;
+    cfe_vec_init(&exps, ciphertext->size);
+    mpz_neg(exps.vec[0], key);
+    for (size_t i = 0; i < s->l; i++) {
+        mpz_set(exps.vec[i + 1], y->vec[i]);
     }
 
-    cfe_vec_get(ct, ciphertext, 0);
-    mpz_powm(denom, ct, key, s->p);
-    mpz_invert(denom_inv, denom, s->p);
-    mpz_mul(r, denom_inv, num);
-    mpz_mod(r, r, s->p);
+    cfe_error err = cfe_multi_powm(res, ciphertext, &exps, s->p);
+    cfe_vec_free(&exps);
 
+    return err ? CFE_ERR_MALFORMED_CIPHER : CFE_ERR_NONE;
+}
+
+cfe_error cfe_ddh_decrypt(mpz_t res, cfe_ddh *s, cfe_vec *ciphertext, mpz_t key, cfe_vec *y) {
+    return cfe_ddh_decrypt_with_config(res, s, ciphertext, key, y, NULL);
+}
+
+// sets bound to the bound n * l * bound² on the inner products of a sum
+// of n vectors, which must be below the order of the group for the
+// discrete logarithm to be unique
+static cfe_error cfe_ddh_sum_bound(mpz_t bound, cfe_ddh *s, size_t n) {
     mpz_pow_ui(bound, s->bound, 2);
     mpz_mul_ui(bound, bound, s->l);
+    mpz_mul_ui(bound, bound, n);
 
-    cfe_error err = cfe_baby_giant_with_neg(res, r, s->g, s->p, s->q, bound);
+    return mpz_cmp(bound, s->q) > 0 ? CFE_ERR_PRECONDITION_FAILED : CFE_ERR_NONE;
+}
 
-    mpz_clears(num, ct, t1, denom, denom_inv, r, bound, NULL);
+// decrypts a ciphertext of the sum of n vectors
+static cfe_error cfe_ddh_decrypt_sum(mpz_t res, cfe_ddh *s, cfe_vec *ciphertext, mpz_t key, cfe_vec *y, size_t n,
+                                     cfe_dlog_config *c) {
+    if (!cfe_vec_check_bound(y, s->bound)) {
+        return CFE_ERR_BOUND_CHECK_FAILED;
+    }
+
+    mpz_t r, bound;
+    mpz_inits(r, bound, NULL);
+
+    cfe_error err = cfe_ddh_sum_bound(bound, s, n);
+    if (err) {
+        goto cleanup;
+    }
+
+    err = cfe_ddh_decrypt_elem(r, s, ciphertext, key, y);
+    if (err) {
+        goto cleanup;
+    }
+
+    err = cfe_dlog_with_neg(res, r, s->g, s->p, s->q, bound, c);
+
+    cleanup:
+    mpz_clears(r, bound, NULL);
+
+    return err;
+}
+
+cfe_error cfe_ddh_decrypt_with_config(mpz_t res, cfe_ddh *s, cfe_vec *ciphertext, mpz_t key, cfe_vec *y,
+                                      cfe_dlog_config *c) {
+    return cfe_ddh_decrypt_sum(res, s, ciphertext, key, y, 1, c);
+}
+
+cfe_error cfe_ddh_dlog_table_init(cfe_dlog_table *t, cfe_ddh *s) {
+    return cfe_ddh_aggregate_dlog_table_init(t, s, 1);
+}
+
+cfe_error cfe_ddh_decrypt_with_table(mpz_t res, cfe_ddh *s, cfe_vec *ciphertext, mpz_t key, cfe_vec *y,
+                                     cfe_dlog_table *t) {
+    if (!cfe_vec_check_bound(y, s->bound)) {
+        return CFE_ERR_BOUND_CHECK_FAILED;
+    }
+
+    mpz_t r;
+    mpz_init(r);
+
+    cfe_error err = cfe_ddh_decrypt_elem(r, s, ciphertext, key, y);
+    if (!err) {
+        err = cfe_dlog_table_solve_with_neg(res, r, t);
+    }
+
+    mpz_clear(r);
+
+    return err;
+}
+
+cfe_error cfe_ddh_ciphertext_aggregate(cfe_vec *res, cfe_ddh *s, cfe_vec *ciphertexts, size_t n) {
+    return cfe_ddh_ciphertext_aggregate_parallel(res, s, ciphertexts, n, 1);
+}
+
+cfe_error cfe_ddh_ciphertext_aggregate_parallel(cfe_vec *res, cfe_ddh *s, cfe_vec *ciphertexts, size_t n,
+                                                size_t num_threads) {
+    if (n == 0) {
+        return CFE_ERR_MALFORMED_INPUT;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (ciphertexts[i].size != s->l + 1) {
+            return CFE_ERR_MALFORMED_CIPHER;
+        }
+    }
+
+    mpz_t bound;
+    mpz_init(bound);
+
+    cfe_error err = cfe_ddh_sum_bound(bound, s, n);
+    if (!err) {
+        err = cfe_vec_prod_mod(res, ciphertexts, n, s->p, num_threads);
+    }
+
+    mpz_clear(bound);
+
+    return err;
+}
+
+cfe_error cfe_ddh_decrypt_aggregate(mpz_t res, cfe_ddh *s, cfe_vec *ciphertext, mpz_t key, cfe_vec *y, size_t n) {
+    return cfe_ddh_decrypt_sum(res, s, ciphertext, key, y, n, NULL);
+}
+
+cfe_error cfe_ddh_aggregate_dlog_table_init(cfe_dlog_table *t, cfe_ddh *s, size_t n) {
+    mpz_t bound;
+    mpz_init(bound);
+
+    cfe_error err = cfe_ddh_sum_bound(bound, s, n);
+    if (!err) {
+        err = cfe_dlog_table_init(t, s->g, s->p, s->q, bound);
+    }
+
+    mpz_clear(bound);
+
+    return err;
+}
+
+cfe_error cfe_ddh_decrypt_batch(mpz_t *res, cfe_error *errs, cfe_ddh *s, cfe_vec *ciphertext, mpz_t *keys, cfe_vec *ys,
+                                size_t n, cfe_dlog_table *t, size_t num_threads) {
+    if (n == 0) {
+        return CFE_ERR_NONE;
+    }
+    if (ciphertext->size != s->l + 1) {
+        return CFE_ERR_MALFORMED_INPUT;
+    }
+
+    cfe_error *errs_all = errs != NULL ? errs : (cfe_error *) cfe_malloc(n * sizeof(cfe_error));
+    cfe_vec *exps = (cfe_vec *) cfe_malloc(n * sizeof(cfe_vec));
+
+    // the exponents of the elements of the ciphertext for each key; the
+    // exponents of invalid pairs are left 0
+    for (size_t k = 0; k < n; k++) {
+        cfe_vec_init(&exps[k], ciphertext->size);
+        errs_all[k] = CFE_ERR_NONE;
+        if (ys[k].size != s->l) {
+            errs_all[k] = CFE_ERR_MALFORMED_INPUT;
+        } else if (!cfe_vec_check_bound(&ys[k], s->bound)) {
+            errs_all[k] = CFE_ERR_BOUND_CHECK_FAILED;
+        } else {
+            mpz_neg(exps[k].vec[0], keys[k]);
+            for (size_t i = 0; i < s->l; i++) {
+                mpz_set(exps[k].vec[i + 1], ys[k].vec[i]);
+            }
+        }
+    }
+
+    mpz_t bound;
+    mpz_init(bound);
+    cfe_ddh_sum_bound(bound, s, 1);
+    cfe_error err = cfe_dlog_powm_batch_with_neg(res, errs_all, ciphertext, exps, n, s->g, s->p, s->q, bound, t,
+                                                 num_threads);
+    mpz_clear(bound);
+
+    for (size_t k = 0; k < n; k++) {
+        cfe_vec_free(&exps[k]);
+    }
+    free(exps);
+    if (errs == NULL) {
+        free(errs_all);
+    }
 
     return err;
 }
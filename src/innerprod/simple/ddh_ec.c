@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2018 XLAB d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <gmp.h>
+#include <amcl/big_256_56.h>
+
+#include "cifer/innerprod/simple/ddh_ec.h"
+#include "cifer/internal/big.h"
+#include "cifer/internal/dlog.h"
+#include "cifer/sample/uniform.h"
+
+cfe_error cfe_ddh_ec_init(cfe_ddh_ec *s, size_t l, mpz_t bound) {
+    cfe_error err = CFE_ERR_NONE;
+    mpz_t check;
+    mpz_inits(s->bound, s->order, check, NULL);
+
+    BIG_256_56 order_big;
+    BIG_256_56_rcopy(order_big, CURVE_Order_BN254);
+    mpz_from_BIG_256_56(s->order, order_big);
+
+    mpz_pow_ui(check, bound, 2);
+    mpz_mul_ui(check, check, 2 * l);
+
+    if (mpz_cmp(check, s->order) >= 0) {
+        mpz_clears(s->bound, s->order, NULL);
+        err = CFE_ERR_PRECONDITION_FAILED;
+        goto cleanup;
+    }
+
+    s->l = l;
+    mpz_set(s->bound, bound);
+
+    cleanup:
+    mpz_clear(check);
+
+    return err;
+}
+
+// res should be uninitialized!
+void cfe_ddh_ec_copy(cfe_ddh_ec *res, cfe_ddh_ec *s) {
+    res->l = s->l;
+    mpz_init_set(res->bound, s->bound);
+    mpz_init_set(res->order, s->order);
+}
+
+void cfe_ddh_ec_free(cfe_ddh_ec *s) {
+    mpz_clears(s->bound, s->order, NULL);
+}
+
+void cfe_ddh_ec_master_keys_init(cfe_vec *msk, cfe_vec_G1 *mpk, cfe_ddh_ec *s) {
+    cfe_vec_init(msk, s->l);
+    cfe_vec_G1_init(mpk, s->l);
+}
+
+void cfe_ddh_ec_ciphertext_init(cfe_vec_G1 *ciphertext, cfe_ddh_ec *s) {
+    cfe_vec_G1_init(ciphertext, s->l + 1);
+}
+
+void cfe_ddh_ec_generate_master_keys(cfe_vec *msk, cfe_vec_G1 *mpk, cfe_ddh_ec *s) {
+    mpz_t x;
+    mpz_init(x);
+    BIG_256_56 x_big;
+    for (size_t i = 0; i < s->l; i++) {
+        cfe_uniform_sample_range_i_mpz(x, 2, s->order);
+        cfe_vec_set(msk, x, i);
+
+        BIG_256_56_from_mpz(x_big, x);
+        ECP_BN254_generator(&(mpk->vec[i]));
+        ECP_BN254_mul(&(mpk->vec[i]), x_big);
+    }
+
+    mpz_clear(x);
+}
+
+cfe_error cfe_ddh_ec_derive_fe_key(mpz_t res, cfe_ddh_ec *s, cfe_vec *msk, cfe_vec *y) {
+    if (!cfe_vec_check_bound(y, s->bound)) {
+        return CFE_ERR_BOUND_CHECK_FAILED;
+    }
+
+    cfe_vec_dot(res, msk, y);
+    mpz_mod(res, res, s->order);
+    return CFE_ERR_NONE;
+}
+
+cfe_error cfe_ddh_ec_encrypt(cfe_vec_G1 *ciphertext, cfe_ddh_ec *s, cfe_vec *x, cfe_vec_G1 *mpk) {
+    if (!cfe_vec_check_bound(x, s->bound)) {
+        return CFE_ERR_BOUND_CHECK_FAILED;
+    }
+    if (x->size != s->l || mpk->size != s->l || ciphertext->size != s->l + 1) {
+        return CFE_ERR_MALFORMED_INPUT;
+    }
+
+    mpz_t r, x_i;
+    mpz_inits(r, x_i, NULL);
+    cfe_uniform_sample_range_i_mpz(r, 1, s->order);
+
+    BIG_256_56 r_big, x_big;
+    BIG_256_56_from_mpz(r_big, r);
+    ECP_BN254 g;
+    ECP_BN254_generator(&(ciphertext->vec[0]));
+    ECP_BN254_mul(&(ciphertext->vec[0]), r_big);
+
+    // ct_i = r * mpk_i + x_i * g with a single double scalar
+    // multiplication, with g negated for negative x_i
+    for (size_t i = 0; i < s->l; i++) {
+        ECP_BN254_generator(&g);
+        if (mpz_sgn(x->vec[i]) < 0) {
+            ECP_BN254_neg(&g);
+        }
+        mpz_abs(x_i, x->vec[i]);
+        BIG_256_56_from_mpz(x_big, x_i);
+
+        ECP_BN254_copy(&(ciphertext->vec[i + 1]), &(mpk->vec[i]));
+        ECP_BN254_mul2(&(ciphertext->vec[i + 1]), &g, r_big, x_big);
+    }
+
+    mpz_clears(r, x_i, NULL);
+    return CFE_ERR_NONE;
+}
+
+// computes <x,y> * g from the ciphertext, the functional encryption key and
+// y as a single sum -key * ct_0 + sum y_i * ct_i
+static cfe_error cfe_ddh_ec_decrypt_elem(ECP_BN254 *res, cfe_ddh_ec *s, cfe_vec_G1 *ciphertext, mpz_t key,
+                                         cfe_vec *y) {
+    if (ciphertext->size != s->l + 1 || y->size != s->l) {
+        return CFE_ERR_MALFORMED_INPUT;
+    }
+
+    cfe_vec exps;
+    cfe_vec_init(&exps, ciphertext->size);
+    mpz_mod(exps.vec[0], key, s->order);
+    mpz_neg(exps.vec[0], exps.vec[0]);
+    for (size_t i = 0; i < s->l; i++) {
+        mpz_set(exps.vec[i + 1], y->vec[i]);
+    }
+
+    cfe_vec_dot_G1(res, &exps, ciphertext);
+    cfe_vec_free(&exps);
+
+    return CFE_ERR_NONE;
+}
+
+cfe_error cfe_ddh_ec_decrypt(mpz_t res, cfe_ddh_ec *s, cfe_vec_G1 *ciphertext, mpz_t key, cfe_vec *y) {
+    if (!cfe_vec_check_bound(y, s->bound)) {
+        return CFE_ERR_BOUND_CHECK_FAILED;
+    }
+
+    ECP_BN254 r, g;
+    cfe_error err = cfe_ddh_ec_decrypt_elem(&r, s, ciphertext, key, y);
+    if (err) {
+        return err;
+    }
+
+    mpz_t bound;
+    mpz_init(bound);
+    mpz_pow_ui(bound, s->bound, 2);
+    mpz_mul_ui(bound, bound, s->l);
+
+    ECP_BN254_generator(&g);
+    err = cfe_baby_giant_ECP_BN254_with_neg(res, &r, &g, bound);
+
+    mpz_clear(bound);
+
+    return err;
+}
+
+cfe_error cfe_ddh_ec_dlog_table_init(cfe_dlog_table_ECP_BN254 *t, cfe_ddh_ec *s) {
+    mpz_t bound;
+    mpz_init(bound);
+
+    mpz_pow_ui(bound, s->bound, 2);
+    mpz_mul_ui(bound, bound, s->l);
+
+    ECP_BN254 g;
+    ECP_BN254_generator(&g);
+    cfe_error err = cfe_dlog_table_ECP_BN254_init(t, &g, bound);
+
+    mpz_clear(bound);
+
+    return err;
+}
+
+cfe_error cfe_ddh_ec_decrypt_with_table(mpz_t res, cfe_ddh_ec *s, cfe_vec_G1 *ciphertext, mpz_t key, cfe_vec *y,
+                                        cfe_dlog_table_ECP_BN254 *t) {
+    if (!cfe_vec_check_bound(y, s->bound)) {
+        return CFE_ERR_BOUND_CHECK_FAILED;
+    }
+
+    ECP_BN254 r;
+    cfe_error err = cfe_ddh_ec_decrypt_elem(&r, s, ciphertext, key, y);
+    if (!err) {
+        err = cfe_dlog_table_ECP_BN254_solve_with_neg(res, &r, t);
+    }
+
+    return err;
+}
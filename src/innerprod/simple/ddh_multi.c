@@ -150,6 +150,11 @@ cfe_error cfe_ddh_multi_encrypt(cfe_vec *ciphertext, cfe_ddh_multi_enc *e, cfe_v
 
 cfe_error
 cfe_ddh_multi_decrypt(mpz_t res, cfe_ddh_multi *m, cfe_mat *ciphertext, cfe_ddh_multi_fe_key *key, cfe_mat *y) {
+    return cfe_ddh_multi_decrypt_with_config(res, m, ciphertext, key, y, NULL);
+}
+
+cfe_error cfe_ddh_multi_decrypt_with_config(mpz_t res, cfe_ddh_multi *m, cfe_mat *ciphertext, cfe_ddh_multi_fe_key *key,
+                                            cfe_mat *y, cfe_dlog_config *conf) {
     if (!cfe_mat_check_bound(y, m->scheme.bound)) {
         return CFE_ERR_BOUND_CHECK_FAILED;
     }
@@ -161,7 +166,8 @@ cfe_ddh_multi_decrypt(mpz_t res, cfe_ddh_multi *m, cfe_mat *ciphertext, cfe_ddh_
 
     for (size_t i = 0; i < m->slots; i++) {
         cfe_vec_get(k, &key->keys, i);
-        err = cfe_ddh_decrypt(c, &m->scheme, cfe_mat_get_row_ptr(ciphertext, i), k, cfe_mat_get_row_ptr(y, i));
+        err = cfe_ddh_decrypt_with_config(c, &m->scheme, cfe_mat_get_row_ptr(ciphertext, i), k,
+                                          cfe_mat_get_row_ptr(y, i), conf);
         if (err) {
             break;
         }
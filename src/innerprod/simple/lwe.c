@@ -198,6 +198,27 @@ cfe_error cfe_lwe_derive_fe_key(cfe_vec *sk_y, cfe_lwe *s, cfe_mat *SK, cfe_vec
     return CFE_ERR_NONE;
 }
 
+cfe_error cfe_lwe_derive_fe_keys(cfe_mat *SK_Y, cfe_lwe *s, cfe_mat *SK, cfe_mat *Y, size_t num_threads) {
+    if (Y->cols != s->l || SK_Y->rows != Y->rows || SK_Y->cols != s->n) {
+        return CFE_ERR_MALFORMED_INPUT;
+    }
+    if (!cfe_mat_check_bound(Y, s->bound_y)) {
+        return CFE_ERR_BOUND_CHECK_FAILED;
+    }
+    if (SK->rows != s->n || SK->cols != s->l) {
+        return CFE_ERR_MALFORMED_SEC_KEY;
+    }
+
+    // the rows of Y * SK^T are the keys SK * y
+    cfe_mat SK_t;
+    cfe_mat_init(&SK_t, s->l, s->n);
+    cfe_mat_transpose(&SK_t, SK);
+    cfe_mat_mul_mod(SK_Y, Y, &SK_t, s->q, num_threads);
+
+    cfe_mat_free(&SK_t);
+    return CFE_ERR_NONE;
+}
+
 void cfe_lwe_ciphertext_init(cfe_vec *ct, cfe_lwe *s) {
     cfe_vec_init(ct, s->n + s->l);
 }
@@ -149,6 +149,21 @@ cfe_error cfe_ring_lwe_derive_fe_key(cfe_vec *sk_y, cfe_ring_lwe *s, cfe_mat *SK
     return CFE_ERR_NONE;
 }
 
+cfe_error cfe_ring_lwe_derive_fe_keys(cfe_mat *SK_Y, cfe_ring_lwe *s, cfe_mat *SK, cfe_mat *Y, size_t num_threads) {
+    if (Y->cols != s->l || SK_Y->rows != Y->rows || SK_Y->cols != s->n) {
+        return CFE_ERR_MALFORMED_INPUT;
+    }
+    if (!cfe_mat_check_bound(Y, s->bound)) {
+        return CFE_ERR_BOUND_CHECK_FAILED;
+    }
+    if (SK->rows != s->l || SK->cols != s->n) {
+        return CFE_ERR_MALFORMED_SEC_KEY;
+    }
+
+    cfe_mat_mul_mod(SK_Y, Y, SK, s->q, num_threads);
+    return CFE_ERR_NONE;
+}
+
 void cfe_ring_lwe_ciphertext_init(cfe_mat *CT, cfe_ring_lwe *s) {
     cfe_mat_init(CT, s->l + 1, s->n);
 }
@@ -14,6 +14,9 @@
  * limitations under the License.
  */
 
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
 #include <sodium.h>
 
 #include "cifer/internal/common.h"
@@ -35,3 +38,26 @@ void *cfe_malloc(size_t size) {
 
     return ptr;
 }
+
+void cfe_run_jobs(void *(*worker)(void *), void *jobs, size_t job_size, size_t num_jobs) {
+    if (num_jobs == 1) {
+        worker(jobs);
+        return;
+    }
+
+    pthread_t *threads = (pthread_t *) cfe_malloc(num_jobs * sizeof(pthread_t));
+    bool *started = (bool *) cfe_malloc(num_jobs * sizeof(bool));
+    for (size_t k = 0; k < num_jobs; k++) {
+        started[k] = pthread_create(&threads[k], NULL, worker, (char *) jobs + k * job_size) == 0;
+        if (!started[k]) {
+            worker((char *) jobs + k * job_size);
+        }
+    }
+    for (size_t k = 0; k < num_jobs; k++) {
+        if (started[k]) {
+            pthread_join(threads[k], NULL);
+        }
+    }
+    free(threads);
+    free(started);
+}
@@ -14,27 +14,378 @@
  * limitations under the License.
  */
 
-#include <uthash.h>
-#include <amcl/ecp_BN254.h>
+// mmap and friends are not part of C11
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "cifer/internal/big.h"
 #include "cifer/internal/common.h"
 #include "cifer/internal/dlog.h"
+#include "cifer/internal/powm.h"
+#include "cifer/sample/uniform.h"
+
+// marks an empty slot of the table of baby steps
+#define CFE_DLOG_EMPTY UINT32_MAX
+
+// sizes of the bound and of the generator in a table file
+#define CFE_DLOG_TABLE_BOUND_BYTES 32
+#define CFE_DLOG_TABLE_G_BYTES (12 * MODBYTES_256_56)
+
+// the table is at most half full, which keeps the probe sequences short
+static size_t cfe_dlog_hash_log_capacity(size_t entries) {
+    size_t log_capacity = 1;
+    while (((size_t) 1 << log_capacity) < 2 * entries) {
+        log_capacity++;
+    }
+
+    return log_capacity;
+}
+
+// allocates an empty table with room for the given number of entries
+static void cfe_dlog_hash_init(cfe_dlog_hash *T, size_t entries) {
+    T->log_capacity = cfe_dlog_hash_log_capacity(entries);
+    size_t capacity = (size_t) 1 << T->log_capacity;
+    T->keys = (uint64_t *) cfe_malloc(capacity * sizeof(uint64_t));
+    T->vals = (uint32_t *) cfe_malloc(capacity * sizeof(uint32_t));
+    for (size_t i = 0; i < capacity; i++) {
+        T->vals[i] = CFE_DLOG_EMPTY;
+    }
+}
+
+static void cfe_dlog_hash_free(cfe_dlog_hash *T) {
+    free(T->keys);
+    free(T->vals);
+}
+
+// the slot where the search for a fingerprint starts
+static size_t cfe_dlog_hash_slot(cfe_dlog_hash *T, uint64_t fp) {
+    return (size_t) ((fp * 0x9E3779B97F4A7C15u) >> (64 - T->log_capacity));
+}
+
+// the slot following the given one in a probe sequence
+static size_t cfe_dlog_hash_next(cfe_dlog_hash *T, size_t slot) {
+    return (slot + 1) & (((size_t) 1 << T->log_capacity) - 1);
+}
+
+// stores T[fps[i]] = i for all i < n
+static void cfe_dlog_hash_fill(cfe_dlog_hash *T, uint64_t *fps, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        size_t slot = cfe_dlog_hash_slot(T, fps[i]);
+        while (T->vals[slot] != CFE_DLOG_EMPTY) {
+            slot = cfe_dlog_hash_next(T, slot);
+        }
+        T->keys[slot] = fps[i];
+        T->vals[slot] = (uint32_t) i;
+    }
+}
+
+// checks a table read from a file: every index must be below m, at most m
+// slots may be filled and at least one must be empty, so that every probe
+// sequence ends
+static bool cfe_dlog_hash_valid(cfe_dlog_hash *T, size_t m) {
+    size_t capacity = (size_t) 1 << T->log_capacity;
+    size_t filled = 0;
+    for (size_t i = 0; i < capacity; i++) {
+        if (T->vals[i] != CFE_DLOG_EMPTY) {
+            if (T->vals[i] >= m) {
+                return false;
+            }
+            filled++;
+        }
+    }
+
+    return filled <= m && filled < capacity;
+}
+
+// the number of threads used by the baby-step giant-step method when
+// it is not given explicitly
+static size_t cfe_dlog_num_threads = 1;
+
+void cfe_dlog_set_num_threads(size_t num_threads) {
+    cfe_dlog_num_threads = num_threads > 0 ? num_threads : 1;
+}
+
+size_t cfe_dlog_get_num_threads(void) {
+    return cfe_dlog_num_threads;
+}
+
+// limits the number of threads so that each one gets at least one step
+static size_t cfe_dlog_threads_for(size_t num_threads, size_t steps) {
+    if (num_threads == 0) {
+        num_threads = cfe_dlog_num_threads;
+    }
+    if (num_threads > steps) {
+        num_threads = steps > 0 ? steps : 1;
+    }
+
+    return num_threads;
+}
+
+void cfe_dlog_config_init(cfe_dlog_config *c) {
+    c->baby_steps = 0;
+    c->memory_budget = 0;
+    c->num_threads = 0;
+    c->algorithm = CFE_DLOG_AUTO;
+}
+
+// the size of a table of baby steps in bytes
+static size_t cfe_dlog_table_bytes(size_t baby_steps) {
+    return ((size_t) 1 << cfe_dlog_hash_log_capacity(baby_steps)) * (sizeof(uint64_t) + sizeof(uint32_t));
+}
+
+// the memory needed while a table of baby steps is built: the table itself
+// and the fingerprints of all the baby steps
+static size_t cfe_dlog_table_peak_bytes(size_t baby_steps) {
+    return cfe_dlog_table_bytes(baby_steps) + baby_steps * sizeof(uint64_t);
+}
+
+// chooses the number of baby steps m and the number of giant steps for
+// the given bound; m is sqrt(bound) + 1, unless it is given by the
+// configuration or limited by its memory budget, and the giant steps cover
+// all the solutions <= bound
+static cfe_error cfe_dlog_steps(size_t *baby_steps, size_t *giant_steps, mpz_t bound, cfe_dlog_config *c) {
+    mpz_t m, giant;
+    mpz_inits(m, giant, NULL);
+    cfe_error err = CFE_ERR_NONE;
+
+    if (c != NULL && c->baby_steps > 0) {
+        mpz_set_ui(m, c->baby_steps);
+    } else {
+        mpz_sqrt(m, bound);
+        mpz_add_ui(m, m, 1);
+
+        // the largest table within the budget has a power of two baby
+        // steps, since it is at most half full
+        if (c != NULL && c->memory_budget > 0) {
+            size_t max_m = 1;
+            while (max_m < CFE_DLOG_EMPTY / 2 && cfe_dlog_table_peak_bytes(2 * max_m) <= c->memory_budget) {
+                max_m *= 2;
+            }
+            if (mpz_cmp_ui(m, max_m) > 0) {
+                mpz_set_ui(m, max_m);
+            }
+        }
+    }
+
+    // indices of baby steps and giant steps are 32-bit integers
+    if (mpz_cmp_ui(m, CFE_DLOG_EMPTY) >= 0) {
+        err = CFE_ERR_DLOG_CALC_FAILED;
+        goto cleanup;
+    }
+    *baby_steps = mpz_get_ui(m);
+    if (c != NULL && c->memory_budget > 0 && cfe_dlog_table_peak_bytes(*baby_steps) > c->memory_budget) {
+        err = CFE_ERR_DLOG_CALC_FAILED;
+        goto cleanup;
+    }
+
+    mpz_fdiv_q(giant, bound, m);
+    mpz_add_ui(giant, giant, 1);
+    if (mpz_cmp_ui(giant, CFE_DLOG_EMPTY) >= 0) {
+        err = CFE_ERR_DLOG_CALC_FAILED;
+        goto cleanup;
+    }
+    *giant_steps = mpz_get_ui(giant);
+
+    cleanup:
+    mpz_clears(m, giant, NULL);
+
+    return err;
+}
+
+// the result of the giant steps shared by all the threads; the threads
+// stop as soon as any of them finds the solution
+typedef struct cfe_dlog_result {
+    atomic_bool found;
+    pthread_mutex_t lock;
+    mpz_ptr res;
+} cfe_dlog_result;
+
+static void cfe_dlog_result_init(cfe_dlog_result *r, mpz_t res) {
+    atomic_init(&r->found, false);
+    pthread_mutex_init(&r->lock, NULL);
+    r->res = res;
+}
 
-typedef struct bigint_hash {
-    mpz_t key;
-    mpz_t val;
-    UT_hash_handle hh;
-} bigint_hash;
+static void cfe_dlog_result_free(cfe_dlog_result *r) {
+    pthread_mutex_destroy(&r->lock);
+}
+
+static bool cfe_dlog_result_found(cfe_dlog_result *r) {
+    return atomic_load_explicit(&r->found, memory_order_relaxed);
+}
+
+// sets the result to i*m + val, negated if neg is true, unless some other
+// thread has already found the solution
+static void cfe_dlog_result_set(cfe_dlog_result *r, size_t i, size_t m, uint32_t val, bool neg) {
+    pthread_mutex_lock(&r->lock);
+    if (!atomic_load(&r->found)) {
+        mpz_set_ui(r->res, i);
+        mpz_mul_ui(r->res, r->res, m);
+        mpz_add_ui(r->res, r->res, val);
+        if (neg) {
+            mpz_neg(r->res, r->res);
+        }
+        atomic_store(&r->found, true);
+    }
+    pthread_mutex_unlock(&r->lock);
+}
+
+// sets the result to x unless some other thread has already found the
+// solution
+static void cfe_dlog_result_set_mpz(cfe_dlog_result *r, mpz_t x) {
+    pthread_mutex_lock(&r->lock);
+    if (!atomic_load(&r->found)) {
+        mpz_set(r->res, x);
+        atomic_store(&r->found, true);
+    }
+    pthread_mutex_unlock(&r->lock);
+}
+
+// the fingerprint of an element of Zp are the lowest 64 bits of its
+// Montgomery form; as elements are essentially random, collisions of
+// fingerprints are rare and are resolved by checking the candidate solution
+static uint64_t cfe_dlog_fingerprint(cfe_modctx *ctx, mp_limb_t *x) {
+    uint64_t fp = (uint64_t) x[0];
+#if GMP_NUMB_BITS < 64
+    if (ctx->n > 1) {
+        fp |= (uint64_t) x[1] << GMP_NUMB_BITS;
+    }
+#else
+    (void) ctx;
+#endif
+    return fp;
+}
+
+// a range of baby steps computed by a single thread
+typedef struct cfe_baby_steps_job {
+    cfe_dlog_table *t;
+    uint64_t *fps;
+    size_t from;
+    size_t to;
+} cfe_baby_steps_job;
+
+// a range of giant steps computed by a single thread
+typedef struct cfe_giant_steps_job {
+    cfe_dlog_table *t;
+    mpz_ptr h;
+    mpz_ptr h_neg;
+    size_t from;
+    size_t to;
+    cfe_dlog_result *r;
+} cfe_giant_steps_job;
+
+static void *cfe_baby_steps_worker(void *arg) {
+    cfe_baby_steps_job *job = (cfe_baby_steps_job *) arg;
+    cfe_dlog_table *t = job->t;
+
+    mpz_t start;
+    mpz_init(start);
+    mpz_powm_ui(start, t->g, job->from, t->p);
+    mp_limb_t *x = cfe_modctx_alloc(&t->ctx, 1);
+    cfe_modctx_set(&t->ctx, x, start);
+
+    for (size_t i = job->from; i < job->to; i++) {
+        job->fps[i] = cfe_dlog_fingerprint(&t->ctx, x);
+
+        cfe_modctx_mul(&t->ctx, x, x, t->g_mont);
+    }
+
+    free(x);
+    mpz_clear(start);
+
+    return NULL;
+}
+
+// looks up x in the table and sets val to the index i for which g^i = x;
+// every slot with a matching fingerprint is verified by computing g^i, which
+// practically only happens for the real match
+static bool cfe_dlog_table_find(cfe_dlog_table *t, mp_limb_t *x, uint32_t *val, mpz_t tmp) {
+    uint64_t fp = cfe_dlog_fingerprint(&t->ctx, x);
+    mp_limb_t y[t->ctx.n];
+
+    for (size_t slot = cfe_dlog_hash_slot(&t->T, fp); t->T.vals[slot] != CFE_DLOG_EMPTY;
+         slot = cfe_dlog_hash_next(&t->T, slot)) {
+        if (t->T.keys[slot] == fp) {
+            mpz_powm_ui(tmp, t->g, t->T.vals[slot], t->p);
+            cfe_modctx_set(&t->ctx, y, tmp);
+            if (mpn_cmp(y, x, t->ctx.n) == 0) {
+                *val = t->T.vals[slot];
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+static void *cfe_giant_steps_worker(void *arg) {
+    cfe_giant_steps_job *job = (cfe_giant_steps_job *) arg;
+    cfe_dlog_table *t = job->t;
+    size_t m = mpz_get_ui(t->m);
+    uint32_t val;
+
+    mpz_t z_from, tmp;
+    mpz_inits(z_from, tmp, NULL);
+    mp_limb_t *x = cfe_modctx_alloc(&t->ctx, 2);
+    mp_limb_t *x_neg = x + t->ctx.n;
 
-cfe_error cfe_baby_giant(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t _order, mpz_t bound) {
+    // start at h * z^from
+    mpz_powm_ui(z_from, t->z, job->from, t->p);
+    mpz_mul(tmp, job->h, z_from);
+    cfe_modctx_set(&t->ctx, x, tmp);
+    if (job->h_neg != NULL) {
+        mpz_mul(tmp, job->h_neg, z_from);
+        cfe_modctx_set(&t->ctx, x_neg, tmp);
+    }
+
+    for (size_t i = job->from; i < job->to && !cfe_dlog_result_found(job->r); i++) {
+        if (cfe_dlog_table_find(t, x, &val, tmp)) {
+            cfe_dlog_result_set(job->r, i, m, val, false);
+            break;
+        }
+
+        cfe_modctx_mul(&t->ctx, x, x, t->z_mont);
+
+        if (job->h_neg != NULL) {
+            if (cfe_dlog_table_find(t, x_neg, &val, tmp)) {
+                cfe_dlog_result_set(job->r, i, m, val, true);
+                break;
+            }
+
+            cfe_modctx_mul(&t->ctx, x_neg, x_neg, t->z_mont);
+        }
+    }
+
+    free(x);
+    mpz_clears(z_from, tmp, NULL);
+
+    return NULL;
+}
+
+static cfe_error cfe_dlog_table_build(cfe_dlog_table *t, mpz_t g, mpz_t p, mpz_t _order, mpz_t bound,
+                                      cfe_dlog_config *c) {
     if (_order == NULL && mpz_probab_prime_p(p, 20) == 0) {
         return CFE_ERR_DLOG_CALC_FAILED;
     }
 
-    mpz_t order, m, x, i, z, tmp;
-    mpz_inits(order, m, x, i, z, tmp, NULL);
-    cfe_error err = CFE_ERR_DLOG_NOT_FOUND;
+    // the steps are computed in Montgomery form, which needs an odd modulus
+    if (cfe_modctx_init(&t->ctx, p)) {
+        return CFE_ERR_DLOG_CALC_FAILED;
+    }
+
+    mpz_t order;
+    mpz_init(order);
 
     if (_order == NULL) {
         mpz_sub_ui(order, p, 1);
@@ -42,277 +393,1921 @@ cfe_error cfe_baby_giant(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t _order, mpz
         mpz_set(order, _order);
     }
 
-    if (bound != NULL) {
-        mpz_sqrt(m, bound);
-    } else {
-        mpz_sqrt(m, order);
+    size_t steps, giant_steps;
+    cfe_error err = cfe_dlog_steps(&steps, &giant_steps, bound != NULL ? bound : order, c);
+    if (err) {
+        mpz_clear(order);
+        cfe_modctx_free(&t->ctx);
+        return err;
     }
-    mpz_add_ui(m, m, 1);
 
-    mpz_set_ui(x, 1);
+    size_t num_threads = c != NULL ? c->num_threads : 0;
+    mpz_init_set(t->g, g);
+    mpz_init_set(t->p, p);
+    mpz_init_set_ui(t->m, steps);
+    mpz_init(t->z);
+    t->g_mont = cfe_modctx_alloc(&t->ctx, 2);
+    t->z_mont = t->g_mont + t->ctx.n;
+    cfe_modctx_set(&t->ctx, t->g_mont, g);
+    t->giant_steps = giant_steps;
+    t->num_threads = num_threads > 0 ? num_threads : cfe_dlog_num_threads;
 
-    // the hash table
-    bigint_hash *T = NULL;
+    // compute the fingerprints of the baby steps g^i for i < m in parallel,
+    // each thread starting at g^from
+    num_threads = cfe_dlog_threads_for(num_threads, steps);
+    uint64_t *fps = (uint64_t *) cfe_malloc(steps * sizeof(uint64_t));
+    cfe_baby_steps_job *jobs = (cfe_baby_steps_job *) cfe_malloc(num_threads * sizeof(cfe_baby_steps_job));
+    for (size_t k = 0; k < num_threads; k++) {
+        jobs[k].t = t;
+        jobs[k].fps = fps;
+        jobs[k].from = k * steps / num_threads;
+        jobs[k].to = (k + 1) * steps / num_threads;
+    }
+    cfe_run_jobs(cfe_baby_steps_worker, jobs, sizeof(cfe_baby_steps_job), num_threads);
 
-    // reusable pointer for hash table entries + a temporary variable for clearing later
-    bigint_hash *t, *u;
+    // store T[g^i] = i
+    cfe_dlog_hash_init(&t->T, steps);
+    cfe_dlog_hash_fill(&t->T, fps, steps);
 
-    for (mpz_set_ui(i, 0); mpz_cmp(i, m) < 0; mpz_add_ui(i, i, 1)) {
-        // store T[x] = i
-        // create a struct t and store the key and value
-        // the key is actually the internal contents of a mpz_t, the array and the minimal possible length
-        t = (bigint_hash *) cfe_malloc(sizeof(bigint_hash));
-        mpz_init_set(t->key, x);
-        mpz_init_set(t->val, i);
+    // z = g^(-m) is the giant step
+    mpz_invert(t->z, g, p);
+    mpz_powm(t->z, t->z, t->m, p);
+    cfe_modctx_set(&t->ctx, t->z_mont, t->z);
 
-        // the key is a pointer the the array and the length in bytes
-        HASH_ADD_KEYPTR(hh, T, t->key->_mp_d, t->key->_mp_alloc * sizeof(mp_limb_t), t);
+    free(fps);
+    free(jobs);
+    mpz_clear(order);
 
-        mpz_mul(x, x, g);
-        mpz_mod(x, x, p);
-    }
+    return CFE_ERR_NONE;
+}
 
-    mpz_invert(z, g, p);
-    mpz_powm(z, z, m, p);
+cfe_error cfe_dlog_table_init(cfe_dlog_table *t, mpz_t g, mpz_t p, mpz_t order, mpz_t bound) {
+    return cfe_dlog_table_build(t, g, p, order, bound, NULL);
+}
 
-    mpz_set(x, h);
+cfe_error cfe_dlog_table_init_with_config(cfe_dlog_table *t, mpz_t g, mpz_t p, mpz_t order, mpz_t bound,
+                                          cfe_dlog_config *c) {
+    return cfe_dlog_table_build(t, g, p, order, bound, c);
+}
 
-    for (mpz_set_ui(i, 0); mpz_cmp(i, m) < 0; mpz_add_ui(i, i, 1)) {
-        // get T[x]
-        // the value in X needs to be assigned to a temporary variable
-        // when setting a mpz_t's value, the minimal possible amount of memory will be allocated,
-        // which ensures that we get the same amount of bytes read from both arrays, which is needed for a match
-        mpz_set(tmp, x);
-        HASH_FIND(hh, T, tmp->_mp_d, tmp->_mp_alloc * sizeof(mp_limb_t), t);
+void cfe_dlog_table_free(cfe_dlog_table *t) {
+    cfe_dlog_hash_free(&t->T);
+    free(t->g_mont);
+    cfe_modctx_free(&t->ctx);
+    mpz_clears(t->g, t->p, t->m, t->z, NULL);
+}
 
-        if (t != NULL) {
-            mpz_mul(res, i, m);
-            mpz_add(res, res, t->val);
-            err = CFE_ERR_NONE;
-            break;
-        }
+// runs the giant steps for h (and h^(-1) if h_neg is not NULL) split among
+// the given number of threads
+static cfe_error cfe_dlog_table_search(mpz_t res, mpz_t h, mpz_t h_neg, cfe_dlog_table *t, size_t num_threads) {
+    size_t steps = t->giant_steps;
+    num_threads = cfe_dlog_threads_for(num_threads, steps);
+
+    cfe_dlog_result r;
+    cfe_dlog_result_init(&r, res);
 
-        mpz_mul(x, x, z);
-        mpz_mod(x, x, p);
+    cfe_giant_steps_job *jobs = (cfe_giant_steps_job *) cfe_malloc(num_threads * sizeof(cfe_giant_steps_job));
+    for (size_t k = 0; k < num_threads; k++) {
+        jobs[k].t = t;
+        jobs[k].h = h;
+        jobs[k].h_neg = h_neg;
+        jobs[k].from = k * steps / num_threads;
+        jobs[k].to = (k + 1) * steps / num_threads;
+        jobs[k].r = &r;
     }
+    cfe_run_jobs(cfe_giant_steps_worker, jobs, sizeof(cfe_giant_steps_job), num_threads);
+
+    bool found = atomic_load(&r.found);
+    free(jobs);
+    cfe_dlog_result_free(&r);
+
+    return found ? CFE_ERR_NONE : CFE_ERR_DLOG_NOT_FOUND;
+}
+
+cfe_error cfe_dlog_table_solve(mpz_t res, mpz_t h, cfe_dlog_table *t) {
+    return cfe_dlog_table_search(res, h, NULL, t, t->num_threads);
+}
+
+cfe_error cfe_dlog_table_solve_with_neg(mpz_t res, mpz_t h, cfe_dlog_table *t) {
+    mpz_t h_neg;
+    mpz_init(h_neg);
+    cfe_error err = CFE_ERR_DLOG_NOT_FOUND;
 
-    // cleanup
-    // iterate through all entries, clear the mpz_t variables, delete the entries and free their allocated memory
-    HASH_ITER(hh, T, t, u) {
-        mpz_clear(t->val);
-        mpz_clear(t->key);
-        HASH_DEL(T, t);
-        free(t);
+    // simultaneously check for solutions for positive and negative
+    // values, since g^(-x) = h is equivalent to g^x = h^(-1)
+    if (mpz_invert(h_neg, h, t->p) != 0) {
+        err = cfe_dlog_table_search(res, h, h_neg, t, t->num_threads);
     }
 
-    free(T);
-    mpz_clears(order, m, x, i, z, tmp, NULL);
+    mpz_clear(h_neg);
 
     return err;
 }
 
-// TODO: parallel version?
-cfe_error cfe_baby_giant_with_neg(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t _order, mpz_t bound) {
-    cfe_error err = cfe_baby_giant(res, h, g, p, _order, bound);
-    if (err) {
-        mpz_t g_inv;
-        mpz_init(g_inv);
-        mpz_invert(g_inv, g, p);
-        err = cfe_baby_giant(res, h, g_inv, p, _order, bound);
-        if (err == 0) {
-            mpz_neg(res, res);
+// a range of targets whose giant steps are computed together by a single
+// thread
+typedef struct cfe_giant_steps_batch_job {
+    cfe_dlog_table *t;
+    mpz_t *res;
+    cfe_error *errs;
+    mpz_t *h;
+    size_t from;
+    size_t to;
+} cfe_giant_steps_batch_job;
+
+static void *cfe_giant_steps_batch_worker(void *arg) {
+    cfe_giant_steps_batch_job *job = (cfe_giant_steps_batch_job *) arg;
+    cfe_dlog_table *t = job->t;
+    size_t m = mpz_get_ui(t->m);
+    size_t n = job->to - job->from;
+    size_t active = 0;
+    uint32_t val;
+
+    size_t limbs = t->ctx.n;
+    mpz_t tmp;
+    mpz_init(tmp);
+    mp_limb_t *x = cfe_modctx_alloc(&t->ctx, 2 * n);
+    mp_limb_t *x_neg = x + n * limbs;
+    bool *done = (bool *) cfe_malloc(n * sizeof(bool));
+
+    // g^(-x) = h is equivalent to g^x = h^(-1), so both h and h^(-1) are
+    // walked for each target
+    for (size_t k = 0; k < n; k++) {
+        cfe_modctx_set(&t->ctx, x + k * limbs, job->h[job->from + k]);
+        done[k] = mpz_invert(tmp, job->h[job->from + k], t->p) == 0;
+        if (!done[k]) {
+            cfe_modctx_set(&t->ctx, x_neg + k * limbs, tmp);
+        }
+        job->errs[job->from + k] = CFE_ERR_DLOG_NOT_FOUND;
+        if (!done[k]) {
+            active++;
+        }
+    }
+
+    for (size_t i = 0; i < t->giant_steps && active > 0; i++) {
+        for (size_t k = 0; k < n; k++) {
+            if (done[k]) {
+                continue;
+            }
+
+            bool found = cfe_dlog_table_find(t, x + k * limbs, &val, tmp);
+            bool neg = false;
+            if (!found) {
+                found = cfe_dlog_table_find(t, x_neg + k * limbs, &val, tmp);
+                neg = true;
+            }
+
+            if (found) {
+                // the target is done, independently of the others
+                mpz_ptr res = job->res[job->from + k];
+                mpz_set_ui(res, i);
+                mpz_mul_ui(res, res, m);
+                mpz_add_ui(res, res, val);
+                if (neg) {
+                    mpz_neg(res, res);
+                }
+                job->errs[job->from + k] = CFE_ERR_NONE;
+                done[k] = true;
+                active--;
+                continue;
+            }
+
+            cfe_modctx_mul(&t->ctx, x + k * limbs, x + k * limbs, t->z_mont);
+            cfe_modctx_mul(&t->ctx, x_neg + k * limbs, x_neg + k * limbs, t->z_mont);
+        }
+    }
+
+    free(x);
+    free(done);
+    mpz_clear(tmp);
+
+    return NULL;
+}
+
+// splits the targets among the threads and returns an error if any of them
+// was not solved
+static cfe_error cfe_dlog_run_batch(void *(*worker)(void *), void *jobs, size_t job_size, size_t num_jobs,
+                                    cfe_error *errs, size_t n) {
+    cfe_run_jobs(worker, jobs, job_size, num_jobs);
+
+    for (size_t k = 0; k < n; k++) {
+        if (errs[k] != CFE_ERR_NONE) {
+            return CFE_ERR_DLOG_NOT_FOUND;
         }
-        mpz_clear(g_inv);
+    }
+
+    return CFE_ERR_NONE;
+}
+
+cfe_error cfe_dlog_table_solve_batch_with_neg(mpz_t *res, cfe_error *errs, mpz_t *h, size_t n, cfe_dlog_table *t) {
+    if (n == 0) {
+        return CFE_ERR_NONE;
+    }
+
+    cfe_error *errs_all = errs != NULL ? errs : (cfe_error *) cfe_malloc(n * sizeof(cfe_error));
+    size_t num_threads = cfe_dlog_threads_for(t->num_threads, n);
+    cfe_giant_steps_batch_job *jobs =
+            (cfe_giant_steps_batch_job *) cfe_malloc(num_threads * sizeof(cfe_giant_steps_batch_job));
+    for (size_t k = 0; k < num_threads; k++) {
+        jobs[k].t = t;
+        jobs[k].res = res;
+        jobs[k].errs = errs_all;
+        jobs[k].h = h;
+        jobs[k].from = k * n / num_threads;
+        jobs[k].to = (k + 1) * n / num_threads;
+    }
+
+    cfe_error err = cfe_dlog_run_batch(cfe_giant_steps_batch_worker, jobs, sizeof(cfe_giant_steps_batch_job),
+                                       num_threads, errs_all, n);
+
+    free(jobs);
+    if (errs == NULL) {
+        free(errs_all);
     }
 
     return err;
 }
 
-void iterate(mpz_t x, mpz_t a, mpz_t b, mpz_t h, mpz_t g, mpz_t p, mpz_t n, mpz_t r) {
-    switch (mpz_mod_ui(r, x, 3)) {
-        case 0:
-            mpz_mul(x, x, x);
-            mpz_mul_ui(a, a, 2);
-            mpz_mul_ui(b, b, 2);
-            break;
-        case 1:
-            mpz_mul(x, x, g);
-            mpz_add_ui(a, a, 1);
-            break;
-        case 2:
-            mpz_mul(x, x, h);
-            mpz_add_ui(b, b, 1);
-            break;
+// the baby-step giant-step method with the table configured by c, which
+// also searches for negative solutions if neg is true
+static cfe_error cfe_baby_giant_with_config(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t order, mpz_t bound,
+                                            cfe_dlog_config *c, bool neg) {
+    // without a bound the positive search already covers the whole group
+    neg = neg && bound != NULL;
+
+    mpz_t h_neg;
+    mpz_init(h_neg);
+    if (neg && mpz_invert(h_neg, h, p) == 0) {
+        mpz_clear(h_neg);
+        return CFE_ERR_DLOG_NOT_FOUND;
+    }
+
+    // a single table is used to search for x and -x at the same time
+    cfe_dlog_table t;
+    cfe_error err = cfe_dlog_table_build(&t, g, p, order, bound, c);
+    if (err == 0) {
+        err = cfe_dlog_table_search(res, h, neg ? h_neg : NULL, &t, t.num_threads);
+        cfe_dlog_table_free(&t);
     }
-    mpz_mod(x, x, p);
-    mpz_mod(a, a, n);
-    mpz_mod(b, b, n);
+    mpz_clear(h_neg);
+
+    return err;
 }
 
-cfe_error cfe_pollard_rho(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t n) {
-    mpz_t x1, a1, b1, x2, a2, b2, r, q, t, d, n_div_d, j, h_check;
-    mpz_inits(x1, a1, b1, x2, a2, b2, r, q, t, d, n_div_d, j, h_check, NULL);
-    cfe_error err = CFE_ERR_DLOG_NOT_FOUND;
+cfe_error cfe_baby_giant_parallel(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t order, mpz_t bound,
+                                  size_t num_threads) {
+    cfe_dlog_config c;
+    cfe_dlog_config_init(&c);
+    c.num_threads = num_threads;
+
+    return cfe_baby_giant_with_config(res, h, g, p, order, bound, &c, false);
+}
 
-    mpz_set_ui(x1, 1);
-    mpz_set_ui(x2, 1);
+cfe_error cfe_baby_giant(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t order, mpz_t bound) {
+    return cfe_baby_giant_parallel(res, h, g, p, order, bound, 0);
+}
 
-    uint64_t iterations = (uint64_t) 2 << 31;
+cfe_error cfe_baby_giant_with_neg_parallel(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t _order, mpz_t bound,
+                                           size_t num_threads) {
+    cfe_dlog_config c;
+    cfe_dlog_config_init(&c);
+    c.num_threads = num_threads;
 
-    for (uint64_t i = 0; i < iterations; i++) {
-        iterate(x1, a1, b1, h, g, p, n, r);
-        iterate(x2, a2, b2, h, g, p, n, r);
-        iterate(x2, a2, b2, h, g, p, n, r);
+    return cfe_baby_giant_with_config(res, h, g, p, _order, bound, &c, true);
+}
 
-        if (mpz_cmp(x1, x2) == 0) {
-            mpz_sub(r, b2, b1);
-            mpz_mod(r, r, n);
-            mpz_sub(t, a1, a2);
-            mpz_mod(t, t, n);
+cfe_error cfe_baby_giant_with_neg(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t _order, mpz_t bound) {
+    return cfe_baby_giant_with_neg_parallel(res, h, g, p, _order, bound, 0);
+}
 
-            if (mpz_cmp_ui(r, 0) == 0) {
-                goto cleanup;
-            }
+cfe_error cfe_baby_giant_batch_with_neg(mpz_t *res, cfe_error *errs, mpz_t *h, size_t n, mpz_t g, mpz_t p,
+                                        mpz_t order, mpz_t bound) {
+    cfe_dlog_table t;
+    cfe_error err = cfe_dlog_table_init(&t, g, p, order, bound);
+    if (err) {
+        return err;
+    }
+
+    err = cfe_dlog_table_solve_batch_with_neg(res, errs, h, n, &t);
+    cfe_dlog_table_free(&t);
+
+    return err;
+}
 
-            mpz_gcd(d, r, n);
+cfe_error cfe_dlog_powm_batch_with_neg(mpz_t *res, cfe_error *errs, cfe_vec *bases, cfe_vec *exps, size_t n,
+                                       mpz_t g, mpz_t p, mpz_t order, mpz_t bound, cfe_dlog_table *t,
+                                       size_t num_threads) {
+    if (n == 0) {
+        return CFE_ERR_NONE;
+    }
 
-            // if r and n are coprime the algorithm is simple
-            if (mpz_cmp_ui(d, 1) == 0) {
-                mpz_invert(q, r, n);
-                mpz_mul(q, q, t);
-                mpz_mod(res, q, n);
-                err = CFE_ERR_NONE;
-                goto cleanup;
+    size_t threads = num_threads > 0 ? num_threads : cfe_dlog_num_threads;
+    cfe_error *pow_errs = (cfe_error *) cfe_malloc(2 * n * sizeof(cfe_error));
+    cfe_error *dlog_errs = pow_errs + n;
+    mpz_t *h = (mpz_t *) cfe_malloc(n * sizeof(mpz_t));
+    size_t *bits = (size_t *) cfe_malloc(bases->size * sizeof(size_t));
+    for (size_t i = 0; i < bases->size; i++) {
+        bits[i] = 0;
+    }
+    for (size_t k = 0; k < n; k++) {
+        mpz_init(h[k]);
+        for (size_t i = 0; i < bases->size; i++) {
+            size_t b = mpz_sizeinbase(exps[k].vec[i], 2);
+            if (b > bits[i]) {
+                bits[i] = b;
             }
+        }
+    }
 
-            // in case r and n are not coprime additional computations are needed
-            mpz_div(r, r, d);
-            mpz_div(t, t, d);
-            mpz_div(n_div_d, n, d);
-            mpz_invert(q, r, n_div_d);
-            mpz_mul(q, q, t);
-            mpz_mod(q, q, n_div_d);
-
-            for (mpz_set_ui(j, 0); mpz_cmp(j, d) < 0; mpz_add_ui(j, j, 1)) {
-                mpz_powm(h_check, g, q, p);
-
-                if (mpz_cmp(h, h_check) == 0) {
-                    mpz_set(res, q);
-                    err = CFE_ERR_NONE;
-                    goto cleanup;
-                }
+    // the tables of powers of the bases are shared by all the vectors
+    cfe_fixed_base_vec fbv;
+    cfe_fixed_base_vec_init_batch(&fbv, bases, p, bits, n);
+    cfe_fixed_base_vec_powm_batch(h, pow_errs, &fbv, exps, n, threads);
+    cfe_fixed_base_vec_free(&fbv);
+
+    // all the discrete logarithms are computed with a single table; the
+    // skipped vectors have h = 1, which is solved immediately
+    cfe_error table_err = CFE_ERR_NONE;
+    cfe_dlog_table table;
+    if (t == NULL) {
+        table_err = cfe_dlog_table_init(&table, g, p, order, bound);
+        table.num_threads = threads;
+    }
+    if (!table_err) {
+        cfe_dlog_table_solve_batch_with_neg(res, dlog_errs, h, n, t != NULL ? t : &table);
+        if (t == NULL) {
+            cfe_dlog_table_free(&table);
+        }
+    }
 
-                mpz_add(q, q, n_div_d);
+    // each vector keeps its first error
+    cfe_error err = CFE_ERR_NONE;
+    for (size_t k = 0; k < n; k++) {
+        if (errs[k] == CFE_ERR_NONE) {
+            if (table_err) {
+                errs[k] = table_err;
+            } else if (pow_errs[k]) {
+                errs[k] = CFE_ERR_MALFORMED_CIPHER;
+            } else {
+                errs[k] = dlog_errs[k];
             }
         }
+        if (!err) {
+            err = errs[k];
+        }
     }
 
-    cleanup:
-    mpz_clears(x1, a1, b1, x2, a2, b2, r, q, t, d, n_div_d, j, h_check, NULL);
+    for (size_t k = 0; k < n; k++) {
+        mpz_clear(h[k]);
+    }
+    free(h);
+    free(bits);
+    free(pow_errs);
 
     return err;
 }
 
-typedef struct BN254_hash {
-    FP12_BN254 key;
-    mpz_t val;
-    UT_hash_handle hh;
-} BN254_hash;
+// the fingerprint of a reduced element of the group FP12_BN254 are the
+// lowest 64 bits of its first coordinate in Fp; it is read directly from
+// the limbs, so the element never needs to be serialized
+static uint64_t cfe_dlog_fingerprint_FP12_BN254(FP12_BN254 *x) {
+    return (uint64_t) x->a.a.a.g[0] | ((uint64_t) x->a.a.a.g[1] << BASEBITS_256_56);
+}
+
+// a range of baby steps in the group FP12_BN254 computed by a single thread
+typedef struct cfe_baby_steps_FP12_BN254_job {
+    cfe_dlog_table_FP12_BN254 *t;
+    uint64_t *fps;
+    size_t from;
+    size_t to;
+} cfe_baby_steps_FP12_BN254_job;
 
-cfe_error cfe_baby_giant_FP12_BN256_with_neg(mpz_t res, FP12_BN254 *h, FP12_BN254 *g, mpz_t bound) {
-    // zero check
-    FP12_BN254 pow_zero;
-    FP12_BN254_one(&pow_zero);
-    if (FP12_BN254_equals(h, &pow_zero) == 1) {
-        mpz_set_si(res, 0);
-        return CFE_ERR_NONE;
+// a range of giant steps in the group FP12_BN254 computed by a single thread
+typedef struct cfe_giant_steps_FP12_BN254_job {
+    cfe_dlog_table_FP12_BN254 *t;
+    FP12_BN254 *h;
+    FP12_BN254 *h_neg;
+    size_t from;
+    size_t to;
+    cfe_dlog_result *r;
+} cfe_giant_steps_FP12_BN254_job;
+
+// sets x = g^e for an exponent e < 2^32, which fits into the lowest chunk
+static void cfe_dlog_pow_FP12_BN254(FP12_BN254 *x, FP12_BN254 *g, size_t e) {
+    BIG_256_56 e_b;
+    BIG_256_56_zero(e_b);
+    e_b[0] = (chunk) e;
+    FP12_BN254_pow(x, g, e_b);
+    FP12_BN254_reduce(x);
+}
+
+static void *cfe_baby_steps_FP12_BN254_worker(void *arg) {
+    cfe_baby_steps_FP12_BN254_job *job = (cfe_baby_steps_FP12_BN254_job *) arg;
+    cfe_dlog_table_FP12_BN254 *t = job->t;
+
+    FP12_BN254 x;
+    cfe_dlog_pow_FP12_BN254(&x, &t->g, job->from);
+
+    for (size_t i = job->from; i < job->to; i++) {
+        job->fps[i] = cfe_dlog_fingerprint_FP12_BN254(&x);
+
+        FP12_BN254_mul(&x, &t->g);
+        FP12_BN254_reduce(&x);
     }
 
-    mpz_t m, i;
-    mpz_inits(m, i, NULL);
-    FP12_BN254 x, x_neg, z;
-    cfe_error err = CFE_ERR_DLOG_NOT_FOUND;
+    return NULL;
+}
 
-    mpz_sqrt(m, bound);
-    mpz_add_ui(m, m, 1);
+// looks up a reduced element x in the table and sets val to the index i
+// for which g^i = x; matching fingerprints are verified by computing g^i
+static bool cfe_dlog_table_FP12_BN254_find(cfe_dlog_table_FP12_BN254 *t, FP12_BN254 *x, uint32_t *val) {
+    uint64_t fp = cfe_dlog_fingerprint_FP12_BN254(x);
+    FP12_BN254 tmp;
 
-    // the hash table
-    BN254_hash *T = NULL;
+    for (size_t slot = cfe_dlog_hash_slot(&t->T, fp); t->T.vals[slot] != CFE_DLOG_EMPTY;
+         slot = cfe_dlog_hash_next(&t->T, slot)) {
+        if (t->T.keys[slot] == fp) {
+            cfe_dlog_pow_FP12_BN254(&tmp, &t->g, t->T.vals[slot]);
+            if (FP12_BN254_equals(&tmp, x) == 1) {
+                *val = t->T.vals[slot];
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
 
-    // reusable pointer for hash table entries + a temporary variable for clearing later
-    BN254_hash *t, *u;
-    // elements of the elliptic curve can be represented as so called octets
-    octet oct;
-    oct.val = cfe_malloc(12 * MODBYTES_256_56 * sizeof(char));
+static void *cfe_giant_steps_FP12_BN254_worker(void *arg) {
+    cfe_giant_steps_FP12_BN254_job *job = (cfe_giant_steps_FP12_BN254_job *) arg;
+    cfe_dlog_table_FP12_BN254 *t = job->t;
+    uint32_t val;
 
-    FP12_BN254_one(&x);
+    // start at h * z^from
+    FP12_BN254 x, x_neg, z_from;
+    cfe_dlog_pow_FP12_BN254(&z_from, &t->z, job->from);
+    FP12_BN254_copy(&x, job->h);
+    FP12_BN254_mul(&x, &z_from);
     FP12_BN254_reduce(&x);
-    for (mpz_set_ui(i, 0); mpz_cmp(i, m) <= 0; mpz_add_ui(i, i, 1)) {
-        // store T[x] = i
-        // create a struct t and store the key and value
-        // the key is a string obtained from the the element of the
-        // elliptic curve and the minimal possible length
-        t = (BN254_hash *) cfe_malloc(sizeof(BN254_hash));
-        FP12_BN254_copy(&(t->key), &x);
-        mpz_init_set(t->val, i);
-        FP12_BN254_toOctet(&oct, &x);
-        // the key is a pointer to the string in octet
-        HASH_ADD_KEYPTR(hh, T, oct.val, oct.len * sizeof(char), t);
-
-        FP12_BN254_mul(&x, g);
-        FP12_BN254_reduce(&x);
+    if (job->h_neg != NULL) {
+        FP12_BN254_copy(&x_neg, job->h_neg);
+        FP12_BN254_mul(&x_neg, &z_from);
+        FP12_BN254_reduce(&x_neg);
     }
 
-    // simultaneously check for solutions for positive and negative
-    // values
-    FP12_BN254_inv(&z, g);
-    BIG_256_56 m_b;
-    BIG_256_56_from_mpz(m_b, m);
-    FP12_BN254_pow(&z, &z, m_b);
-    FP12_BN254_copy(&x, h);
-    FP12_BN254_inv(&x_neg, h);
-
-    for (mpz_set_ui(i, 0); mpz_cmp(i, m) <= 0; mpz_add_ui(i, i, 1)) {
-        // get T[x]
-        // the value in x needs to be assigned to a temporary variable
-        FP12_BN254_toOctet(&oct, &x);
-        HASH_FIND(hh, T, oct.val, oct.len * sizeof(char), t);
-
-        if (t != NULL) {
-            mpz_mul(res, i, m);
-            mpz_add(res, res, t->val);
-            err = CFE_ERR_NONE;
+    for (size_t i = job->from; i < job->to && !cfe_dlog_result_found(job->r); i++) {
+        if (cfe_dlog_table_FP12_BN254_find(t, &x, &val)) {
+            cfe_dlog_result_set(job->r, i, t->m, val, false);
             break;
         }
 
-        FP12_BN254_mul(&x, &z);
+        FP12_BN254_mul(&x, &t->z);
         FP12_BN254_reduce(&x);
 
-        FP12_BN254_toOctet(&oct, &x_neg);
-        HASH_FIND(hh, T, oct.val, oct.len * sizeof(char), t);
+        if (job->h_neg != NULL) {
+            if (cfe_dlog_table_FP12_BN254_find(t, &x_neg, &val)) {
+                cfe_dlog_result_set(job->r, i, t->m, val, true);
+                break;
+            }
 
-        if (t != NULL) {
-            mpz_mul(res, i, m);
-            mpz_add(res, res, t->val);
-            mpz_neg(res, res);
-            err = CFE_ERR_NONE;
-            break;
+            FP12_BN254_mul(&x_neg, &t->z);
+            FP12_BN254_reduce(&x_neg);
         }
+    }
 
-        FP12_BN254_mul(&x_neg, &z);
-        FP12_BN254_reduce(&x_neg);
+    return NULL;
+}
+
+// sets the generator, bound, number of steps and giant step of the table,
+// but not the baby steps themselves
+static cfe_error cfe_dlog_table_FP12_BN254_setup(cfe_dlog_table_FP12_BN254 *t, FP12_BN254 *g, mpz_t bound,
+                                                 cfe_dlog_config *c) {
+    cfe_error err = cfe_dlog_steps(&t->m, &t->giant_steps, bound, c);
+    if (err) {
+        return err;
     }
 
-    // cleanup
-    // iterate through all entries, clear the mpz_t variables, delete the entries and free their allocated memory
-    HASH_ITER(hh, T, t, u) {
-        mpz_clear(t->val);
-        HASH_DEL(T, t);
-        free(t);
+    t->num_threads = c != NULL && c->num_threads > 0 ? c->num_threads : cfe_dlog_num_threads;
+    t->map = NULL;
+    t->map_len = 0;
+    mpz_init_set(t->bound, bound);
+    FP12_BN254_copy(&t->g, g);
+    FP12_BN254_reduce(&t->g);
+
+    // z = g^(-m) is the giant step
+    FP12_BN254 g_inv;
+    FP12_BN254_inv(&g_inv, &t->g);
+    cfe_dlog_pow_FP12_BN254(&t->z, &g_inv, t->m);
+
+    return CFE_ERR_NONE;
+}
+
+cfe_error cfe_dlog_table_FP12_BN254_init(cfe_dlog_table_FP12_BN254 *t, FP12_BN254 *g, mpz_t bound) {
+    return cfe_dlog_table_FP12_BN254_init_with_config(t, g, bound, NULL);
+}
+
+cfe_error cfe_dlog_table_FP12_BN254_init_with_config(cfe_dlog_table_FP12_BN254 *t, FP12_BN254 *g, mpz_t bound,
+                                                     cfe_dlog_config *c) {
+    cfe_error err = cfe_dlog_table_FP12_BN254_setup(t, g, bound, c);
+    if (err) {
+        return err;
     }
 
-    free(T);
-    mpz_clears(m, i, NULL);
-    free(oct.val);
-    return err;
+    // compute the fingerprints of the baby steps g^i for i < m in parallel,
+    // each thread starting at g^from
+    size_t num_threads = cfe_dlog_threads_for(t->num_threads, t->m);
+    uint64_t *fps = (uint64_t *) cfe_malloc(t->m * sizeof(uint64_t));
+    cfe_baby_steps_FP12_BN254_job *jobs =
+            (cfe_baby_steps_FP12_BN254_job *) cfe_malloc(num_threads * sizeof(cfe_baby_steps_FP12_BN254_job));
+    for (size_t k = 0; k < num_threads; k++) {
+        jobs[k].t = t;
+        jobs[k].fps = fps;
+        jobs[k].from = k * t->m / num_threads;
+        jobs[k].to = (k + 1) * t->m / num_threads;
+    }
+    cfe_run_jobs(cfe_baby_steps_FP12_BN254_worker, jobs, sizeof(cfe_baby_steps_FP12_BN254_job), num_threads);
+
+    // store T[g^i] = i
+    cfe_dlog_hash_init(&t->T, t->m);
+    cfe_dlog_hash_fill(&t->T, fps, t->m);
+
+    free(fps);
+    free(jobs);
+
+    return CFE_ERR_NONE;
+}
+
+void cfe_dlog_table_FP12_BN254_free(cfe_dlog_table_FP12_BN254 *t) {
+    if (t->map != NULL) {
+        munmap(t->map, t->map_len);
+    } else {
+        cfe_dlog_hash_free(&t->T);
+    }
+    mpz_clear(t->bound);
+}
+
+// the header of a file holding a table of baby steps in the group
+// FP12_BN254; it is followed by the fingerprints and then by the indices
+// of all the slots of the table, all in the byte order of the machine
+// which wrote the file
+typedef struct cfe_dlog_table_file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t log_capacity;
+    uint64_t m;
+    unsigned char bound[CFE_DLOG_TABLE_BOUND_BYTES]; // big-endian
+    unsigned char g[CFE_DLOG_TABLE_G_BYTES]; // FP12_BN254_toOctet of g
+} cfe_dlog_table_file_header;
+
+static const char cfe_dlog_table_magic[8] = "CFEDLOG";
+
+// fills the header for the given generator and bound
+static cfe_error cfe_dlog_table_file_header_set(cfe_dlog_table_file_header *hdr, FP12_BN254 *g, mpz_t bound,
+                                                size_t m, size_t log_capacity) {
+    if (mpz_sgn(bound) < 0 || mpz_sizeinbase(bound, 256) > CFE_DLOG_TABLE_BOUND_BYTES) {
+        return CFE_ERR_MALFORMED_INPUT;
+    }
+
+    memset(hdr, 0, sizeof(cfe_dlog_table_file_header));
+    memcpy(hdr->magic, cfe_dlog_table_magic, sizeof(hdr->magic));
+    hdr->version = CFE_DLOG_TABLE_VERSION;
+    hdr->log_capacity = (uint32_t) log_capacity;
+    hdr->m = m;
+
+    size_t count;
+    size_t bound_len = (mpz_sizeinbase(bound, 2) + 7) / 8;
+    mpz_export(hdr->bound + CFE_DLOG_TABLE_BOUND_BYTES - bound_len, &count, 1, 1, 1, 0, bound);
+
+    FP12_BN254 g_red;
+    FP12_BN254_copy(&g_red, g);
+    FP12_BN254_reduce(&g_red);
+    octet oct = {0, CFE_DLOG_TABLE_G_BYTES, (char *) hdr->g};
+    FP12_BN254_toOctet(&oct, &g_red);
+
+    return CFE_ERR_NONE;
+}
+
+cfe_error cfe_dlog_table_FP12_BN254_save(cfe_dlog_table_FP12_BN254 *t, const char *path) {
+    cfe_dlog_table_file_header hdr;
+    cfe_error err = cfe_dlog_table_file_header_set(&hdr, &t->g, t->bound, t->m, t->T.log_capacity);
+    if (err) {
+        return err;
+    }
+
+    // the table is written to a temporary file which then replaces the
+    // file, since other processes might have the file mapped
+    size_t path_len = strlen(path);
+    char *tmp_path = (char *) cfe_malloc(path_len + 5);
+    memcpy(tmp_path, path, path_len);
+    memcpy(tmp_path + path_len, ".tmp", 5);
+
+    FILE *f = fopen(tmp_path, "wb");
+    if (f == NULL) {
+        free(tmp_path);
+        return CFE_ERR_INIT;
+    }
+
+    size_t capacity = (size_t) 1 << t->T.log_capacity;
+    if (fwrite(&hdr, sizeof(hdr), 1, f) != 1 ||
+        fwrite(t->T.keys, sizeof(uint64_t), capacity, f) != capacity ||
+        fwrite(t->T.vals, sizeof(uint32_t), capacity, f) != capacity ||
+        fflush(f) != 0 || fsync(fileno(f)) != 0) {
+        err = CFE_ERR_INIT;
+    }
+
+    if (fclose(f) != 0) {
+        err = CFE_ERR_INIT;
+    }
+    if (err || rename(tmp_path, path) != 0) {
+        remove(tmp_path);
+        err = CFE_ERR_INIT;
+    }
+
+    free(tmp_path);
+    return err;
+}
+
+cfe_error cfe_dlog_table_FP12_BN254_load(cfe_dlog_table_FP12_BN254 *t, const char *path, FP12_BN254 *g,
+                                         mpz_t bound) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return CFE_ERR_INIT;
+    }
+
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t) st.st_size >= sizeof(cfe_dlog_table_file_header)) {
+        map = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    // the mapping stays valid after the file is closed
+    close(fd);
+    if (map == MAP_FAILED) {
+        return CFE_ERR_INIT;
+    }
+
+    // the number of baby steps is taken from the file; a value of 0 gives
+    // the default number, which is then checked against the header as well
+    cfe_dlog_table_file_header *hdr = (cfe_dlog_table_file_header *) map;
+    cfe_dlog_config c;
+    cfe_dlog_config_init(&c);
+    c.baby_steps = hdr->m < CFE_DLOG_EMPTY ? (size_t) hdr->m : CFE_DLOG_EMPTY;
+    cfe_error err = cfe_dlog_table_FP12_BN254_setup(t, g, bound, &c);
+    if (err) {
+        munmap(map, (size_t) st.st_size);
+        return err == CFE_ERR_DLOG_CALC_FAILED ? CFE_ERR_MALFORMED_INPUT : err;
+    }
+
+    // the file must have been generated for the same generator and bound,
+    // and its size must match the size of the table
+    cfe_dlog_table_file_header expected;
+    size_t log_capacity = cfe_dlog_hash_log_capacity(t->m);
+    size_t capacity = (size_t) 1 << log_capacity;
+    err = cfe_dlog_table_file_header_set(&expected, &t->g, bound, t->m, log_capacity);
+    if (err == CFE_ERR_NONE && (memcmp(hdr, &expected, sizeof(expected)) != 0 ||
+        (size_t) st.st_size != sizeof(expected) + capacity * (sizeof(uint64_t) + sizeof(uint32_t)))) {
+        err = CFE_ERR_MALFORMED_INPUT;
+    }
+    if (err) {
+        munmap(map, (size_t) st.st_size);
+        mpz_clear(t->bound);
+        return err;
+    }
+
+    t->T.log_capacity = log_capacity;
+    t->T.keys = (uint64_t *) ((char *) map + sizeof(cfe_dlog_table_file_header));
+    t->T.vals = (uint32_t *) (t->T.keys + capacity);
+    if (!cfe_dlog_hash_valid(&t->T, t->m)) {
+        munmap(map, (size_t) st.st_size);
+        mpz_clear(t->bound);
+        return CFE_ERR_MALFORMED_INPUT;
+    }
+
+    t->map = map;
+    t->map_len = (size_t) st.st_size;
+
+    return CFE_ERR_NONE;
+}
+
+cfe_error cfe_dlog_table_FP12_BN254_solve_with_neg(mpz_t res, FP12_BN254 *h, cfe_dlog_table_FP12_BN254 *t) {
+    size_t num_threads = cfe_dlog_threads_for(t->num_threads, t->giant_steps);
+
+    // simultaneously check for solutions for positive and negative
+    // values, since g^(-x) = h is equivalent to g^x = h^(-1)
+    FP12_BN254 h_neg;
+    FP12_BN254_inv(&h_neg, h);
+    FP12_BN254_reduce(&h_neg);
+
+    cfe_dlog_result r;
+    cfe_dlog_result_init(&r, res);
+
+    cfe_giant_steps_FP12_BN254_job *jobs =
+            (cfe_giant_steps_FP12_BN254_job *) cfe_malloc(num_threads * sizeof(cfe_giant_steps_FP12_BN254_job));
+    for (size_t k = 0; k < num_threads; k++) {
+        jobs[k].t = t;
+        jobs[k].h = h;
+        jobs[k].h_neg = &h_neg;
+        jobs[k].from = k * t->giant_steps / num_threads;
+        jobs[k].to = (k + 1) * t->giant_steps / num_threads;
+        jobs[k].r = &r;
+    }
+    cfe_run_jobs(cfe_giant_steps_FP12_BN254_worker, jobs, sizeof(cfe_giant_steps_FP12_BN254_job), num_threads);
+
+    bool found = atomic_load(&r.found);
+    free(jobs);
+    cfe_dlog_result_free(&r);
+
+    return found ? CFE_ERR_NONE : CFE_ERR_DLOG_NOT_FOUND;
+}
+
+cfe_error cfe_baby_giant_FP12_BN256_with_neg(mpz_t res, FP12_BN254 *h, FP12_BN254 *g, mpz_t bound) {
+    cfe_dlog_table_FP12_BN254 t;
+    cfe_error err = cfe_dlog_table_FP12_BN254_init(&t, g, bound);
+    if (err) {
+        return err;
+    }
+
+    err = cfe_dlog_table_FP12_BN254_solve_with_neg(res, h, &t);
+    cfe_dlog_table_FP12_BN254_free(&t);
+
+    return err;
+}
+
+// a range of targets in the group FP12_BN254 whose giant steps are
+// computed together by a single thread
+typedef struct cfe_giant_steps_FP12_BN254_batch_job {
+    cfe_dlog_table_FP12_BN254 *t;
+    mpz_t *res;
+    cfe_error *errs;
+    FP12_BN254 *h;
+    size_t from;
+    size_t to;
+} cfe_giant_steps_FP12_BN254_batch_job;
+
+static void *cfe_giant_steps_FP12_BN254_batch_worker(void *arg) {
+    cfe_giant_steps_FP12_BN254_batch_job *job = (cfe_giant_steps_FP12_BN254_batch_job *) arg;
+    cfe_dlog_table_FP12_BN254 *t = job->t;
+    size_t n = job->to - job->from;
+    size_t active = n;
+    uint32_t val;
+
+    FP12_BN254 *x = (FP12_BN254 *) cfe_malloc(2 * n * sizeof(FP12_BN254));
+    FP12_BN254 *x_neg = x + n;
+    bool *done = (bool *) cfe_malloc(n * sizeof(bool));
+
+    // g^(-x) = h is equivalent to g^x = h^(-1), so both h and h^(-1) are
+    // walked for each target
+    for (size_t k = 0; k < n; k++) {
+        FP12_BN254_copy(&x[k], &job->h[job->from + k]);
+        FP12_BN254_reduce(&x[k]);
+        FP12_BN254_inv(&x_neg[k], &x[k]);
+        FP12_BN254_reduce(&x_neg[k]);
+        done[k] = false;
+        job->errs[job->from + k] = CFE_ERR_DLOG_NOT_FOUND;
+    }
+
+    for (size_t i = 0; i < t->giant_steps && active > 0; i++) {
+        for (size_t k = 0; k < n; k++) {
+            if (done[k]) {
+                continue;
+            }
+
+            bool found = cfe_dlog_table_FP12_BN254_find(t, &x[k], &val);
+            bool neg = false;
+            if (!found) {
+                found = cfe_dlog_table_FP12_BN254_find(t, &x_neg[k], &val);
+                neg = true;
+            }
+
+            if (found) {
+                // the target is done, independently of the others
+                mpz_ptr res = job->res[job->from + k];
+                mpz_set_ui(res, i);
+                mpz_mul_ui(res, res, t->m);
+                mpz_add_ui(res, res, val);
+                if (neg) {
+                    mpz_neg(res, res);
+                }
+                job->errs[job->from + k] = CFE_ERR_NONE;
+                done[k] = true;
+                active--;
+                continue;
+            }
+
+            FP12_BN254_mul(&x[k], &t->z);
+            FP12_BN254_reduce(&x[k]);
+            FP12_BN254_mul(&x_neg[k], &t->z);
+            FP12_BN254_reduce(&x_neg[k]);
+        }
+    }
+
+    free(x);
+    free(done);
+
+    return NULL;
+}
+
+cfe_error cfe_dlog_table_FP12_BN254_solve_batch_with_neg(mpz_t *res, cfe_error *errs, FP12_BN254 *h, size_t n,
+                                                         cfe_dlog_table_FP12_BN254 *t) {
+    if (n == 0) {
+        return CFE_ERR_NONE;
+    }
+
+    cfe_error *errs_all = errs != NULL ? errs : (cfe_error *) cfe_malloc(n * sizeof(cfe_error));
+    size_t num_threads = cfe_dlog_threads_for(t->num_threads, n);
+    cfe_giant_steps_FP12_BN254_batch_job *jobs = (cfe_giant_steps_FP12_BN254_batch_job *)
+            cfe_malloc(num_threads * sizeof(cfe_giant_steps_FP12_BN254_batch_job));
+    for (size_t k = 0; k < num_threads; k++) {
+        jobs[k].t = t;
+        jobs[k].res = res;
+        jobs[k].errs = errs_all;
+        jobs[k].h = h;
+        jobs[k].from = k * n / num_threads;
+        jobs[k].to = (k + 1) * n / num_threads;
+    }
+
+    cfe_error err = cfe_dlog_run_batch(cfe_giant_steps_FP12_BN254_batch_worker, jobs,
+                                       sizeof(cfe_giant_steps_FP12_BN254_batch_job), num_threads, errs_all, n);
+
+    free(jobs);
+    if (errs == NULL) {
+        free(errs_all);
+    }
+
+    return err;
+}
+
+cfe_error cfe_baby_giant_FP12_BN256_batch_with_neg(mpz_t *res, cfe_error *errs, FP12_BN254 *h, size_t n,
+                                                   FP12_BN254 *g, mpz_t bound) {
+    cfe_dlog_table_FP12_BN254 t;
+    cfe_error err = cfe_dlog_table_FP12_BN254_init(&t, g, bound);
+    if (err) {
+        return err;
+    }
+
+    err = cfe_dlog_table_FP12_BN254_solve_batch_with_neg(res, errs, h, n, &t);
+    cfe_dlog_table_FP12_BN254_free(&t);
+
+    return err;
+}
+
+// the fingerprint of a point of the group ECP_BN254 in affine coordinates
+// are the lowest 64 bits of its x coordinate, which is shared by the points
+// x and -x; like for FP12_BN254 it is read directly from the limbs
+static uint64_t cfe_dlog_fingerprint_ECP_BN254(ECP_BN254 *x) {
+    ECP_BN254_affine(x);
+    return (uint64_t) x->x.g[0] | ((uint64_t) x->x.g[1] << BASEBITS_256_56);
+}
+
+// a range of baby steps in the group ECP_BN254 computed by a single thread
+typedef struct cfe_baby_steps_ECP_BN254_job {
+    cfe_dlog_table_ECP_BN254 *t;
+    uint64_t *fps;
+    size_t from;
+    size_t to;
+} cfe_baby_steps_ECP_BN254_job;
+
+// a range of giant steps in the group ECP_BN254 computed by a single thread
+typedef struct cfe_giant_steps_ECP_BN254_job {
+    cfe_dlog_table_ECP_BN254 *t;
+    ECP_BN254 *h;
+    size_t from;
+    size_t to;
+    cfe_dlog_result *r;
+} cfe_giant_steps_ECP_BN254_job;
+
+// sets x = e*g for a multiplier e < 2^32, which fits into the lowest chunk
+static void cfe_dlog_mul_ECP_BN254(ECP_BN254 *x, ECP_BN254 *g, size_t e) {
+    BIG_256_56 e_b;
+    BIG_256_56_zero(e_b);
+    e_b[0] = (chunk) e;
+    ECP_BN254_copy(x, g);
+    ECP_BN254_mul(x, e_b);
+}
+
+static void *cfe_baby_steps_ECP_BN254_worker(void *arg) {
+    cfe_baby_steps_ECP_BN254_job *job = (cfe_baby_steps_ECP_BN254_job *) arg;
+    cfe_dlog_table_ECP_BN254 *t = job->t;
+
+    ECP_BN254 x;
+    cfe_dlog_mul_ECP_BN254(&x, &t->g, job->from);
+
+    for (size_t i = job->from; i < job->to; i++) {
+        job->fps[i] = cfe_dlog_fingerprint_ECP_BN254(&x);
+        ECP_BN254_add(&x, &t->g);
+    }
+
+    return NULL;
+}
+
+// looks up a point x in the table and sets val to the index i for which
+// i*g = x, or i*g = -x if neg is set to true; matching fingerprints are
+// verified by computing i*g
+static bool cfe_dlog_table_ECP_BN254_find(cfe_dlog_table_ECP_BN254 *t, ECP_BN254 *x, uint32_t *val, bool *neg) {
+    uint64_t fp = cfe_dlog_fingerprint_ECP_BN254(x);
+    ECP_BN254 tmp;
+
+    for (size_t slot = cfe_dlog_hash_slot(&t->T, fp); t->T.vals[slot] != CFE_DLOG_EMPTY;
+         slot = cfe_dlog_hash_next(&t->T, slot)) {
+        if (t->T.keys[slot] == fp) {
+            cfe_dlog_mul_ECP_BN254(&tmp, &t->g, t->T.vals[slot]);
+            *neg = ECP_BN254_equals(&tmp, x) != 1;
+            if (*neg) {
+                ECP_BN254_neg(&tmp);
+            }
+            if (ECP_BN254_equals(&tmp, x) == 1) {
+                *val = t->T.vals[slot];
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// sets the result to -i*(2m - 1) or i*(2m - 1), depending on the direction
+// of the giant step, plus or minus the baby step val
+static void cfe_dlog_result_set_ECP_BN254(cfe_dlog_result *r, size_t i, size_t m, uint32_t val, bool giant_neg,
+                                          bool baby_neg) {
+    mpz_t x;
+    mpz_init_set_ui(x, i);
+    mpz_mul_ui(x, x, 2 * m - 1);
+    if (giant_neg) {
+        mpz_neg(x, x);
+    }
+    if (baby_neg) {
+        mpz_sub_ui(x, x, val);
+    } else {
+        mpz_add_ui(x, x, val);
+    }
+    cfe_dlog_result_set_mpz(r, x);
+    mpz_clear(x);
+}
+
+static void *cfe_giant_steps_ECP_BN254_worker(void *arg) {
+    cfe_giant_steps_ECP_BN254_job *job = (cfe_giant_steps_ECP_BN254_job *) arg;
+    cfe_dlog_table_ECP_BN254 *t = job->t;
+    uint32_t val;
+    bool neg;
+
+    // start at h + from*z and h - from*z, walking away from h in both
+    // directions
+    ECP_BN254 x, x_neg, z_from;
+    cfe_dlog_mul_ECP_BN254(&z_from, &t->z, job->from);
+    ECP_BN254_copy(&x, job->h);
+    ECP_BN254_add(&x, &z_from);
+    ECP_BN254_copy(&x_neg, job->h);
+    ECP_BN254_sub(&x_neg, &z_from);
+
+    for (size_t i = job->from; i < job->to && !cfe_dlog_result_found(job->r); i++) {
+        if (cfe_dlog_table_ECP_BN254_find(t, &x, &val, &neg)) {
+            cfe_dlog_result_set_ECP_BN254(job->r, i, t->m, val, false, neg);
+            break;
+        }
+        ECP_BN254_add(&x, &t->z);
+
+        // the first step in both directions is h itself
+        if (i > 0 && cfe_dlog_table_ECP_BN254_find(t, &x_neg, &val, &neg)) {
+            cfe_dlog_result_set_ECP_BN254(job->r, i, t->m, val, true, neg);
+            break;
+        }
+        ECP_BN254_sub(&x_neg, &t->z);
+    }
+
+    return NULL;
+}
+
+cfe_error cfe_dlog_table_ECP_BN254_init(cfe_dlog_table_ECP_BN254 *t, ECP_BN254 *g, mpz_t bound) {
+    return cfe_dlog_table_ECP_BN254_init_with_config(t, g, bound, NULL);
+}
+
+cfe_error cfe_dlog_table_ECP_BN254_init_with_config(cfe_dlog_table_ECP_BN254 *t, ECP_BN254 *g, mpz_t bound,
+                                                    cfe_dlog_config *c) {
+    size_t giant_steps;
+    cfe_error err = cfe_dlog_steps(&t->m, &giant_steps, bound, c);
+    if (err) {
+        return err;
+    }
+
+    // the baby steps cover (-m, m), so giant steps of 2m - 1 in both
+    // directions need to reach bound: (giant_steps - 1)*(2m - 1) + m - 1
+    // has to be at least bound
+    mpz_t giant;
+    mpz_init_set(giant, bound);
+    mpz_add_ui(giant, giant, t->m - 1);
+    mpz_fdiv_q_ui(giant, giant, 2 * t->m - 1);
+    mpz_add_ui(giant, giant, 1);
+    if (mpz_cmp_ui(giant, CFE_DLOG_EMPTY) >= 0) {
+        mpz_clear(giant);
+        return CFE_ERR_DLOG_CALC_FAILED;
+    }
+    t->giant_steps = mpz_get_ui(giant);
+    mpz_clear(giant);
+
+    t->num_threads = c != NULL && c->num_threads > 0 ? c->num_threads : cfe_dlog_num_threads;
+    mpz_init_set(t->bound, bound);
+    ECP_BN254_copy(&t->g, g);
+
+    // z = -(2m - 1)*g is the giant step
+    cfe_dlog_mul_ECP_BN254(&t->z, &t->g, 2 * t->m - 1);
+    ECP_BN254_neg(&t->z);
+
+    // compute the fingerprints of the baby steps i*g for i < m in parallel,
+    // each thread starting at from*g
+    size_t num_threads = cfe_dlog_threads_for(t->num_threads, t->m);
+    uint64_t *fps = (uint64_t *) cfe_malloc(t->m * sizeof(uint64_t));
+    cfe_baby_steps_ECP_BN254_job *jobs =
+            (cfe_baby_steps_ECP_BN254_job *) cfe_malloc(num_threads * sizeof(cfe_baby_steps_ECP_BN254_job));
+    for (size_t k = 0; k < num_threads; k++) {
+        jobs[k].t = t;
+        jobs[k].fps = fps;
+        jobs[k].from = k * t->m / num_threads;
+        jobs[k].to = (k + 1) * t->m / num_threads;
+    }
+    cfe_run_jobs(cfe_baby_steps_ECP_BN254_worker, jobs, sizeof(cfe_baby_steps_ECP_BN254_job), num_threads);
+
+    // store T[i*g] = i
+    cfe_dlog_hash_init(&t->T, t->m);
+    cfe_dlog_hash_fill(&t->T, fps, t->m);
+
+    free(fps);
+    free(jobs);
+
+    return CFE_ERR_NONE;
+}
+
+void cfe_dlog_table_ECP_BN254_free(cfe_dlog_table_ECP_BN254 *t) {
+    cfe_dlog_hash_free(&t->T);
+    mpz_clear(t->bound);
+}
+
+cfe_error cfe_dlog_table_ECP_BN254_solve_with_neg(mpz_t res, ECP_BN254 *h, cfe_dlog_table_ECP_BN254 *t) {
+    size_t num_threads = cfe_dlog_threads_for(t->num_threads, t->giant_steps);
+
+    cfe_dlog_result r;
+    cfe_dlog_result_init(&r, res);
+
+    cfe_giant_steps_ECP_BN254_job *jobs =
+            (cfe_giant_steps_ECP_BN254_job *) cfe_malloc(num_threads * sizeof(cfe_giant_steps_ECP_BN254_job));
+    for (size_t k = 0; k < num_threads; k++) {
+        jobs[k].t = t;
+        jobs[k].h = h;
+        jobs[k].from = k * t->giant_steps / num_threads;
+        jobs[k].to = (k + 1) * t->giant_steps / num_threads;
+        jobs[k].r = &r;
+    }
+    cfe_run_jobs(cfe_giant_steps_ECP_BN254_worker, jobs, sizeof(cfe_giant_steps_ECP_BN254_job), num_threads);
+
+    bool found = atomic_load(&r.found);
+    free(jobs);
+    cfe_dlog_result_free(&r);
+
+    return found ? CFE_ERR_NONE : CFE_ERR_DLOG_NOT_FOUND;
+}
+
+cfe_error cfe_baby_giant_ECP_BN254_with_neg(mpz_t res, ECP_BN254 *h, ECP_BN254 *g, mpz_t bound) {
+    cfe_dlog_table_ECP_BN254 t;
+    cfe_error err = cfe_dlog_table_ECP_BN254_init(&t, g, bound);
+    if (err) {
+        return err;
+    }
+
+    err = cfe_dlog_table_ECP_BN254_solve_with_neg(res, h, &t);
+    cfe_dlog_table_ECP_BN254_free(&t);
+
+    return err;
+}
+
+// a distinguished point reached by a walk in the kangaroo or rho method;
+// the element itself is represented only by its fingerprint, and the walk
+// by its type and the exponents a and b of the element
+typedef struct cfe_dlog_dp {
+    uint64_t fp;
+    mpz_t a;
+    mpz_t b;
+    uint8_t type; // 0 for an empty slot
+} cfe_dlog_dp;
+
+// an open addressing hash table of distinguished points shared by threads
+typedef struct cfe_dlog_dps {
+    cfe_dlog_dp *dps;
+    size_t log_capacity;
+    size_t count;
+    pthread_mutex_t lock;
+} cfe_dlog_dps;
+
+static void cfe_dlog_dps_alloc(cfe_dlog_dps *D, size_t log_capacity) {
+    D->log_capacity = log_capacity;
+    D->dps = (cfe_dlog_dp *) cfe_malloc(((size_t) 1 << log_capacity) * sizeof(cfe_dlog_dp));
+    for (size_t i = 0; i < ((size_t) 1 << log_capacity); i++) {
+        D->dps[i].type = 0;
+    }
+}
+
+static void cfe_dlog_dps_init(cfe_dlog_dps *D) {
+    cfe_dlog_dps_alloc(D, 10);
+    D->count = 0;
+    pthread_mutex_init(&D->lock, NULL);
+}
+
+static void cfe_dlog_dps_free(cfe_dlog_dps *D) {
+    for (size_t i = 0; i < ((size_t) 1 << D->log_capacity); i++) {
+        if (D->dps[i].type != 0) {
+            mpz_clears(D->dps[i].a, D->dps[i].b, NULL);
+        }
+    }
+    free(D->dps);
+    pthread_mutex_destroy(&D->lock);
+}
+
+static cfe_dlog_dp *cfe_dlog_dps_slot(cfe_dlog_dps *D, uint64_t fp) {
+    size_t mask = ((size_t) 1 << D->log_capacity) - 1;
+    size_t slot = (size_t) ((fp * 0x9E3779B97F4A7C15u) >> (64 - D->log_capacity));
+    while (D->dps[slot].type != 0 && D->dps[slot].fp != fp) {
+        slot = (slot + 1) & mask;
+    }
+    return &D->dps[slot];
+}
+
+// stores the distinguished point with the given fingerprint, type and
+// exponents, unless a point with the same fingerprint is already stored;
+// in that case, its type is returned and its exponents are copied to
+// other_a and other_b, otherwise 0 is returned; b and other_b can be NULL
+// when only a single exponent is needed
+static uint8_t cfe_dlog_dps_add(cfe_dlog_dps *D, uint64_t fp, uint8_t type, mpz_t a, mpz_t b,
+                                mpz_t other_a, mpz_t other_b) {
+    uint8_t other_type = 0;
+    pthread_mutex_lock(&D->lock);
+
+    cfe_dlog_dp *dp = cfe_dlog_dps_slot(D, fp);
+    if (dp->type != 0) {
+        other_type = dp->type;
+        mpz_set(other_a, dp->a);
+        if (other_b != NULL) {
+            mpz_set(other_b, dp->b);
+        }
+    } else {
+        dp->fp = fp;
+        dp->type = type;
+        mpz_init_set(dp->a, a);
+        mpz_init(dp->b);
+        if (b != NULL) {
+            mpz_set(dp->b, b);
+        }
+        D->count++;
+
+        // keep the table at most half full
+        if (2 * D->count > ((size_t) 1 << D->log_capacity)) {
+            cfe_dlog_dp *dps = D->dps;
+            size_t capacity = (size_t) 1 << D->log_capacity;
+            cfe_dlog_dps_alloc(D, D->log_capacity + 1);
+            for (size_t i = 0; i < capacity; i++) {
+                if (dps[i].type != 0) {
+                    *cfe_dlog_dps_slot(D, dps[i].fp) = dps[i];
+                }
+            }
+            free(dps);
+        }
+    }
+
+    pthread_mutex_unlock(&D->lock);
+    return other_type;
+}
+
+// mixes the fingerprint, so that the distinguished points and the steps
+// of the walks do not depend on some structure of the elements
+static uint64_t cfe_dlog_mix(uint64_t fp) {
+    fp ^= fp >> 31;
+    fp *= 0x9E3779B97F4A7C15u;
+    fp ^= fp >> 29;
+    return fp;
+}
+
+#define CFE_KANGAROO_TAME 1
+#define CFE_KANGAROO_WILD 2
+
+// parameters of the kangaroo method shared by all the threads, together
+// with the distinguished points found so far
+typedef struct cfe_kangaroo {
+    mpz_t bound;
+    size_t k; // jumps have sizes 2^j for j < k
+    mpz_t *jump_sizes;
+    uint64_t dp_mask; // a point is distinguished if its mixed fingerprint & dp_mask == 0
+    mpz_t spacing; // distance between the starting points of kangaroos
+    uint64_t max_steps; // the number of steps after which a thread gives up
+    size_t num_threads;
+    cfe_dlog_dps dps;
+    cfe_dlog_result r;
+} cfe_kangaroo;
+
+// the state of a single kangaroo; the element itself is kept by the
+// group-specific walker
+typedef struct cfe_kangaroo_state {
+    mpz_t pos; // the exponent of the element: g^pos for tame, h*g^pos for wild
+    uint8_t type;
+    uint64_t seed; // for choosing new starting points
+} cfe_kangaroo_state;
+
+// a simple generator of pseudorandom starting points (splitmix64)
+static uint64_t cfe_kangaroo_rand(uint64_t *seed) {
+    *seed += 0x9E3779B97F4A7C15u;
+    uint64_t z = *seed;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9u;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBu;
+    return z ^ (z >> 31);
+}
+
+// chooses the parameters for solutions in [-bound, bound], i.e. for the
+// interval of length N = 2*bound, with 2*num_threads kangaroos (a tame and
+// a wild one in each thread)
+static void cfe_kangaroo_init(cfe_kangaroo *kg, mpz_t bound, size_t num_threads, mpz_t res) {
+    mpz_init_set(kg->bound, bound);
+    mpz_abs(kg->bound, kg->bound);
+    kg->num_threads = num_threads;
+
+    mpz_t sqrt_n;
+    mpz_init(sqrt_n);
+    mpz_mul_ui(sqrt_n, kg->bound, 2);
+    mpz_sqrt(sqrt_n, sqrt_n);
+    mpz_add_ui(sqrt_n, sqrt_n, 1);
+    double s = mpz_get_d(sqrt_n);
+
+    // the mean jump should be (number of kangaroos) * sqrt(N) / 4, which
+    // the mean (2^k - 1) / k of jumps 2^0, ..., 2^(k-1) approximates
+    double mean = (double) num_threads * s / 2;
+    kg->k = 1;
+    while (kg->k < 62 && (ldexp(1.0, (int) kg->k) - 1) / (double) kg->k < mean) {
+        kg->k++;
+    }
+    kg->jump_sizes = (mpz_t *) cfe_malloc(kg->k * sizeof(mpz_t));
+    for (size_t j = 0; j < kg->k; j++) {
+        mpz_init(kg->jump_sizes[j]);
+        mpz_setbit(kg->jump_sizes[j], j);
+    }
+
+    // every kangaroo walks about sqrt(N) / num_threads steps before a
+    // collision; about 1/256 of this is lost after the collision, while
+    // walking to the next distinguished point
+    double walk = s / (double) num_threads;
+    size_t d = 0;
+    while (d < 32 && ldexp(1.0, (int) d + 8) < walk) {
+        d++;
+    }
+    kg->dp_mask = ((uint64_t) 1 << d) - 1;
+
+    mpz_init(kg->spacing);
+    mpz_set_d(kg->spacing, mean / (double) num_threads + 1);
+
+    // a kangaroo gives up after walking many times the expected distance,
+    // which practically only happens if there is no solution in the interval
+    double max_steps = 32 * (walk + ldexp(1.0, (int) d)) + 1024;
+    kg->max_steps = max_steps < 1.8e19 ? (uint64_t) max_steps : UINT64_MAX;
+
+    cfe_dlog_dps_init(&kg->dps);
+    cfe_dlog_result_init(&kg->r, res);
+
+    mpz_clear(sqrt_n);
+}
+
+static void cfe_kangaroo_free(cfe_kangaroo *kg) {
+    cfe_dlog_dps_free(&kg->dps);
+    for (size_t j = 0; j < kg->k; j++) {
+        mpz_clear(kg->jump_sizes[j]);
+    }
+    free(kg->jump_sizes);
+    mpz_clears(kg->bound, kg->spacing, NULL);
+    cfe_dlog_result_free(&kg->r);
+}
+
+// chooses a starting exponent of a kangaroo: bound + idx*spacing for
+// the first start, and a pseudorandom exponent from bound to
+// bound + num_threads*spacing for any restart
+static void cfe_kangaroo_start_pos(cfe_kangaroo *kg, cfe_kangaroo_state *st, size_t idx, bool restart) {
+    if (restart) {
+        uint64_t r = cfe_kangaroo_rand(&st->seed);
+        mpz_t range;
+        mpz_init(range);
+        mpz_mul_ui(range, kg->spacing, kg->num_threads);
+        mpz_import(st->pos, 1, 1, sizeof(uint64_t), 0, 0, &r);
+        mpz_mod(st->pos, st->pos, range);
+        mpz_clear(range);
+    } else {
+        mpz_mul_ui(st->pos, kg->spacing, idx);
+    }
+    mpz_add(st->pos, st->pos, kg->bound);
+}
+
+// handles the kangaroo reaching a distinguished point; sets the candidate
+// solution x and returns true if a tame and a wild kangaroo collided, and
+// returns false if the point was stored or the kangaroo must be restarted,
+// in which case restart is set to true
+static bool cfe_kangaroo_dp_reached(cfe_kangaroo *kg, cfe_kangaroo_state *st, uint64_t fp, mpz_t x,
+                                    bool *restart) {
+    *restart = false;
+    uint8_t other_type = cfe_dlog_dps_add(&kg->dps, fp, st->type, st->pos, NULL, x, NULL);
+    if (other_type == 0) {
+        return false;
+    }
+    if (other_type == st->type) {
+        // two kangaroos of the same kind would follow the same path
+        *restart = true;
+        return false;
+    }
+
+    // g^tame_pos = h*g^wild_pos, so x = tame_pos - wild_pos
+    if (st->type == CFE_KANGAROO_TAME) {
+        mpz_sub(x, st->pos, x);
+    } else {
+        mpz_sub(x, x, st->pos);
+    }
+    return true;
+}
+
+// the job of a single thread, which runs a tame and a wild kangaroo
+typedef struct cfe_kangaroo_job {
+    cfe_kangaroo *kg;
+    size_t idx;
+    void *group; // the group-specific data
+} cfe_kangaroo_job;
+
+// runs the worker in the given number of threads and sets res to the result
+static cfe_error cfe_kangaroo_run(cfe_kangaroo *kg, void *(*worker)(void *), void *group) {
+    cfe_kangaroo_job *jobs = (cfe_kangaroo_job *) cfe_malloc(kg->num_threads * sizeof(cfe_kangaroo_job));
+    for (size_t i = 0; i < kg->num_threads; i++) {
+        jobs[i].kg = kg;
+        jobs[i].idx = i;
+        jobs[i].group = group;
+    }
+    cfe_run_jobs(worker, jobs, sizeof(cfe_kangaroo_job), kg->num_threads);
+    free(jobs);
+
+    return atomic_load(&kg->r.found) ? CFE_ERR_NONE : CFE_ERR_DLOG_NOT_FOUND;
+}
+
+// the elements of Zp needed by the kangaroos
+typedef struct cfe_kangaroo_Zp {
+    mpz_ptr h;
+    mpz_ptr g;
+    mpz_ptr p;
+    cfe_modctx ctx;
+    mp_limb_t *jumps; // g^(2^j) in Montgomery form
+} cfe_kangaroo_Zp;
+
+// sets x to the element at the kangaroo's exponent, in Montgomery form
+static void cfe_kangaroo_Zp_start(mp_limb_t *x, cfe_kangaroo_Zp *grp, cfe_kangaroo_state *st, mpz_t tmp) {
+    mpz_powm(tmp, grp->g, st->pos, grp->p);
+    if (st->type == CFE_KANGAROO_WILD) {
+        mpz_mul(tmp, tmp, grp->h);
+    }
+    cfe_modctx_set(&grp->ctx, x, tmp);
+}
+
+static void *cfe_kangaroo_Zp_worker(void *arg) {
+    cfe_kangaroo_job *job = (cfe_kangaroo_job *) arg;
+    cfe_kangaroo *kg = job->kg;
+    cfe_kangaroo_Zp *grp = (cfe_kangaroo_Zp *) job->group;
+    cfe_kangaroo_state st[2];
+    size_t n = grp->ctx.n;
+    mp_limb_t *x = cfe_modctx_alloc(&grp->ctx, 2);
+    mpz_t cand, check;
+    mpz_inits(cand, check, NULL);
+    uint64_t steps = 0;
+
+    for (int i = 0; i < 2; i++) {
+        mpz_init(st[i].pos);
+        st[i].type = i == 0 ? CFE_KANGAROO_TAME : CFE_KANGAROO_WILD;
+        st[i].seed = 2 * job->idx + i;
+        cfe_kangaroo_start_pos(kg, &st[i], job->idx, false);
+        cfe_kangaroo_Zp_start(x + i * n, grp, &st[i], check);
+    }
+
+    for (; steps < kg->max_steps && !cfe_dlog_result_found(&kg->r); steps++) {
+        for (int i = 0; i < 2; i++) {
+            uint64_t fp = cfe_dlog_fingerprint(&grp->ctx, x + i * n);
+            uint64_t mixed = cfe_dlog_mix(fp);
+            bool restart = false;
+            if ((mixed & kg->dp_mask) == 0 && cfe_kangaroo_dp_reached(kg, &st[i], fp, cand, &restart)) {
+                // fingerprints may collide, so the solution is checked
+                mpz_powm(check, grp->g, cand, grp->p);
+                if (mpz_cmp(check, grp->h) == 0) {
+                    cfe_dlog_result_set_mpz(&kg->r, cand);
+                    break;
+                }
+                restart = true;
+            }
+            if (restart) {
+                cfe_kangaroo_start_pos(kg, &st[i], job->idx, true);
+                cfe_kangaroo_Zp_start(x + i * n, grp, &st[i], check);
+                continue;
+            }
+
+            size_t j = (size_t) ((mixed >> 32) % kg->k);
+            cfe_modctx_mul(&grp->ctx, x + i * n, x + i * n, grp->jumps + j * n);
+            mpz_add(st[i].pos, st[i].pos, kg->jump_sizes[j]);
+        }
+    }
+
+    free(x);
+    mpz_clears(cand, check, st[0].pos, st[1].pos, NULL);
+
+    return NULL;
+}
+
+cfe_error cfe_kangaroo_with_neg_parallel(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t bound, size_t num_threads) {
+    cfe_kangaroo_Zp grp;
+    grp.h = h;
+    grp.g = g;
+    grp.p = p;
+    if (cfe_modctx_init(&grp.ctx, p)) {
+        return CFE_ERR_DLOG_CALC_FAILED;
+    }
+
+    cfe_kangaroo kg;
+    cfe_kangaroo_init(&kg, bound, cfe_dlog_threads_for(num_threads, SIZE_MAX), res);
+
+    mpz_t jump;
+    mpz_init(jump);
+    grp.jumps = cfe_modctx_alloc(&grp.ctx, kg.k);
+    for (size_t j = 0; j < kg.k; j++) {
+        mpz_powm(jump, g, kg.jump_sizes[j], p);
+        cfe_modctx_set(&grp.ctx, grp.jumps + j * grp.ctx.n, jump);
+    }
+    mpz_clear(jump);
+
+    cfe_error err = cfe_kangaroo_run(&kg, cfe_kangaroo_Zp_worker, &grp);
+
+    free(grp.jumps);
+    cfe_modctx_free(&grp.ctx);
+    cfe_kangaroo_free(&kg);
+
+    return err;
+}
+
+cfe_error cfe_kangaroo_with_neg(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t bound) {
+    return cfe_kangaroo_with_neg_parallel(res, h, g, p, bound, 0);
+}
+
+// the elements of FP12_BN254 needed by the kangaroos
+typedef struct cfe_kangaroo_FP12_BN254 {
+    FP12_BN254 *h;
+    FP12_BN254 g;
+    FP12_BN254 *jumps; // g^(2^j)
+} cfe_kangaroo_FP12_BN254;
+
+// sets x = g^e for a non-negative or negative exponent e
+static void cfe_kangaroo_pow_FP12_BN254(FP12_BN254 *x, FP12_BN254 *g, mpz_t e) {
+    mpz_t e_abs;
+    mpz_init(e_abs);
+    mpz_abs(e_abs, e);
+
+    BIG_256_56 e_b;
+    BIG_256_56_from_mpz(e_b, e_abs);
+    FP12_BN254_pow(x, g, e_b);
+    if (mpz_sgn(e) < 0) {
+        FP12_BN254_inv(x, x);
+    }
+    FP12_BN254_reduce(x);
+
+    mpz_clear(e_abs);
+}
+
+// sets x to the element at the kangaroo's exponent
+static void cfe_kangaroo_FP12_BN254_start(FP12_BN254 *x, cfe_kangaroo_FP12_BN254 *grp, cfe_kangaroo_state *st) {
+    cfe_kangaroo_pow_FP12_BN254(x, &grp->g, st->pos);
+    if (st->type == CFE_KANGAROO_WILD) {
+        FP12_BN254_mul(x, grp->h);
+        FP12_BN254_reduce(x);
+    }
+}
+
+static void *cfe_kangaroo_FP12_BN254_worker(void *arg) {
+    cfe_kangaroo_job *job = (cfe_kangaroo_job *) arg;
+    cfe_kangaroo *kg = job->kg;
+    cfe_kangaroo_FP12_BN254 *grp = (cfe_kangaroo_FP12_BN254 *) job->group;
+    cfe_kangaroo_state st[2];
+    FP12_BN254 x[2], check;
+    mpz_t cand;
+    mpz_init(cand);
+    uint64_t steps = 0;
+
+    for (int i = 0; i < 2; i++) {
+        mpz_init(st[i].pos);
+        st[i].type = i == 0 ? CFE_KANGAROO_TAME : CFE_KANGAROO_WILD;
+        st[i].seed = 2 * job->idx + i;
+        cfe_kangaroo_start_pos(kg, &st[i], job->idx, false);
+        cfe_kangaroo_FP12_BN254_start(&x[i], grp, &st[i]);
+    }
+
+    for (; steps < kg->max_steps && !cfe_dlog_result_found(&kg->r); steps++) {
+        for (int i = 0; i < 2; i++) {
+            uint64_t fp = cfe_dlog_fingerprint_FP12_BN254(&x[i]);
+            uint64_t mixed = cfe_dlog_mix(fp);
+            bool restart = false;
+            if ((mixed & kg->dp_mask) == 0 && cfe_kangaroo_dp_reached(kg, &st[i], fp, cand, &restart)) {
+                // fingerprints may collide, so the solution is checked
+                cfe_kangaroo_pow_FP12_BN254(&check, &grp->g, cand);
+                if (FP12_BN254_equals(&check, grp->h) == 1) {
+                    cfe_dlog_result_set_mpz(&kg->r, cand);
+                    break;
+                }
+                restart = true;
+            }
+            if (restart) {
+                cfe_kangaroo_start_pos(kg, &st[i], job->idx, true);
+                cfe_kangaroo_FP12_BN254_start(&x[i], grp, &st[i]);
+                continue;
+            }
+
+            size_t j = (size_t) ((mixed >> 32) % kg->k);
+            FP12_BN254_mul(&x[i], &grp->jumps[j]);
+            FP12_BN254_reduce(&x[i]);
+            mpz_add(st[i].pos, st[i].pos, kg->jump_sizes[j]);
+        }
+    }
+
+    mpz_clears(cand, st[0].pos, st[1].pos, NULL);
+
+    return NULL;
+}
+
+cfe_error cfe_kangaroo_FP12_BN254_with_neg_parallel(mpz_t res, FP12_BN254 *h, FP12_BN254 *g, mpz_t bound,
+                                                   size_t num_threads) {
+    cfe_kangaroo kg;
+    cfe_kangaroo_init(&kg, bound, cfe_dlog_threads_for(num_threads, SIZE_MAX), res);
+
+    cfe_kangaroo_FP12_BN254 grp;
+    FP12_BN254 h_red;
+    FP12_BN254_copy(&h_red, h);
+    FP12_BN254_reduce(&h_red);
+    grp.h = &h_red;
+    FP12_BN254_copy(&grp.g, g);
+    FP12_BN254_reduce(&grp.g);
+    grp.jumps = (FP12_BN254 *) cfe_malloc(kg.k * sizeof(FP12_BN254));
+    FP12_BN254_copy(&grp.jumps[0], &grp.g);
+    for (size_t j = 1; j < kg.k; j++) {
+        FP12_BN254_sqr(&grp.jumps[j], &grp.jumps[j - 1]);
+        FP12_BN254_reduce(&grp.jumps[j]);
+    }
+
+    cfe_error err = cfe_kangaroo_run(&kg, cfe_kangaroo_FP12_BN254_worker, &grp);
+
+    free(grp.jumps);
+    cfe_kangaroo_free(&kg);
+
+    return err;
+}
+
+cfe_error cfe_kangaroo_FP12_BN254_with_neg(mpz_t res, FP12_BN254 *h, FP12_BN254 *g, mpz_t bound) {
+    return cfe_kangaroo_FP12_BN254_with_neg_parallel(res, h, g, bound, 0);
+}
+
+// predicts the cost of the kangaroo method from the parameters it would
+// use with the given bound and number of threads
+static void cfe_dlog_predict_kangaroo(cfe_dlog_prediction *pr, mpz_t bound, size_t num_threads) {
+    mpz_t res;
+    mpz_init(res);
+    cfe_kangaroo kg;
+    cfe_kangaroo_init(&kg, bound, num_threads, res);
+
+    // the tame and the wild kangaroos of all the threads collide after
+    // about 2 sqrt(2 bound) steps, and then each of them walks to its next
+    // distinguished point
+    double dp_dist = (double) kg.dp_mask + 1;
+    double num_kangaroos = 2 * (double) num_threads;
+    pr->algorithm = CFE_DLOG_KANGAROO;
+    pr->baby_steps = 0;
+    pr->giant_steps = 0;
+    pr->expected_steps = 2 * sqrt(2 * mpz_get_d(kg.bound)) + num_kangaroos * dp_dist;
+    pr->max_steps = num_kangaroos * (double) kg.max_steps;
+
+    // distinguished points are stored with their exponents in a table which
+    // is at most half full
+    double dp_bytes = 4 * sizeof(cfe_dlog_dp) + 2 * (mpz_size(kg.bound) + 1) * sizeof(mp_limb_t);
+    pr->table_bytes = (size_t) (pr->expected_steps / dp_dist * dp_bytes);
+
+    cfe_kangaroo_free(&kg);
+    mpz_clear(res);
+}
+
+// predicts the cost of the baby-step giant-step method searching for
+// x and -x at the same time
+static cfe_error cfe_dlog_predict_bsgs(cfe_dlog_prediction *pr, mpz_t bound, cfe_dlog_config *c) {
+    size_t m, giant_steps;
+    cfe_error err = cfe_dlog_steps(&m, &giant_steps, bound, c);
+    if (err) {
+        return err;
+    }
+
+    // the solution is equally likely to be found in any giant step, each
+    // of which multiplies both h and h^-1 by the giant step
+    pr->algorithm = CFE_DLOG_BSGS;
+    pr->baby_steps = m;
+    pr->giant_steps = giant_steps;
+    pr->table_bytes = cfe_dlog_table_bytes(m);
+    pr->expected_steps = (double) m + (double) giant_steps;
+    pr->max_steps = (double) m + 2 * (double) giant_steps;
+
+    return CFE_ERR_NONE;
+}
+
+cfe_error cfe_dlog_predict(cfe_dlog_prediction *pr, mpz_t bound, cfe_dlog_config *c) {
+    cfe_dlog_config c_default;
+    if (c == NULL) {
+        cfe_dlog_config_init(&c_default);
+        c = &c_default;
+    }
+    size_t num_threads = cfe_dlog_threads_for(c->num_threads, SIZE_MAX);
+
+    if (c->algorithm == CFE_DLOG_KANGAROO) {
+        cfe_dlog_predict_kangaroo(pr, bound, num_threads);
+        return CFE_ERR_NONE;
+    }
+
+    cfe_error err = cfe_dlog_predict_bsgs(pr, bound, c);
+    if (c->algorithm == CFE_DLOG_BSGS) {
+        return err;
+    }
+
+    // the kangaroo method is chosen when the table of baby steps cannot be
+    // built within the limits, or when it would need more steps
+    cfe_dlog_prediction kangaroo;
+    cfe_dlog_predict_kangaroo(&kangaroo, bound, num_threads);
+    if (err || kangaroo.expected_steps < pr->expected_steps) {
+        *pr = kangaroo;
+    }
+
+    return CFE_ERR_NONE;
+}
+
+// returns whether the configured algorithm is the kangaroo method, either
+// explicitly or as chosen by the prediction
+static bool cfe_dlog_use_kangaroo(mpz_t bound, cfe_dlog_config *c) {
+    if (bound == NULL || c->algorithm == CFE_DLOG_BSGS) {
+        return false;
+    }
+
+    cfe_dlog_prediction pr;
+    cfe_dlog_predict(&pr, bound, c);
+
+    return pr.algorithm == CFE_DLOG_KANGAROO;
+}
+
+cfe_error cfe_dlog_with_neg(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t order, mpz_t bound, cfe_dlog_config *c) {
+    cfe_dlog_config c_default;
+    if (c == NULL) {
+        cfe_dlog_config_init(&c_default);
+        c = &c_default;
+    }
+
+    if (cfe_dlog_use_kangaroo(bound, c)) {
+        return cfe_kangaroo_with_neg_parallel(res, h, g, p, bound, c->num_threads);
+    }
+
+    return cfe_baby_giant_with_config(res, h, g, p, order, bound, c, true);
+}
+
+cfe_error cfe_dlog_FP12_BN254_with_neg(mpz_t res, FP12_BN254 *h, FP12_BN254 *g, mpz_t bound, cfe_dlog_config *c) {
+    cfe_dlog_config c_default;
+    if (c == NULL) {
+        cfe_dlog_config_init(&c_default);
+        c = &c_default;
+    }
+
+    if (cfe_dlog_use_kangaroo(bound, c)) {
+        return cfe_kangaroo_FP12_BN254_with_neg_parallel(res, h, g, bound, c->num_threads);
+    }
+
+    cfe_dlog_table_FP12_BN254 t;
+    cfe_error err = cfe_dlog_table_FP12_BN254_init_with_config(&t, g, bound, c);
+    if (err) {
+        return err;
+    }
+
+    err = cfe_dlog_table_FP12_BN254_solve_with_neg(res, h, &t);
+    cfe_dlog_table_FP12_BN254_free(&t);
+
+    return err;
+}
+
+// the number of multipliers of the adding walk in the rho method
+#define CFE_RHO_R 20
+
+// the number of steps after which a thread reports its progress
+#define CFE_RHO_REPORT_STEPS ((uint64_t) 1 << 16)
+
+// parameters of the rho method shared by all the threads, together with
+// the distinguished points found so far
+typedef struct cfe_rho {
+    mpz_ptr h;
+    mpz_ptr g;
+    mpz_ptr p;
+    mpz_ptr n;
+    cfe_modctx ctx;
+    mp_limb_t *mults; // multipliers g^mult_a[j] * h^mult_b[j] in Montgomery form
+    mpz_t mult_a[CFE_RHO_R];
+    mpz_t mult_b[CFE_RHO_R];
+    uint64_t dp_mask; // a point is distinguished if its mixed fingerprint & dp_mask == 0
+    uint64_t max_walk; // the number of steps without a distinguished point after which a walk is restarted
+    uint64_t max_steps; // the number of steps after which a thread gives up
+    uint64_t expected_steps;
+    size_t num_threads;
+    cfe_dlog_dps dps;
+    cfe_dlog_result r;
+    atomic_bool cancelled;
+    atomic_uint_fast64_t steps;
+    cfe_dlog_progress progress;
+    void *progress_data;
+} cfe_rho;
+
+// the job of a single thread, which runs a single walk
+typedef struct cfe_rho_job {
+    cfe_rho *rho;
+    size_t idx;
+} cfe_rho_job;
+
+// starts a walk at a random element g^a * h^b
+static void cfe_rho_start(mpz_t x, mpz_t a, mpz_t b, mpz_t tmp, cfe_rho *rho) {
+    cfe_uniform_sample(a, rho->n);
+    cfe_uniform_sample(b, rho->n);
+    mpz_powm(x, rho->g, a, rho->p);
+    mpz_powm(tmp, rho->h, b, rho->p);
+    mpz_mul(x, x, tmp);
+    mpz_mod(x, x, rho->p);
+}
+
+// from g^a * h^b = g^a2 * h^b2 it follows (b - b2) * x = a2 - a (mod n),
+// which gives gcd(b - b2, n) candidates for x; the function sets res to the
+// candidate that is the solution and returns true if there is one
+static bool cfe_rho_solve(mpz_t res, mpz_t a, mpz_t b, mpz_t a2, mpz_t b2, cfe_rho *rho) {
+    bool found = false;
+    mpz_t r, t, d, n_div_d, q, check;
+    mpz_inits(r, t, d, n_div_d, q, check, NULL);
+
+    mpz_sub(r, b, b2);
+    mpz_mod(r, r, rho->n);
+    mpz_sub(t, a2, a);
+    mpz_mod(t, t, rho->n);
+    if (mpz_cmp_ui(r, 0) == 0) {
+        goto cleanup;
+    }
+
+    // in case r and n are not coprime additional candidates are checked
+    mpz_gcd(d, r, rho->n);
+    if (!mpz_divisible_p(t, d)) {
+        goto cleanup;
+    }
+    mpz_divexact(r, r, d);
+    mpz_divexact(t, t, d);
+    mpz_divexact(n_div_d, rho->n, d);
+    mpz_invert(q, r, n_div_d);
+    mpz_mul(q, q, t);
+    mpz_mod(q, q, n_div_d);
+
+    for (; mpz_cmp(q, rho->n) < 0; mpz_add(q, q, n_div_d)) {
+        mpz_powm(check, rho->g, q, rho->p);
+        if (mpz_cmp(check, rho->h) == 0) {
+            mpz_set(res, q);
+            found = true;
+            break;
+        }
+    }
+
+    cleanup:
+    mpz_clears(r, t, d, n_div_d, q, check, NULL);
+
+    return found;
+}
+
+static void *cfe_rho_worker(void *arg) {
+    cfe_rho_job *job = (cfe_rho_job *) arg;
+    cfe_rho *rho = job->rho;
+    mpz_t x, a, b, a2, b2, tmp;
+    mpz_inits(x, a, b, a2, b2, tmp, NULL);
+    mp_limb_t *y = cfe_modctx_alloc(&rho->ctx, 1);
+    uint64_t walk = 0;
+
+    // the walk is computed with y, the Montgomery form of x
+    cfe_rho_start(x, a, b, tmp, rho);
+    cfe_modctx_set(&rho->ctx, y, x);
+
+    for (uint64_t steps = 1; steps <= rho->max_steps; steps++) {
+        if (cfe_dlog_result_found(&rho->r) || atomic_load_explicit(&rho->cancelled, memory_order_relaxed)) {
+            break;
+        }
+
+        uint64_t fp = cfe_dlog_fingerprint(&rho->ctx, y);
+        uint64_t mixed = cfe_dlog_mix(fp);
+        if ((mixed & rho->dp_mask) == 0) {
+            if (cfe_dlog_dps_add(&rho->dps, fp, 1, a, b, a2, b2) != 0) {
+                // fingerprints may collide, so the solution is checked
+                if (cfe_rho_solve(tmp, a, b, a2, b2, rho)) {
+                    cfe_dlog_result_set_mpz(&rho->r, tmp);
+                    break;
+                }
+                // the walk would follow the walk which reached the point first
+                cfe_rho_start(x, a, b, tmp, rho);
+                cfe_modctx_set(&rho->ctx, y, x);
+            }
+            walk = 0;
+        } else if (++walk > rho->max_walk) {
+            // the walk is probably stuck in a cycle without distinguished points
+            cfe_rho_start(x, a, b, tmp, rho);
+            cfe_modctx_set(&rho->ctx, y, x);
+            walk = 0;
+        }
+
+        size_t j = (size_t) ((mixed >> 32) % CFE_RHO_R);
+        cfe_modctx_mul(&rho->ctx, y, y, rho->mults + j * rho->ctx.n);
+        mpz_add(a, a, rho->mult_a[j]);
+        if (mpz_cmp(a, rho->n) >= 0) {
+            mpz_sub(a, a, rho->n);
+        }
+        mpz_add(b, b, rho->mult_b[j]);
+        if (mpz_cmp(b, rho->n) >= 0) {
+            mpz_sub(b, b, rho->n);
+        }
+
+        if (steps % CFE_RHO_REPORT_STEPS == 0) {
+            uint64_t total = atomic_fetch_add(&rho->steps, CFE_RHO_REPORT_STEPS) + CFE_RHO_REPORT_STEPS;
+            if (job->idx == 0 && rho->progress != NULL &&
+                rho->progress(total, rho->expected_steps, rho->progress_data) != 0) {
+                atomic_store(&rho->cancelled, true);
+            }
+        }
+    }
+
+    free(y);
+    mpz_clears(x, a, b, a2, b2, tmp, NULL);
+
+    return NULL;
+}
+
+cfe_error cfe_pollard_rho_parallel(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t n, size_t num_threads,
+                                   cfe_dlog_progress progress, void *progress_data) {
+    cfe_rho rho;
+    if (cfe_modctx_init(&rho.ctx, p)) {
+        return CFE_ERR_DLOG_CALC_FAILED;
+    }
+    rho.h = h;
+    rho.g = g;
+    rho.p = p;
+    rho.n = n;
+    rho.num_threads = cfe_dlog_threads_for(num_threads, SIZE_MAX);
+    rho.progress = progress;
+    rho.progress_data = progress_data;
+    atomic_init(&rho.cancelled, false);
+    atomic_init(&rho.steps, 0);
+    cfe_dlog_dps_init(&rho.dps);
+    cfe_dlog_result_init(&rho.r, res);
+
+    mpz_t mult, tmp;
+    mpz_inits(mult, tmp, NULL);
+    rho.mults = cfe_modctx_alloc(&rho.ctx, CFE_RHO_R);
+    for (size_t j = 0; j < CFE_RHO_R; j++) {
+        mpz_inits(rho.mult_a[j], rho.mult_b[j], NULL);
+        cfe_rho_start(mult, rho.mult_a[j], rho.mult_b[j], tmp, &rho);
+        cfe_modctx_set(&rho.ctx, rho.mults + j * rho.ctx.n, mult);
+    }
+    mpz_clears(mult, tmp, NULL);
+
+    // the walks are expected to collide after sqrt(pi*n/2) steps in total;
+    // about 1/256 of this is lost after the collision, while walking to the
+    // next distinguished point
+    double expected = sqrt(3.1416 * mpz_get_d(n) / 2) + 1;
+    double walk = expected / (double) rho.num_threads;
+    size_t d = 0;
+    while (d < 32 && ldexp(1.0, (int) d + 8) < walk) {
+        d++;
+    }
+    rho.dp_mask = ((uint64_t) 1 << d) - 1;
+    rho.max_walk = ((uint64_t) 1 << d) * 32;
+    rho.expected_steps = expected < 1.8e19 ? (uint64_t) expected : UINT64_MAX;
+    double max_steps = 32 * (walk + ldexp(1.0, (int) d)) + 1024;
+    rho.max_steps = max_steps < 1.8e19 ? (uint64_t) max_steps : UINT64_MAX;
+
+    cfe_rho_job *jobs = (cfe_rho_job *) cfe_malloc(rho.num_threads * sizeof(cfe_rho_job));
+    for (size_t i = 0; i < rho.num_threads; i++) {
+        jobs[i].rho = &rho;
+        jobs[i].idx = i;
+    }
+    cfe_run_jobs(cfe_rho_worker, jobs, sizeof(cfe_rho_job), rho.num_threads);
+
+    cfe_error err = CFE_ERR_NONE;
+    if (!atomic_load(&rho.r.found)) {
+        err = atomic_load(&rho.cancelled) ? CFE_ERR_CANCELLED : CFE_ERR_DLOG_NOT_FOUND;
+    }
+
+    for (size_t j = 0; j < CFE_RHO_R; j++) {
+        mpz_clears(rho.mult_a[j], rho.mult_b[j], NULL);
+    }
+    free(rho.mults);
+    cfe_modctx_free(&rho.ctx);
+    free(jobs);
+    cfe_dlog_dps_free(&rho.dps);
+    cfe_dlog_result_free(&rho.r);
+
+    return err;
+}
+
+cfe_error cfe_pollard_rho(mpz_t res, mpz_t h, mpz_t g, mpz_t p, mpz_t n) {
+    return cfe_pollard_rho_parallel(res, h, g, p, n, 0, NULL, NULL);
 }
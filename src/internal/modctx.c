@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2018 XLAB d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <stdlib.h>
+
+#include "cifer/internal/common.h"
+#include "cifer/internal/modctx.h"
+
+// copies the limbs of an integer 0 <= a < m into n limbs
+static void cfe_modctx_limbs(mp_limb_t *r, mpz_t a, size_t n) {
+    size_t size = mpz_size(a);
+    mpn_copyi(r, mpz_limbs_read(a), size);
+    mpn_zero(r + size, n - size);
+}
+
+cfe_error cfe_modctx_init(cfe_modctx *ctx, mpz_t m) {
+    if (mpz_even_p(m) || mpz_cmp_ui(m, 3) < 0) {
+        return CFE_ERR_MALFORMED_INPUT;
+    }
+
+    size_t n = mpz_size(m);
+    ctx->n = n;
+    ctx->m = (mp_limb_t *) cfe_malloc(3 * n * sizeof(mp_limb_t));
+    ctx->r2 = ctx->m + n;
+    ctx->one = ctx->m + 2 * n;
+    cfe_modctx_limbs(ctx->m, m, n);
+
+    // Newton's iteration doubles the number of correct low bits of the
+    // inverse, starting with 3 bits, since m0 * m0 = 1 mod 8 for odd m0
+    mp_limb_t m0 = ctx->m[0];
+    mp_limb_t inv = m0;
+    for (int i = 0; i < 5; i++) {
+        inv *= 2 - m0 * inv;
+    }
+    ctx->m_inv = -inv;
+
+    mpz_t r;
+    mpz_init(r);
+    mpz_setbit(r, n * GMP_NUMB_BITS);
+    mpz_mod(r, r, m);
+    cfe_modctx_limbs(ctx->one, r, n);
+    mpz_mul(r, r, r);
+    mpz_mod(r, r, m);
+    cfe_modctx_limbs(ctx->r2, r, n);
+    mpz_clear(r);
+
+    return CFE_ERR_NONE;
+}
+
+void cfe_modctx_copy(cfe_modctx *res, cfe_modctx *ctx) {
+    size_t n = ctx->n;
+    res->n = n;
+    res->m = (mp_limb_t *) cfe_malloc(3 * n * sizeof(mp_limb_t));
+    res->r2 = res->m + n;
+    res->one = res->m + 2 * n;
+    res->m_inv = ctx->m_inv;
+    mpn_copyi(res->m, ctx->m, 3 * n);
+}
+
+void cfe_modctx_free(cfe_modctx *ctx) {
+    free(ctx->m);
+}
+
+mp_limb_t *cfe_modctx_alloc(cfe_modctx *ctx, size_t count) {
+    return (mp_limb_t *) cfe_malloc(count * ctx->n * sizeof(mp_limb_t));
+}
+
+// sets r = t/R mod m for t < m*R of 2n limbs, which are overwritten; each
+// step adds the multiple of m that clears the lowest remaining limb of t
+static void cfe_modctx_redc(cfe_modctx *ctx, mp_limb_t *r, mp_limb_t *t) {
+    size_t n = ctx->n;
+    mp_limb_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        mp_limb_t u = t[i] * ctx->m_inv;
+        mp_limb_t c = mpn_addmul_1(t + i, ctx->m, n, u);
+        carry += mpn_add_1(t + i + n, t + i + n, n - i, c);
+    }
+
+    // the result is below 2m, so a single subtraction reduces it
+    if (carry != 0 || mpn_cmp(t + n, ctx->m, n) >= 0) {
+        mpn_sub_n(r, t + n, ctx->m, n);
+    } else {
+        mpn_copyi(r, t + n, n);
+    }
+}
+
+void cfe_modctx_set(cfe_modctx *ctx, mp_limb_t *r, mpz_t a) {
+    mpz_t m, red;
+    mpz_roinit_n(m, ctx->m, (mp_size_t) ctx->n);
+    mp_limb_t t[ctx->n];
+
+    if (mpz_sgn(a) >= 0 && mpz_cmp(a, m) < 0) {
+        cfe_modctx_limbs(t, a, ctx->n);
+    } else {
+        mpz_init(red);
+        mpz_mod(red, a, m);
+        cfe_modctx_limbs(t, red, ctx->n);
+        mpz_clear(red);
+    }
+
+    cfe_modctx_mul(ctx, r, t, ctx->r2);
+}
+
+void cfe_modctx_get(cfe_modctx *ctx, mpz_t r, mp_limb_t *a) {
+    size_t n = ctx->n;
+    mp_limb_t t[2 * n];
+    mpn_copyi(t, a, n);
+    mpn_zero(t + n, n);
+
+    mp_limb_t *w = mpz_limbs_write(r, (mp_size_t) n);
+    cfe_modctx_redc(ctx, w, t);
+    mpz_limbs_finish(r, (mp_size_t) n);
+}
+
+void cfe_modctx_set_one(cfe_modctx *ctx, mp_limb_t *r) {
+    mpn_copyi(r, ctx->one, ctx->n);
+}
+
+bool cfe_modctx_is_one(cfe_modctx *ctx, mp_limb_t *a) {
+    return mpn_cmp(a, ctx->one, ctx->n) == 0;
+}
+
+void cfe_modctx_mul(cfe_modctx *ctx, mp_limb_t *r, mp_limb_t *a, mp_limb_t *b) {
+    mp_limb_t t[2 * ctx->n];
+    if (a == b) {
+        mpn_sqr(t, a, (mp_size_t) ctx->n);
+    } else {
+        mpn_mul_n(t, a, b, (mp_size_t) ctx->n);
+    }
+    cfe_modctx_redc(ctx, r, t);
+}
+
+void cfe_modctx_sqr(cfe_modctx *ctx, mp_limb_t *r, mp_limb_t *a) {
+    mp_limb_t t[2 * ctx->n];
+    mpn_sqr(t, a, (mp_size_t) ctx->n);
+    cfe_modctx_redc(ctx, r, t);
+}
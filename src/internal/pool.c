@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2018 XLAB d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+
+#include "cifer/internal/common.h"
+#include "cifer/internal/pool.h"
+
+// moves a computed value into the pool unless it is full, in which case
+// it returns false; the pool must be locked
+static bool cfe_pool_push(cfe_pool *p, cfe_vec *elem) {
+    if (p->len == p->capacity) {
+        return false;
+    }
+
+    size_t tail = (p->head + p->len) % p->capacity;
+    cfe_vec tmp = p->elems[tail];
+    p->elems[tail] = *elem;
+    *elem = tmp;
+    p->len++;
+
+    return true;
+}
+
+static void *cfe_pool_worker(void *arg) {
+    cfe_pool *p = (cfe_pool *) arg;
+    cfe_vec elem;
+    cfe_vec_init(&elem, p->elem_size);
+
+    pthread_mutex_lock(&p->lock);
+    while (!p->stop) {
+        if (p->len == p->capacity) {
+            pthread_cond_wait(&p->not_full, &p->lock);
+            continue;
+        }
+        // the value is computed without holding the lock
+        pthread_mutex_unlock(&p->lock);
+        p->fill(&elem, p->data);
+        pthread_mutex_lock(&p->lock);
+        cfe_pool_push(p, &elem);
+    }
+    pthread_mutex_unlock(&p->lock);
+
+    cfe_vec_free(&elem);
+    return NULL;
+}
+
+void cfe_pool_init(cfe_pool *p, size_t capacity, size_t elem_size, cfe_pool_fill_fn fill,
+                   cfe_pool_free_fn free_data, void *data, bool background) {
+    p->capacity = capacity > 0 ? capacity : 1;
+    p->elem_size = elem_size;
+    p->head = 0;
+    p->len = 0;
+    p->fill = fill;
+    p->free_data = free_data;
+    p->data = data;
+    p->stop = false;
+    p->elems = (cfe_vec *) cfe_malloc(p->capacity * sizeof(cfe_vec));
+    for (size_t i = 0; i < p->capacity; i++) {
+        cfe_vec_init(&p->elems[i], elem_size);
+    }
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->not_full, NULL);
+
+    p->background = false;
+    if (background) {
+        cfe_pool_start(p);
+    }
+}
+
+bool cfe_pool_start(cfe_pool *p) {
+    if (!p->background) {
+        p->background = pthread_create(&p->thread, NULL, cfe_pool_worker, p) == 0;
+    }
+
+    return p->background;
+}
+
+void cfe_pool_fill(cfe_pool *p) {
+    cfe_vec elem;
+    cfe_vec_init(&elem, p->elem_size);
+
+    bool full = false;
+    while (!full) {
+        p->fill(&elem, p->data);
+        pthread_mutex_lock(&p->lock);
+        full = !cfe_pool_push(p, &elem) || p->len == p->capacity;
+        pthread_mutex_unlock(&p->lock);
+    }
+
+    cfe_vec_free(&elem);
+}
+
+bool cfe_pool_try_take(cfe_vec *res, cfe_pool *p) {
+    pthread_mutex_lock(&p->lock);
+    if (p->len == 0) {
+        pthread_mutex_unlock(&p->lock);
+        return false;
+    }
+
+    cfe_vec tmp = p->elems[p->head];
+    p->elems[p->head] = *res;
+    *res = tmp;
+    p->head = (p->head + 1) % p->capacity;
+    p->len--;
+    pthread_cond_signal(&p->not_full);
+    pthread_mutex_unlock(&p->lock);
+
+    return true;
+}
+
+void cfe_pool_take(cfe_vec *res, cfe_pool *p) {
+    if (!cfe_pool_try_take(res, p)) {
+        p->fill(res, p->data);
+    }
+}
+
+size_t cfe_pool_len(cfe_pool *p) {
+    pthread_mutex_lock(&p->lock);
+    size_t len = p->len;
+    pthread_mutex_unlock(&p->lock);
+
+    return len;
+}
+
+void cfe_pool_free(cfe_pool *p) {
+    if (p->background) {
+        pthread_mutex_lock(&p->lock);
+        p->stop = true;
+        pthread_cond_signal(&p->not_full);
+        pthread_mutex_unlock(&p->lock);
+        pthread_join(p->thread, NULL);
+    }
+
+    for (size_t i = 0; i < p->capacity; i++) {
+        cfe_vec_free(&p->elems[i]);
+    }
+    free(p->elems);
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->not_full);
+    if (p->free_data != NULL) {
+        p->free_data(p->data);
+    }
+}
@@ -0,0 +1,610 @@
+/*
+ * Copyright (c) 2018 XLAB d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "cifer/internal/common.h"
+#include "cifer/internal/powm.h"
+
+void cfe_fixed_base_init(cfe_fixed_base *fb, mpz_t g, mpz_t p, size_t bits) {
+    cfe_fixed_base_init_params(fb, g, p, bits, CFE_FIXED_BASE_TEETH, CFE_FIXED_BASE_TABLES);
+}
+
+void cfe_fixed_base_init_params(cfe_fixed_base *fb, mpz_t g, mpz_t p, size_t bits, size_t h, size_t v) {
+    mpz_init_set(fb->g, g);
+    mpz_init_set(fb->p, p);
+    fb->bits = bits;
+    fb->h = h;
+    fb->v = v;
+    fb->a = (bits + h - 1) / h;
+    if (fb->a == 0) {
+        fb->a = 1;
+    }
+    fb->b = (fb->a + v - 1) / v;
+
+    // without Montgomery arithmetic (for an even modulus) all the powers
+    // are left to mpz_powm
+    fb->tables = NULL;
+    if (cfe_modctx_init(&fb->ctx, p)) {
+        return;
+    }
+
+    cfe_modctx *ctx = &fb->ctx;
+    size_t n = ctx->n;
+    size_t size = (size_t) 1 << h;
+    fb->tables = cfe_modctx_alloc(ctx, v * size);
+    mp_limb_t *tables = fb->tables;
+
+    // the first table is filled from the powers g^(2^(j*a)), each entry
+    // from the one without its lowest bit
+    mp_limb_t *base = cfe_modctx_alloc(ctx, 1);
+    cfe_modctx_set(ctx, base, g);
+    cfe_modctx_set_one(ctx, tables);
+    for (size_t j = 0; j < h; j++) {
+        size_t bit = (size_t) 1 << j;
+        for (size_t u = bit; u < 2 * bit; u++) {
+            cfe_modctx_mul(ctx, tables + u * n, tables + (u - bit) * n, base);
+        }
+        for (size_t k = 0; k < fb->a; k++) {
+            cfe_modctx_sqr(ctx, base, base);
+        }
+    }
+    free(base);
+
+    // each next table is the previous one raised to 2^b
+    for (size_t t = 1; t < v; t++) {
+        cfe_modctx_set_one(ctx, tables + t * size * n);
+        for (size_t u = 1; u < size; u++) {
+            mp_limb_t *e = tables + (t * size + u) * n;
+            mpn_copyi(e, tables + ((t - 1) * size + u) * n, n);
+            for (size_t k = 0; k < fb->b; k++) {
+                cfe_modctx_sqr(ctx, e, e);
+            }
+        }
+    }
+}
+
+void cfe_fixed_base_copy(cfe_fixed_base *res, cfe_fixed_base *fb) {
+    mpz_init_set(res->g, fb->g);
+    mpz_init_set(res->p, fb->p);
+    res->bits = fb->bits;
+    res->h = fb->h;
+    res->v = fb->v;
+    res->a = fb->a;
+    res->b = fb->b;
+    res->tables = NULL;
+    if (fb->tables == NULL) {
+        return;
+    }
+
+    cfe_modctx_copy(&res->ctx, &fb->ctx);
+    size_t len = (fb->v << fb->h) * fb->ctx.n;
+    res->tables = cfe_modctx_alloc(&res->ctx, fb->v << fb->h);
+    mpn_copyi(res->tables, fb->tables, len);
+}
+
+void cfe_fixed_base_free(cfe_fixed_base *fb) {
+    if (fb->tables != NULL) {
+        free(fb->tables);
+        cfe_modctx_free(&fb->ctx);
+    }
+    mpz_clears(fb->g, fb->p, NULL);
+}
+
+void cfe_fixed_base_powm(mpz_t res, cfe_fixed_base *fb, mpz_t e) {
+    if (fb->tables == NULL || mpz_sizeinbase(e, 2) > fb->bits) {
+        mpz_powm(res, fb->g, e, fb->p);
+        return;
+    }
+
+    // mpz_tstbit works on the two's complement, so a negative exponent
+    // is handled through its absolute value
+    if (mpz_sgn(e) < 0) {
+        mpz_t abs;
+        mpz_init(abs);
+        mpz_neg(abs, e);
+        cfe_fixed_base_powm(res, fb, abs);
+        mpz_invert(res, res, fb->p);
+        mpz_clear(abs);
+        return;
+    }
+
+    cfe_modctx *ctx = &fb->ctx;
+    size_t n = ctx->n;
+    mp_limb_t acc[n];
+    cfe_modctx_set_one(ctx, acc);
+    bool one = true;
+    size_t size = (size_t) 1 << fb->h;
+    for (size_t k = fb->b; k-- > 0;) {
+        if (!one) {
+            cfe_modctx_sqr(ctx, acc, acc);
+        }
+        for (size_t t = 0; t < fb->v; t++) {
+            size_t offset = t * fb->b + k;
+            if (offset >= fb->a) {
+                continue;
+            }
+            size_t u = 0;
+            for (size_t j = 0; j < fb->h; j++) {
+                u |= (size_t) mpz_tstbit(e, j * fb->a + offset) << j;
+            }
+            if (u != 0) {
+                cfe_modctx_mul(ctx, acc, acc, fb->tables + (t * size + u) * n);
+                one = false;
+            }
+        }
+    }
+
+    cfe_modctx_get(ctx, res, acc);
+}
+
+size_t cfe_fixed_base_teeth(size_t mod_bits, size_t memory_budget) {
+    size_t elem_bytes = (mod_bits + GMP_NUMB_BITS - 1) / GMP_NUMB_BITS * sizeof(mp_limb_t);
+    size_t h = 1;
+    while (h < 16 && (CFE_FIXED_BASE_TABLES * elem_bytes << (h + 1)) <= memory_budget) {
+        h++;
+    }
+
+    return h;
+}
+
+void cfe_fixed_base_vec_init(cfe_fixed_base_vec *fbv, cfe_vec *bases, mpz_t p, size_t bits, size_t memory_budget) {
+    size_t h = CFE_FIXED_BASE_TEETH;
+    if (memory_budget > 0 && bases->size > 0) {
+        h = cfe_fixed_base_teeth(mpz_sizeinbase(p, 2), memory_budget / bases->size);
+    }
+
+    fbv->size = bases->size;
+    fbv->bases = (cfe_fixed_base *) cfe_malloc(bases->size * sizeof(cfe_fixed_base));
+    for (size_t i = 0; i < bases->size; i++) {
+        cfe_fixed_base_init_params(&fbv->bases[i], bases->vec[i], p, bits, h, CFE_FIXED_BASE_TABLES);
+    }
+}
+
+void cfe_fixed_base_vec_free(cfe_fixed_base_vec *fbv) {
+    for (size_t i = 0; i < fbv->size; i++) {
+        cfe_fixed_base_free(&fbv->bases[i]);
+    }
+    free(fbv->bases);
+}
+
+// the approximate number of multiplications for building a comb with h
+// teeth and v tables for exponents of the given bit length, and for a
+// single exponentiation with it
+static void cfe_fixed_base_cost(size_t bits, size_t h, size_t v, size_t *build, size_t *use) {
+    size_t a = (bits + h - 1) / h;
+    if (a == 0) {
+        a = 1;
+    }
+    size_t b = (a + v - 1) / v;
+    *build = h * a + ((size_t) 1 << h) * (1 + (v - 1) * b);
+    *use = b + v * b;
+}
+
+void cfe_fixed_base_vec_init_batch(cfe_fixed_base_vec *fbv, cfe_vec *bases, mpz_t p, size_t *bits, size_t uses) {
+    fbv->size = bases->size;
+    fbv->bases = (cfe_fixed_base *) cfe_malloc(bases->size * sizeof(cfe_fixed_base));
+    for (size_t i = 0; i < bases->size; i++) {
+        // larger combs would take megabytes for each base
+        size_t best_h = 1, best_v = 1, best = SIZE_MAX;
+        for (size_t h = 1; h <= 12; h++) {
+            for (size_t v = 1; v <= 4; v++) {
+                size_t build, use;
+                cfe_fixed_base_cost(bits[i], h, v, &build, &use);
+                if (build + uses * use < best) {
+                    best = build + uses * use;
+                    best_h = h;
+                    best_v = v;
+                }
+            }
+        }
+        cfe_fixed_base_init_params(&fbv->bases[i], bases->vec[i], p, bits[i], best_h, best_v);
+    }
+}
+
+cfe_error cfe_fixed_base_vec_powm(mpz_t res, cfe_fixed_base_vec *fbv, cfe_vec *exps) {
+    if (exps->size != fbv->size) {
+        return CFE_ERR_MALFORMED_INPUT;
+    }
+    mpz_set_ui(res, 1);
+    if (fbv->size == 0) {
+        return CFE_ERR_NONE;
+    }
+
+    cfe_error err = CFE_ERR_NONE;
+    mpz_ptr p = fbv->bases[0].p;
+    mpz_t e, pow, den;
+    mpz_inits(e, pow, den, NULL);
+    mpz_set_ui(den, 1);
+
+    // the powers with negative exponents are multiplied separately, so
+    // that a single inversion is needed
+    for (size_t i = 0; i < fbv->size; i++) {
+        int sgn = mpz_sgn(exps->vec[i]);
+        if (sgn == 0) {
+            continue;
+        }
+        mpz_abs(e, exps->vec[i]);
+        cfe_fixed_base_powm(pow, &fbv->bases[i], e);
+        mpz_ptr acc = sgn > 0 ? res : den;
+        mpz_mul(acc, acc, pow);
+        mpz_mod(acc, acc, p);
+    }
+
+    if (mpz_cmp_ui(den, 1) != 0) {
+        if (mpz_invert(den, den, p) == 0) {
+            err = CFE_ERR_NO_INVERSE;
+        } else {
+            mpz_mul(res, res, den);
+            mpz_mod(res, res, p);
+        }
+    }
+
+    mpz_clears(e, pow, den, NULL);
+
+    return err;
+}
+
+// a range of exponentiations computed by a single thread
+typedef struct cfe_fixed_base_vec_job {
+    cfe_fixed_base_vec *fbv;
+    mpz_t *res;
+    cfe_error *errs;
+    cfe_vec *exps;
+    size_t from;
+    size_t to;
+} cfe_fixed_base_vec_job;
+
+static void *cfe_fixed_base_vec_worker(void *arg) {
+    cfe_fixed_base_vec_job *job = (cfe_fixed_base_vec_job *) arg;
+    for (size_t k = job->from; k < job->to; k++) {
+        job->errs[k] = cfe_fixed_base_vec_powm(job->res[k], job->fbv, &job->exps[k]);
+    }
+
+    return NULL;
+}
+
+cfe_error cfe_fixed_base_vec_powm_batch(mpz_t *res, cfe_error *errs, cfe_fixed_base_vec *fbv, cfe_vec *exps,
+                                        size_t n, size_t num_threads) {
+    if (n == 0) {
+        return CFE_ERR_NONE;
+    }
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+    if (num_threads > n) {
+        num_threads = n;
+    }
+
+    cfe_error *errs_all = errs != NULL ? errs : (cfe_error *) cfe_malloc(n * sizeof(cfe_error));
+    cfe_fixed_base_vec_job *jobs = (cfe_fixed_base_vec_job *) cfe_malloc(num_threads * sizeof(cfe_fixed_base_vec_job));
+    for (size_t k = 0; k < num_threads; k++) {
+        jobs[k].fbv = fbv;
+        jobs[k].res = res;
+        jobs[k].errs = errs_all;
+        jobs[k].exps = exps;
+        jobs[k].from = k * n / num_threads;
+        jobs[k].to = (k + 1) * n / num_threads;
+    }
+    cfe_run_jobs(cfe_fixed_base_vec_worker, jobs, sizeof(cfe_fixed_base_vec_job), num_threads);
+
+    cfe_error err = CFE_ERR_NONE;
+    for (size_t k = 0; k < n && !err; k++) {
+        err = errs_all[k];
+    }
+
+    free(jobs);
+    if (errs == NULL) {
+        free(errs_all);
+    }
+
+    return err;
+}
+
+// a longest exponent with more than this many times the bits of all the
+// others is not interleaved with them
+#define CFE_MULTI_POWM_SEPARATE 4
+
+// the window size for an exponent of the given bit length, minimizing the
+// precomputation plus the expected number of multiplications
+static size_t cfe_multi_powm_window(size_t bits) {
+    if (bits < 16) {
+        return 1;
+    } else if (bits < 48) {
+        return 2;
+    } else if (bits < 140) {
+        return 3;
+    } else if (bits < 394) {
+        return 4;
+    } else if (bits < 1078) {
+        return 5;
+    }
+
+    return 6;
+}
+
+cfe_error cfe_multi_powm(mpz_t res, cfe_vec *bases, cfe_vec *exps, mpz_t m) {
+    cfe_modctx ctx;
+    if (cfe_modctx_init(&ctx, m)) {
+        return CFE_ERR_MALFORMED_INPUT;
+    }
+
+    cfe_error err = CFE_ERR_NONE;
+    size_t k = bases->size;
+    size_t n = ctx.n;
+    mpz_t *e = (mpz_t *) cfe_malloc(k * sizeof(mpz_t));
+    mpz_t *first = (mpz_t *) cfe_malloc(k * sizeof(mpz_t));
+    mp_limb_t **powers = (mp_limb_t **) cfe_malloc(k * sizeof(mp_limb_t *));
+    size_t *windows = (size_t *) cfe_malloc(k * sizeof(size_t));
+    size_t *neg = (size_t *) cfe_malloc(k * sizeof(size_t));
+    mp_limb_t *acc = cfe_modctx_alloc(&ctx, 1);
+    size_t neg_len = 0;
+    size_t max_bits = 0;
+    bool one = true;
+
+    mpz_t inv;
+    mpz_init(inv);
+
+    // find the longest exponent, and the length of the second longest
+    size_t longest = 0, second_bits = 0;
+    for (size_t i = 0; i < k; i++) {
+        mpz_inits(e[i], first[i], NULL);
+        powers[i] = NULL;
+        mpz_abs(e[i], exps->vec[i]);
+        size_t bits = mpz_sgn(e[i]) == 0 ? 0 : mpz_sizeinbase(e[i], 2);
+        if (bits > max_bits) {
+            second_bits = max_bits;
+            max_bits = bits;
+            longest = i;
+        } else if (bits > second_bits) {
+            second_bits = bits;
+        }
+    }
+
+    // a single long exponent (like a secret key next to the small
+    // coordinates of a vector) would make all the others wait for its
+    // squarings, which mpz_powm does faster on its own
+    bool separate = max_bits > CFE_MULTI_POWM_SEPARATE * second_bits && max_bits > 64;
+
+    // the first power of each base is its reduction modulo m, or the
+    // inverse of it if its exponent is negative
+    for (size_t i = 0; i < k; i++) {
+        size_t bits = mpz_sgn(e[i]) == 0 ? 0 : mpz_sizeinbase(e[i], 2);
+        if (separate && i == longest) {
+            bits = 1;
+        }
+        windows[i] = cfe_multi_powm_window(bits);
+        if (separate && i == longest) {
+            mpz_powm(first[i], bases->vec[i], e[i], m);
+            mpz_set_ui(e[i], 1);
+        } else {
+            mpz_mod(first[i], bases->vec[i], m);
+        }
+        if (mpz_sgn(exps->vec[i]) < 0) {
+            neg[neg_len++] = i;
+        }
+    }
+    if (separate) {
+        max_bits = second_bits > 1 ? second_bits : 1;
+    }
+
+    // invert the bases with negative exponents at once, from the products
+    // of the preceding bases
+    if (neg_len > 0) {
+        mpz_t *prods = (mpz_t *) cfe_malloc(neg_len * sizeof(mpz_t));
+        mpz_init_set(prods[0], first[neg[0]]);
+        for (size_t j = 1; j < neg_len; j++) {
+            mpz_init(prods[j]);
+            mpz_mul(prods[j], prods[j - 1], first[neg[j]]);
+            mpz_mod(prods[j], prods[j], m);
+        }
+        bool invertible = mpz_invert(inv, prods[neg_len - 1], m) != 0;
+        for (size_t j = neg_len - 1; invertible && j > 0; j--) {
+            mpz_mul(prods[j], inv, prods[j - 1]);
+            mpz_mod(prods[j], prods[j], m);
+            mpz_mul(inv, inv, first[neg[j]]);
+            mpz_mod(inv, inv, m);
+            mpz_swap(first[neg[j]], prods[j]);
+        }
+        if (invertible) {
+            mpz_swap(first[neg[0]], inv);
+        }
+        for (size_t j = 0; j < neg_len; j++) {
+            mpz_clear(prods[j]);
+        }
+        free(prods);
+        if (!invertible) {
+            err = CFE_ERR_NO_INVERSE;
+            goto cleanup;
+        }
+    }
+
+    // the powers b^d for digits d of the window, b^0 being unused
+    for (size_t i = 0; i < k; i++) {
+        size_t size = (size_t) 1 << windows[i];
+        powers[i] = cfe_modctx_alloc(&ctx, size);
+        cfe_modctx_set(&ctx, powers[i] + n, first[i]);
+        for (size_t d = 2; d < size; d++) {
+            cfe_modctx_mul(&ctx, powers[i] + d * n, powers[i] + (d - 1) * n, powers[i] + n);
+        }
+    }
+
+    // the digit of the exponent i at bit j is multiplied in when j is
+    // a multiple of its window size, and then squared j times
+    cfe_modctx_set_one(&ctx, acc);
+    for (size_t j = max_bits; j-- > 0;) {
+        if (!one) {
+            cfe_modctx_sqr(&ctx, acc, acc);
+        }
+        for (size_t i = 0; i < k; i++) {
+            if (j % windows[i] != 0) {
+                continue;
+            }
+            size_t digit = 0;
+            for (size_t b = windows[i]; b-- > 0;) {
+                digit = (digit << 1) | (size_t) mpz_tstbit(e[i], j + b);
+            }
+            if (digit != 0) {
+                cfe_modctx_mul(&ctx, acc, acc, powers[i] + digit * n);
+                one = false;
+            }
+        }
+    }
+
+    cfe_modctx_get(&ctx, res, acc);
+
+    cleanup:
+    for (size_t i = 0; i < k; i++) {
+        free(powers[i]);
+        mpz_clears(e[i], first[i], NULL);
+    }
+    free(powers);
+    free(windows);
+    free(neg);
+    free(first);
+    free(e);
+    free(acc);
+    mpz_clear(inv);
+    cfe_modctx_free(&ctx);
+
+    return err;
+}
+
+void cfe_small_powers_init_empty(cfe_small_powers *t, mpz_t p, mpz_t bound) {
+    mpz_init_set(t->p, p);
+    mpz_init_set(t->bound, bound);
+    mpz_abs(t->bound, t->bound);
+    t->low_bits = 0;
+    t->low_len = 0;
+    t->high_len = 0;
+    t->low = NULL;
+    t->high = NULL;
+}
+
+void cfe_small_powers_init(cfe_small_powers *t, mpz_t g, mpz_t p, mpz_t bound) {
+    cfe_small_powers_init_empty(t, p, bound);
+    if (mpz_sizeinbase(t->bound, 2) > CFE_SMALL_POWERS_MAX_BITS) {
+        return;
+    }
+
+    size_t range = 2 * mpz_get_ui(t->bound) + 1;
+    mpz_t step;
+    mpz_init(step);
+    mpz_neg(step, t->bound);
+
+    if (range <= CFE_SMALL_POWERS_SINGLE) {
+        // a single table of g^(j - bound)
+        t->low_len = range;
+        t->low = (mpz_t *) cfe_malloc(range * sizeof(mpz_t));
+        mpz_init(t->low[0]);
+        mpz_powm(t->low[0], g, step, p);
+        for (size_t j = 1; j < range; j++) {
+            mpz_init(t->low[j]);
+            mpz_mul(t->low[j], t->low[j - 1], g);
+            mpz_mod(t->low[j], t->low[j], p);
+        }
+        mpz_clear(step);
+        return;
+    }
+
+    size_t range_bits = 0;
+    while (((size_t) 1 << range_bits) < range) {
+        range_bits++;
+    }
+    t->low_bits = (range_bits + 1) / 2;
+    t->low_len = (size_t) 1 << t->low_bits;
+    t->high_len = ((range - 1) >> t->low_bits) + 1;
+    t->low = (mpz_t *) cfe_malloc(t->low_len * sizeof(mpz_t));
+    t->high = (mpz_t *) cfe_malloc(t->high_len * sizeof(mpz_t));
+
+    mpz_init_set_ui(t->low[0], 1);
+    for (size_t j = 1; j < t->low_len; j++) {
+        mpz_init(t->low[j]);
+        mpz_mul(t->low[j], t->low[j - 1], g);
+        mpz_mod(t->low[j], t->low[j], p);
+    }
+
+    // the high powers start at g^(-bound) and grow by g^(2^low_bits)
+    mpz_init(t->high[0]);
+    mpz_powm(t->high[0], g, step, p);
+    mpz_mul(step, t->low[t->low_len - 1], g);
+    mpz_mod(step, step, p);
+    for (size_t i = 1; i < t->high_len; i++) {
+        mpz_init(t->high[i]);
+        mpz_mul(t->high[i], t->high[i - 1], step);
+        mpz_mod(t->high[i], t->high[i], p);
+    }
+    mpz_clear(step);
+}
+
+void cfe_small_powers_copy(cfe_small_powers *res, cfe_small_powers *t) {
+    mpz_init_set(res->p, t->p);
+    mpz_init_set(res->bound, t->bound);
+    res->low_bits = t->low_bits;
+    res->low_len = t->low_len;
+    res->high_len = t->high_len;
+    res->low = NULL;
+    res->high = NULL;
+    if (t->low_len > 0) {
+        res->low = (mpz_t *) cfe_malloc(t->low_len * sizeof(mpz_t));
+        for (size_t j = 0; j < t->low_len; j++) {
+            mpz_init_set(res->low[j], t->low[j]);
+        }
+    }
+    if (t->high_len > 0) {
+        res->high = (mpz_t *) cfe_malloc(t->high_len * sizeof(mpz_t));
+        for (size_t i = 0; i < t->high_len; i++) {
+            mpz_init_set(res->high[i], t->high[i]);
+        }
+    }
+}
+
+void cfe_small_powers_free(cfe_small_powers *t) {
+    for (size_t j = 0; j < t->low_len; j++) {
+        mpz_clear(t->low[j]);
+    }
+    for (size_t i = 0; i < t->high_len; i++) {
+        mpz_clear(t->high[i]);
+    }
+    free(t->low);
+    free(t->high);
+    mpz_clears(t->p, t->bound, NULL);
+}
+
+bool cfe_small_powers_get(mpz_t res, cfe_small_powers *t, mpz_t k) {
+    if (t->low_len == 0 || mpz_cmpabs(k, t->bound) > 0) {
+        return false;
+    }
+
+    // k + bound fits into a machine word, since the bound is small
+    size_t e = mpz_get_ui(t->bound);
+    if (mpz_sgn(k) < 0) {
+        e -= mpz_get_ui(k);
+    } else {
+        e += mpz_get_ui(k);
+    }
+
+    if (t->high_len == 0) {
+        mpz_set(res, t->low[e]);
+        return true;
+    }
+
+    mpz_mul(res, t->high[e >> t->low_bits], t->low[e & (t->low_len - 1)]);
+    mpz_mod(res, res, t->p);
+    return true;
+}
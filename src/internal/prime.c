@@ -14,12 +14,16 @@
  * limitations under the License.
  */
 
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sodium.h>
 
 #include "cifer/internal/common.h"
 #include "cifer/internal/prime.h"
+#include "cifer/internal/prime_cache.h"
 
 // Checks if p is a safe prime, e.g. if (p-1)/2 is also a prime.
 bool cfe_is_safe_prime(mpz_t p) {
@@ -40,111 +44,207 @@ bool cfe_is_safe_prime(mpz_t p) {
     return false;
 }
 
-uint64_t small_primes[15] = {3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53};
-uint64_t small_primes_product = 16294579238595022365u;
+static size_t cfe_prime_num_threads = 1;
 
-// Finds a prime number of specified bit length.
-// If the safe parameter is true, the prime will be a safe prime, e.g a prime p
-// where (p-1)/2 is also a prime.
-// The prime is assigned to the argument n.
-// Returns 0 on success, and some other value != 0 on failure.
-// adapted from https://github.com/xlab-si/emmy/blob/master/crypto/common/primes.go
-cfe_error cfe_get_prime(mpz_t res, size_t bits, bool safe) {
-    if (bits < 2) {
-        return CFE_ERR_PRECONDITION_FAILED;
-    }
+void cfe_prime_set_num_threads(size_t num_threads) {
+    cfe_prime_num_threads = num_threads > 0 ? num_threads : 1;
+}
 
-    // if we are generating a safe prime, decrease the number of bits by 1
-    // as we are actually generating a germain prime and then modifying it to be safe
-    // the safe prime will have the correct amount of bits
-    size_t n_bits = safe ? bits - 1 : bits;
-    size_t n_bytes = (bits + 7) / 8;
-    uint8_t *bytes = (uint8_t *) cfe_malloc(n_bytes * sizeof(uint8_t));
+size_t cfe_prime_get_num_threads(void) {
+    return cfe_prime_num_threads;
+}
 
+// the state of a search shared by all the threads; the threads stop as soon
+// as any of them finds a prime
+typedef struct cfe_prime_search {
+    atomic_bool found;
+    pthread_mutex_t lock;
+    mpz_ptr res;
+    size_t n_bits; // bit length of the prime p, or of (p-1)/2 for a safe prime
+    bool safe;
+    uint32_t *primes; // odd primes by which the candidates are sieved
+    size_t num_primes;
+} cfe_prime_search;
+
+// a thread of the search only holds a pointer to the shared state
+typedef struct cfe_prime_job {
+    cfe_prime_search *search;
+} cfe_prime_job;
+
+// sets p to a random odd number of n_bits bits with the two highest bits set
+static void cfe_prime_random_start(mpz_t p, size_t n_bits, uint8_t *bytes, size_t n_bytes) {
     size_t b = n_bits % 8;
     if (b == 0) {
         b = 8;
     }
 
-    mpz_t p, p_safe, big_mod;
-    mpz_inits(p, p_safe, big_mod, NULL);
-
-    while (true) {
-        randombytes_buf(bytes, n_bytes);
+    randombytes_buf(bytes, n_bytes);
+    bytes[0] &= (uint8_t) ((1 << b) - 1);
+    if (b >= 2) {
+        bytes[0] |= 3 << (b - 2);
+    } else {
+        bytes[0] |= 1;
+        if (n_bytes > 1) {
+            bytes[1] |= 0x80;
+        }
+    }
+    bytes[n_bytes - 1] |= 1;
 
-        bytes[0] &= (uint8_t) ((1 << b) - 1);
+    mpz_import(p, n_bytes, 1, 1, 0, 0, bytes);
+}
 
-        if (b >= 2) {
-            bytes[0] |= 3 << (b - 2);
-        } else {
-            bytes[0] |= 1;
-            if (n_bytes > 1) {
-                bytes[1] |= 0x80;
+static void *cfe_prime_worker(void *arg) {
+    cfe_prime_search *search = ((cfe_prime_job *) arg)->search;
+    size_t n_bytes = (search->n_bits + 7) / 8;
+    uint8_t *bytes = (uint8_t *) cfe_malloc(n_bytes * sizeof(uint8_t));
+    uint8_t *composite = (uint8_t *) cfe_malloc(CFE_PRIME_SIEVE_SIZE * sizeof(uint8_t));
+
+    mpz_t start, p, p_safe, two, tmp;
+    mpz_inits(start, p, p_safe, two, tmp, NULL);
+    mpz_set_ui(two, 2);
+
+    while (!atomic_load_explicit(&search->found, memory_order_relaxed)) {
+        cfe_prime_random_start(start, search->n_bits, bytes, n_bytes);
+
+        // mark the candidates start + 2j which are divisible by one of the
+        // small primes, and for a safe prime also those for which
+        // 2 * (start + 2j) + 1 is; all the candidates are larger than the
+        // small primes, so they are composite
+        memset(composite, 0, CFE_PRIME_SIEVE_SIZE);
+        for (size_t i = 0; i < search->num_primes; i++) {
+            uint64_t q = search->primes[i];
+            uint64_t r = mpz_fdiv_ui(start, q);
+            uint64_t half = (q + 1) / 2; // the inverse of 2 modulo q
+            for (uint64_t j = (q - r) % q * half % q; j < CFE_PRIME_SIEVE_SIZE; j += q) {
+                composite[j] = 1;
+            }
+            if (search->safe) {
+                for (uint64_t j = (2 * q - half - r) % q * half % q; j < CFE_PRIME_SIEVE_SIZE; j += q) {
+                    composite[j] = 1;
+                }
             }
         }
 
-        bytes[n_bytes - 1] |= 1;
+        for (size_t j = 0; j < CFE_PRIME_SIEVE_SIZE; j++) {
+            if (composite[j]) {
+                continue;
+            }
+            if (atomic_load_explicit(&search->found, memory_order_relaxed)) {
+                break;
+            }
 
-        mpz_import(p, n_bytes, 1, 1, 0, 0, bytes);
+            mpz_add_ui(p, start, 2 * j);
+            if (mpz_sizeinbase(p, 2) != search->n_bits) {
+                break;
+            }
 
-        uint64_t mod = mpz_mod_ui(big_mod, p, small_primes_product);
+            // a cheap Fermat test for both numbers before the full tests
+            mpz_sub_ui(tmp, p, 1);
+            mpz_powm(tmp, two, tmp, p);
+            if (mpz_cmp_ui(tmp, 1) != 0) {
+                continue;
+            }
+            if (search->safe) {
+                mpz_mul_2exp(p_safe, p, 1);
+                mpz_add_ui(p_safe, p_safe, 1);
+                mpz_sub_ui(tmp, p_safe, 1);
+                mpz_powm(tmp, two, tmp, p_safe);
+                if (mpz_cmp_ui(tmp, 1) != 0) {
+                    continue;
+                }
+            }
 
-        for (uint64_t delta = 0; delta < (1 << 20); delta += 2) {
-            uint64_t m = mod + delta;
-            bool candidate = true;
+            if (!mpz_probab_prime_p(p, 30) || (search->safe && !mpz_probab_prime_p(p_safe, 50))) {
+                continue;
+            }
 
-            for (size_t i = 0; i < 15; i++) {
-                uint64_t prime = small_primes[i];
+            pthread_mutex_lock(&search->lock);
+            if (!atomic_load(&search->found)) {
+                mpz_set(search->res, search->safe ? p_safe : p);
+                atomic_store(&search->found, true);
+            }
+            pthread_mutex_unlock(&search->lock);
+            break;
+        }
+    }
 
-                if (m % prime == 0 && (n_bits > 6 || m != prime)) {
-                    candidate = false;
-                    break;
-                }
+    mpz_clears(start, p, p_safe, two, tmp, NULL);
+    free(bytes);
+    free(composite);
+    return NULL;
+}
 
-                if (safe) {
-                    uint64_t m1 = (2 * m + 1) % small_primes_product;
+// sets primes to all the odd primes below limit and returns their number
+static size_t cfe_prime_small_primes(uint32_t *primes, uint32_t limit) {
+    uint8_t *composite = (uint8_t *) cfe_malloc(limit * sizeof(uint8_t));
+    memset(composite, 0, limit);
 
-                    if (m1 % prime == 0 && (n_bits > 6 || m1 != prime)) {
-                        candidate = false;
-                        break;
-                    }
-                }
+    size_t num = 0;
+    for (uint32_t i = 3; i < limit; i += 2) {
+        if (composite[i]) {
+            continue;
+        }
+        primes[num++] = i;
+        for (uint64_t j = (uint64_t) i * i; j < limit; j += 2 * i) {
+            composite[j] = 1;
+        }
+    }
 
-            }
+    free(composite);
+    return num;
+}
 
-            if (candidate) {
-                if (delta > 0) {
-                    mpz_set_ui(big_mod, delta);
-                    mpz_add(p, p, big_mod);
-                }
+cfe_error cfe_get_prime(mpz_t res, size_t bits, bool safe) {
+    if (cfe_prime_cache_take_registered(res, bits, safe)) {
+        return CFE_ERR_NONE;
+    }
 
-                if (safe) {
-                    mpz_mul_ui(p_safe, p, 2);
-                    mpz_add_ui(p_safe, p_safe, 1);
-                }
-                break;
-            }
-        }
+    return cfe_get_prime_parallel(res, bits, safe, 0);
+}
 
-        if (mpz_probab_prime_p(p, 10) && mpz_sizeinbase(p, 2) == n_bits) {
-            if (!safe) {
-                if (mpz_probab_prime_p(p, 30)) {
-                    break;
-                }
-            } else if (mpz_probab_prime_p(p_safe, 50) && mpz_probab_prime_p(p, 30)) {
-                break;
-            }
-        }
+// Finds a prime number of specified bit length.
+// If the safe parameter is true, the prime will be a safe prime, e.g a prime p
+// where (p-1)/2 is also a prime.
+// Each thread sieves a window of candidates following a random start by
+// the small primes, and tests the remaining ones with a Fermat test before
+// the probabilistic primality tests.
+// adapted from https://github.com/xlab-si/emmy/blob/master/crypto/common/primes.go
+cfe_error cfe_get_prime_parallel(mpz_t res, size_t bits, bool safe, size_t num_threads) {
+    if (bits < 2 || (safe && bits < 3)) {
+        return CFE_ERR_PRECONDITION_FAILED;
+    }
+    if (num_threads == 0) {
+        num_threads = cfe_prime_num_threads;
     }
 
-    if (safe) {
-        mpz_set(res, p_safe);
-    } else {
-        mpz_set(res, p);
+    // if we are generating a safe prime, decrease the number of bits by 1
+    // as we are actually generating a germain prime and then modifying it to be safe
+    // the safe prime will have the correct amount of bits
+    cfe_prime_search search;
+    atomic_init(&search.found, false);
+    pthread_mutex_init(&search.lock, NULL);
+    search.res = res;
+    search.n_bits = safe ? bits - 1 : bits;
+    search.safe = safe;
+
+    // the candidates are at least 2^(n_bits - 1), so the small primes
+    // must be below that
+    uint32_t limit = CFE_PRIME_SIEVE_LIMIT;
+    if (search.n_bits - 1 < 32 && ((uint64_t) 1 << (search.n_bits - 1)) < limit) {
+        limit = (uint32_t) 1 << (search.n_bits - 1);
     }
+    search.primes = (uint32_t *) cfe_malloc((limit / 2 + 1) * sizeof(uint32_t));
+    search.num_primes = cfe_prime_small_primes(search.primes, limit);
 
-    free(bytes);
-    mpz_clears(p, p_safe, big_mod, NULL);
+    cfe_prime_job *jobs = (cfe_prime_job *) cfe_malloc(num_threads * sizeof(cfe_prime_job));
+    for (size_t k = 0; k < num_threads; k++) {
+        jobs[k].search = &search;
+    }
+    cfe_run_jobs(cfe_prime_worker, jobs, sizeof(cfe_prime_job), num_threads);
+
+    free(jobs);
+    free(search.primes);
+    pthread_mutex_destroy(&search.lock);
 
     if (mpz_sizeinbase(res, 2) != bits) {
         return CFE_ERR_PRIME_GEN_FAILED;
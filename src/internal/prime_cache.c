@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) 2018 XLAB d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// open, fdopen and getline are not part of C11, and flock is not part of
+// POSIX
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cifer/internal/common.h"
+#include "cifer/internal/prime.h"
+#include "cifer/internal/prime_cache.h"
+
+// the registered caches, consulted by cfe_get_prime; a cache in use by
+// cfe_get_prime has a positive refs count and is not freed until it drops
+static cfe_prime_cache *cfe_prime_caches = NULL;
+static pthread_mutex_t cfe_prime_caches_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cfe_prime_caches_released = PTHREAD_COND_INITIALIZER;
+
+// searches for a fresh prime of the cache
+static void cfe_prime_cache_fill_elem(cfe_vec *elem, void *data) {
+    cfe_prime_cache *c = (cfe_prime_cache *) data;
+    cfe_get_prime_parallel(elem->vec[0], c->bits, c->safe, 1);
+}
+
+// checks a prime read from the file as thoroughly as a generated one, since
+// the file might have been tampered with
+static bool cfe_prime_cache_valid(cfe_prime_cache *c, mpz_t p) {
+    if (mpz_sgn(p) <= 0 || mpz_sizeinbase(p, 2) != c->bits) {
+        return false;
+    }
+
+    return c->safe ? cfe_is_safe_prime(p) : mpz_probab_prime_p(p, 30) > 0;
+}
+
+// returns a newly allocated string of path followed by suffix
+static char *cfe_prime_cache_path(const char *path, const char *suffix) {
+    size_t path_len = strlen(path);
+    size_t suffix_len = strlen(suffix);
+    char *res = (char *) cfe_malloc(path_len + suffix_len + 1);
+    memcpy(res, path, path_len);
+    memcpy(res + path_len, suffix, suffix_len + 1);
+
+    return res;
+}
+
+// adds a prime loaded from the file to the pool, unless it is full
+static void cfe_prime_cache_put(cfe_prime_cache *c, mpz_t p) {
+    cfe_pool *pool = &c->pool;
+    pthread_mutex_lock(&pool->lock);
+    if (pool->len < pool->capacity) {
+        mpz_set(pool->elems[(pool->head + pool->len) % pool->capacity].vec[0], p);
+        pool->len++;
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// reads the valid primes of the file into the pool
+static cfe_error cfe_prime_cache_load(cfe_prime_cache *c) {
+    FILE *f = fopen(c->path, "r");
+    if (f == NULL) {
+        // no primes have been kept yet
+        return CFE_ERR_NONE;
+    }
+
+    char *line = NULL;
+    size_t line_size = 0;
+    ssize_t line_len;
+    mpz_t p;
+    mpz_init(p);
+    while (cfe_pool_len(&c->pool) < c->pool.capacity && (line_len = getline(&line, &line_size, f)) > 0) {
+        if (line[line_len - 1] == '\n') {
+            line[line_len - 1] = '\0';
+        }
+        if (mpz_set_str(p, line, 16) == 0 && cfe_prime_cache_valid(c, p)) {
+            cfe_prime_cache_put(c, p);
+        }
+    }
+    mpz_clear(p);
+    free(line);
+
+    cfe_error err = ferror(f) ? CFE_ERR_INIT : CFE_ERR_NONE;
+    fclose(f);
+
+    return err;
+}
+
+// locks the lock file of the cache, failing if any other cache holds it
+static cfe_error cfe_prime_cache_lock_file(cfe_prime_cache *c) {
+    char *lock_path = cfe_prime_cache_path(c->path, ".lock");
+    c->lock_fd = open(lock_path, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+    free(lock_path);
+    if (c->lock_fd < 0) {
+        return CFE_ERR_INIT;
+    }
+    if (flock(c->lock_fd, LOCK_EX | LOCK_NB) != 0) {
+        close(c->lock_fd);
+        c->lock_fd = -1;
+        return CFE_ERR_INIT;
+    }
+
+    return CFE_ERR_NONE;
+}
+
+cfe_error cfe_prime_cache_init(cfe_prime_cache *c, size_t bits, bool safe, size_t capacity, const char *path,
+                               bool background) {
+    if (bits < 2 || (safe && bits < 3)) {
+        return CFE_ERR_PRECONDITION_FAILED;
+    }
+
+    c->bits = bits;
+    c->safe = safe;
+    c->path = NULL;
+    c->lock_fd = -1;
+    c->refs = 0;
+    c->next = NULL;
+
+    if (path != NULL) {
+        c->path = cfe_prime_cache_path(path, "");
+        cfe_error err = cfe_prime_cache_lock_file(c);
+        if (err) {
+            free(c->path);
+            return err;
+        }
+    }
+
+    // the primes kept in the file are loaded before the background thread
+    // starts, so that they are not crowded out by fresh ones
+    pthread_mutex_init(&c->file_lock, NULL);
+    cfe_pool_init(&c->pool, capacity, 1, cfe_prime_cache_fill_elem, NULL, c, false);
+    if (c->path != NULL) {
+        cfe_error err = cfe_prime_cache_load(c);
+        if (err) {
+            cfe_pool_free(&c->pool);
+            pthread_mutex_destroy(&c->file_lock);
+            close(c->lock_fd);
+            free(c->path);
+            return err;
+        }
+    }
+    if (background) {
+        cfe_pool_start(&c->pool);
+    }
+
+    return CFE_ERR_NONE;
+}
+
+// copies the primes in the pool, from the oldest one, into primes, which
+// holds capacity initialized vectors, and returns their number
+static size_t cfe_prime_cache_peek(cfe_prime_cache *c, cfe_vec *primes) {
+    cfe_pool *pool = &c->pool;
+    pthread_mutex_lock(&pool->lock);
+    size_t len = pool->len;
+    for (size_t i = 0; i < len; i++) {
+        cfe_vec_copy(&primes[i], &pool->elems[(pool->head + i) % pool->capacity]);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return len;
+}
+
+// writes the primes in the pool to the file; file_lock must be held, so
+// that no prime is taken between copying the pool and writing the file
+static cfe_error cfe_prime_cache_write(cfe_prime_cache *c) {
+    if (c->path == NULL) {
+        return CFE_ERR_NONE;
+    }
+
+    size_t capacity = c->pool.capacity;
+    cfe_vec *primes = (cfe_vec *) cfe_malloc(capacity * sizeof(cfe_vec));
+    for (size_t i = 0; i < capacity; i++) {
+        cfe_vec_init(&primes[i], 1);
+    }
+    size_t len = cfe_prime_cache_peek(c, primes);
+
+    // the primes are written to a temporary file which then replaces the
+    // file, so that a crash never leaves a partly written file behind
+    char *tmp_path = cfe_prime_cache_path(c->path, ".tmp");
+    cfe_error err = CFE_ERR_NONE;
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    FILE *f = fd >= 0 ? fdopen(fd, "w") : NULL;
+    if (f == NULL) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        err = CFE_ERR_INIT;
+        goto cleanup;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (mpz_out_str(f, 16, primes[i].vec[0]) == 0 || fputc('\n', f) == EOF) {
+            err = CFE_ERR_INIT;
+        }
+    }
+    if (fclose(f) != 0) {
+        err = CFE_ERR_INIT;
+    }
+    if (err || rename(tmp_path, c->path) != 0) {
+        remove(tmp_path);
+        err = CFE_ERR_INIT;
+    }
+
+    cleanup:
+    for (size_t i = 0; i < capacity; i++) {
+        cfe_vec_free(&primes[i]);
+    }
+    free(primes);
+    free(tmp_path);
+    return err;
+}
+
+// takes a prime out of the pool and removes it from the file before it is
+// handed out; if the file cannot be written, it is removed altogether
+static bool cfe_prime_cache_try_take(cfe_vec *elem, cfe_prime_cache *c) {
+    pthread_mutex_lock(&c->file_lock);
+    bool taken = cfe_pool_try_take(elem, &c->pool);
+    if (taken && cfe_prime_cache_write(c) != CFE_ERR_NONE) {
+        remove(c->path);
+    }
+    pthread_mutex_unlock(&c->file_lock);
+
+    return taken;
+}
+
+cfe_error cfe_prime_cache_fill(cfe_prime_cache *c) {
+    cfe_pool_fill(&c->pool);
+    return cfe_prime_cache_save(c);
+}
+
+void cfe_prime_cache_take(mpz_t res, cfe_prime_cache *c) {
+    cfe_vec elem;
+    cfe_vec_init(&elem, 1);
+    if (!cfe_prime_cache_try_take(&elem, c)) {
+        cfe_prime_cache_fill_elem(&elem, c);
+    }
+    mpz_set(res, elem.vec[0]);
+    cfe_vec_free(&elem);
+}
+
+size_t cfe_prime_cache_len(cfe_prime_cache *c) {
+    return cfe_pool_len(&c->pool);
+}
+
+cfe_error cfe_prime_cache_save(cfe_prime_cache *c) {
+    pthread_mutex_lock(&c->file_lock);
+    cfe_error err = cfe_prime_cache_write(c);
+    pthread_mutex_unlock(&c->file_lock);
+
+    return err;
+}
+
+void cfe_prime_cache_register(cfe_prime_cache *c) {
+    pthread_mutex_lock(&cfe_prime_caches_lock);
+    c->next = cfe_prime_caches;
+    cfe_prime_caches = c;
+    pthread_mutex_unlock(&cfe_prime_caches_lock);
+}
+
+void cfe_prime_cache_unregister(cfe_prime_cache *c) {
+    pthread_mutex_lock(&cfe_prime_caches_lock);
+    for (cfe_prime_cache **it = &cfe_prime_caches; *it != NULL; it = &(*it)->next) {
+        if (*it == c) {
+            *it = c->next;
+            c->next = NULL;
+            break;
+        }
+    }
+    while (c->refs > 0) {
+        pthread_cond_wait(&cfe_prime_caches_released, &cfe_prime_caches_lock);
+    }
+    pthread_mutex_unlock(&cfe_prime_caches_lock);
+}
+
+bool cfe_prime_cache_take_registered(mpz_t res, size_t bits, bool safe) {
+    // the cache is pinned while the registry is locked, and the prime is
+    // taken and the file written without holding the registry lock, so
+    // that other searches do not wait for the disk
+    pthread_mutex_lock(&cfe_prime_caches_lock);
+    cfe_prime_cache *c = cfe_prime_caches;
+    while (c != NULL && (c->bits != bits || c->safe != safe || cfe_pool_len(&c->pool) == 0)) {
+        c = c->next;
+    }
+    if (c != NULL) {
+        c->refs++;
+    }
+    pthread_mutex_unlock(&cfe_prime_caches_lock);
+    if (c == NULL) {
+        return false;
+    }
+
+    cfe_vec elem;
+    cfe_vec_init(&elem, 1);
+    bool taken = cfe_prime_cache_try_take(&elem, c);
+    if (taken) {
+        mpz_set(res, elem.vec[0]);
+    }
+    cfe_vec_free(&elem);
+
+    pthread_mutex_lock(&cfe_prime_caches_lock);
+    c->refs--;
+    pthread_cond_broadcast(&cfe_prime_caches_released);
+    pthread_mutex_unlock(&cfe_prime_caches_lock);
+
+    return taken;
+}
+
+void cfe_prime_cache_free(cfe_prime_cache *c) {
+    cfe_prime_cache_unregister(c);
+    cfe_prime_cache_save(c);
+    cfe_pool_free(&c->pool);
+    pthread_mutex_destroy(&c->file_lock);
+    if (c->lock_fd >= 0) {
+        close(c->lock_fd);
+    }
+    free(c->path);
+}
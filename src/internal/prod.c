@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2018 XLAB d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+
+#include "cifer/internal/common.h"
+#include "cifer/internal/modctx.h"
+#include "cifer/internal/prod.h"
+
+// a range of vectors multiplied by a single thread; for every coordinate j
+// the thread stores the product of the j-th coordinates of the range into
+// out, as an element in Montgomery form
+typedef struct cfe_prod_job {
+    cfe_modctx *ctx;
+    cfe_vec *vecs;
+    size_t from;
+    size_t to;
+    mp_limb_t *out;
+} cfe_prod_job;
+
+// copies a mod m into n limbs; the limbs are read as an element in
+// Montgomery form, that is as the Montgomery form of a/R
+static void cfe_prod_load(cfe_modctx *ctx, mp_limb_t *r, mpz_t a, mpz_t m, mpz_t tmp) {
+    mpz_ptr x = a;
+    if (mpz_sgn(a) < 0 || mpz_cmp(a, m) >= 0) {
+        mpz_mod(tmp, a, m);
+        x = tmp;
+    }
+
+    size_t size = mpz_size(x);
+    mpn_copyi(r, mpz_limbs_read(x), size);
+    mpn_zero(r + size, ctx->n - size);
+}
+
+static void *cfe_prod_worker(void *arg) {
+    cfe_prod_job *job = (cfe_prod_job *) arg;
+    cfe_modctx *ctx = job->ctx;
+    size_t n = ctx->n;
+    size_t size = job->vecs[0].size;
+    mp_limb_t *x = cfe_modctx_alloc(ctx, 1);
+
+    mpz_t m, tmp;
+    mpz_roinit_n(m, ctx->m, (mp_size_t) n);
+    mpz_init(tmp);
+
+    for (size_t j = 0; j < size; j++) {
+        mp_limb_t *acc = job->out + j * n;
+        cfe_prod_load(ctx, acc, job->vecs[job->from].vec[j], m, tmp);
+        for (size_t i = job->from + 1; i < job->to; i++) {
+            cfe_prod_load(ctx, x, job->vecs[i].vec[j], m, tmp);
+            cfe_modctx_mul(ctx, acc, acc, x);
+        }
+    }
+
+    free(x);
+    mpz_clear(tmp);
+
+    return NULL;
+}
+
+cfe_error cfe_vec_prod_mod(cfe_vec *res, cfe_vec *vecs, size_t n, mpz_t m, size_t num_threads) {
+    if (n == 0) {
+        return CFE_ERR_MALFORMED_INPUT;
+    }
+    size_t size = vecs[0].size;
+    for (size_t i = 0; i < n; i++) {
+        if (vecs[i].size != size) {
+            return CFE_ERR_MALFORMED_INPUT;
+        }
+    }
+    if (res->size != size) {
+        return CFE_ERR_MALFORMED_INPUT;
+    }
+
+    cfe_modctx ctx;
+    if (cfe_modctx_init(&ctx, m)) {
+        return CFE_ERR_MALFORMED_INPUT;
+    }
+
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+    if (num_threads > n / CFE_PROD_MIN_PER_THREAD) {
+        num_threads = n / CFE_PROD_MIN_PER_THREAD > 0 ? n / CFE_PROD_MIN_PER_THREAD : 1;
+    }
+
+    // every thread gets its own range of vectors and its own partial
+    // products, so no synchronization is needed
+    size_t limbs = size * ctx.n;
+    mp_limb_t *partial = cfe_modctx_alloc(&ctx, num_threads * size);
+    cfe_prod_job *jobs = (cfe_prod_job *) cfe_malloc(num_threads * sizeof(cfe_prod_job));
+    for (size_t k = 0; k < num_threads; k++) {
+        jobs[k].ctx = &ctx;
+        jobs[k].vecs = vecs;
+        jobs[k].from = k * n / num_threads;
+        jobs[k].to = (k + 1) * n / num_threads;
+        jobs[k].out = partial + k * limbs;
+    }
+
+    cfe_run_jobs(cfe_prod_worker, jobs, sizeof(cfe_prod_job), num_threads);
+
+    // combine the partial products pairwise
+    for (size_t step = 1; step < num_threads; step *= 2) {
+        for (size_t k = 0; k + step < num_threads; k += 2 * step) {
+            for (size_t j = 0; j < size; j++) {
+                cfe_modctx_mul(&ctx, partial + k * limbs + j * ctx.n, partial + k * limbs + j * ctx.n,
+                               partial + (k + step) * limbs + j * ctx.n);
+            }
+        }
+    }
+
+    // the limbs of the product represent the product of a_i/R over all
+    // the n coordinates a_i, so multiplying it by the Montgomery form of
+    // R^n gives the Montgomery form of the product of a_i
+    mpz_t radix;
+    mpz_init(radix);
+    mpz_setbit(radix, ctx.n * GMP_NUMB_BITS);
+    mpz_powm_ui(radix, radix, n, m);
+    mp_limb_t *fix = cfe_modctx_alloc(&ctx, 1);
+    cfe_modctx_set(&ctx, fix, radix);
+    for (size_t j = 0; j < size; j++) {
+        cfe_modctx_mul(&ctx, partial + j * ctx.n, partial + j * ctx.n, fix);
+        cfe_modctx_get(&ctx, res->vec[j], partial + j * ctx.n);
+    }
+
+    mpz_clear(radix);
+    free(fix);
+    free(partial);
+    free(jobs);
+    cfe_modctx_free(&ctx);
+
+    return CFE_ERR_NONE;
+}
@@ -172,12 +172,13 @@ cfe_error cfe_sgp_encrypt(cfe_sgp_cipher *cipher, cfe_sgp *s, cfe_vec *x, cfe_ve
     return CFE_ERR_NONE;
 }
 
-cfe_error cfe_sgp_decrypt(mpz_t res, cfe_sgp *s, cfe_sgp_cipher *cipher, ECP2_BN254 *key, cfe_mat *f) {
-    FP12_BN254 prod;
-    PAIR_BN254_ate(&prod, key, &(cipher->g1MulGamma));
-    PAIR_BN254_fexp(&prod);
-    mpz_t el, res_bound;
-    mpz_inits(el, res_bound, NULL);
+// computes prod = e(g1, g2)^(x*f*y), whose discrete logarithm is the result
+// of the decryption
+static void cfe_sgp_decrypt_elem(FP12_BN254 *prod, cfe_sgp_cipher *cipher, ECP2_BN254 *key, cfe_mat *f) {
+    PAIR_BN254_ate(prod, key, &(cipher->g1MulGamma));
+    PAIR_BN254_fexp(prod);
+    mpz_t el;
+    mpz_init(el);
     ECP2_BN254 t2, t4;
     FP12_BN254 p1, p2, r;
     BIG_256_56 el_b;
@@ -225,25 +226,73 @@ cfe_error cfe_sgp_decrypt(mpz_t res, cfe_sgp *s, cfe_sgp_cipher *cipher, ECP2_BN
 
                 BIG_256_56_from_mpz(el_b, el);
                 FP12_BN254_pow(&r, &p1, el_b);
-                FP12_BN254_mul(&prod, &r); // prod stores the multiplied value
+                FP12_BN254_mul(prod, &r); // prod stores the multiplied value
             }
         }
     }
 
+    mpz_clear(el);
+}
+
+// sets gt = e(g1, g2) and res_bound to the bound on the result
+static void cfe_sgp_dlog_params(FP12_BN254 *gt, mpz_t res_bound, cfe_sgp *s) {
     ECP_BN254 g1;
     ECP_BN254_generator(&g1);
     ECP2_BN254 g2;
     ECP2_BN254_generator(&g2);
 
-    FP12_BN254 gt;
-    PAIR_BN254_ate(&gt, &g2, &g1);
-    PAIR_BN254_fexp(&gt);
+    PAIR_BN254_ate(gt, &g2, &g1);
+    PAIR_BN254_fexp(gt);
 
     mpz_pow_ui(res_bound, s->bound, 3);
     mpz_mul_ui(res_bound, res_bound, s->l * s->l);
+}
+
+cfe_error cfe_sgp_decrypt(mpz_t res, cfe_sgp *s, cfe_sgp_cipher *cipher, ECP2_BN254 *key, cfe_mat *f) {
+    return cfe_sgp_decrypt_with_config(res, s, cipher, key, f, NULL);
+}
+
+cfe_error cfe_sgp_decrypt_with_config(mpz_t res, cfe_sgp *s, cfe_sgp_cipher *cipher, ECP2_BN254 *key, cfe_mat *f,
+                                      cfe_dlog_config *c) {
+    FP12_BN254 prod, gt;
+    cfe_sgp_decrypt_elem(&prod, cipher, key, f);
+
+    mpz_t res_bound;
+    mpz_init(res_bound);
+    cfe_sgp_dlog_params(&gt, res_bound, s);
 
     cfe_error err;
-    err = cfe_baby_giant_FP12_BN256_with_neg(res, &prod, &gt, res_bound);
-    mpz_clears(el, res_bound, NULL);
+    err = cfe_dlog_FP12_BN254_with_neg(res, &prod, &gt, res_bound, c);
+    mpz_clear(res_bound);
     return err;
 }
+
+cfe_error cfe_sgp_dlog_table_init(cfe_dlog_table_FP12_BN254 *t, cfe_sgp *s) {
+    FP12_BN254 gt;
+    mpz_t res_bound;
+    mpz_init(res_bound);
+    cfe_sgp_dlog_params(&gt, res_bound, s);
+
+    cfe_error err = cfe_dlog_table_FP12_BN254_init(t, &gt, res_bound);
+    mpz_clear(res_bound);
+    return err;
+}
+
+cfe_error cfe_sgp_dlog_table_load(cfe_dlog_table_FP12_BN254 *t, const char *path, cfe_sgp *s) {
+    FP12_BN254 gt;
+    mpz_t res_bound;
+    mpz_init(res_bound);
+    cfe_sgp_dlog_params(&gt, res_bound, s);
+
+    cfe_error err = cfe_dlog_table_FP12_BN254_load(t, path, &gt, res_bound);
+    mpz_clear(res_bound);
+    return err;
+}
+
+cfe_error cfe_sgp_decrypt_with_table(mpz_t res, cfe_sgp_cipher *cipher, ECP2_BN254 *key, cfe_mat *f,
+                                     cfe_dlog_table_FP12_BN254 *t) {
+    FP12_BN254 prod;
+    cfe_sgp_decrypt_elem(&prod, cipher, key, f);
+
+    return cfe_dlog_table_FP12_BN254_solve_with_neg(res, &prod, t);
+}
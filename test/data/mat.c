@@ -386,6 +386,40 @@ MunitResult test_matrix_mul(const MunitParameter *params, void *data) {
     return MUNIT_OK;
 }
 
+MunitResult test_matrix_mul_mod(const MunitParameter *params, void *data) {
+    mpz_t lower, upper, mod;
+    mpz_inits(lower, upper, mod, NULL);
+    mpz_set_si(lower, -1000);
+    mpz_set_ui(upper, 1000);
+    mpz_set_ui(mod, 1009);
+
+    // more columns than a single block
+    cfe_mat m1, m2, res, expected, product;
+    cfe_mat_init(&m1, 7, 5);
+    cfe_mat_init(&m2, 5, CFE_MAT_BLOCK + 3);
+    cfe_mat_inits(7, CFE_MAT_BLOCK + 3, &res, &expected, &product, NULL);
+    cfe_uniform_sample_range_mat(&m1, lower, upper);
+    cfe_uniform_sample_range_mat(&m2, lower, upper);
+    mpz_set_ui(m1.mat[2].vec[3], 0);
+
+    cfe_mat_mul(&product, &m1, &m2);
+    cfe_mat_mod(&expected, &product, mod);
+
+    for (size_t threads = 0; threads <= 8; threads += 4) {
+        cfe_mat_mul_mod(&res, &m1, &m2, mod, threads);
+        for (size_t i = 0; i < res.rows; i++) {
+            for (size_t j = 0; j < res.cols; j++) {
+                munit_assert(mpz_cmp(res.mat[i].vec[j], expected.mat[i].vec[j]) == 0);
+            }
+        }
+    }
+
+    mpz_clears(lower, upper, mod, NULL);
+    cfe_mat_frees(&m1, &m2, &res, &expected, &product, NULL);
+
+    return MUNIT_OK;
+}
+
 
 MunitResult test_matrix_dot(const MunitParameter params[], void *data) {
     mpz_t x, res;
@@ -543,6 +577,7 @@ MunitTest matrix_tests[] = {
         {(char *) "/test-transpose",            test_matrix_transpose,     NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
         {(char *) "/test-check-bound",          test_matrix_check_bound,   NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
         {(char *) "/test-mul",                  test_matrix_mul,           NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/test-mul-mod",              test_matrix_mul_mod,       NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
         {(char *) "/test-mul-vec",              test_matrix_mul_vec,       NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
         {(char *) "/test-dot",                  test_matrix_dot,           NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
         {(char *) "/test-to-vec",               test_matrix_to_vec,        NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
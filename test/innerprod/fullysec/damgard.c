@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <stdlib.h>
 #include <gmp.h>
 #include "cifer/test.h"
 
@@ -84,6 +85,304 @@ MunitResult test_damgard_end_to_end(const MunitParameter *params, void *data) {
     return MUNIT_OK;
 }
 
+// a scheme with its keys and a ciphertext of x, which decrypts with the
+// functional key of y to xy_check
+typedef struct damgard_test {
+    size_t l;
+    mpz_t bound, bound_neg, xy_check;
+    cfe_damgard s, encryptor, decryptor;
+    cfe_damgard_sec_key msk;
+    cfe_damgard_fe_key key;
+    cfe_vec mpk, ciphertext, x, y;
+} damgard_test;
+
+void damgard_test_init(damgard_test *dt) {
+    dt->l = 3;
+    mpz_inits(dt->bound, dt->bound_neg, dt->xy_check, NULL);
+    mpz_set_ui(dt->bound, 2);
+    mpz_pow_ui(dt->bound, dt->bound, 10);
+    mpz_neg(dt->bound_neg, dt->bound);
+
+    cfe_error err = cfe_damgard_precomp_init(&dt->s, dt->l, 2048, dt->bound);
+    munit_assert(err == 0);
+
+    cfe_vec_inits(dt->l, &dt->x, &dt->y, NULL);
+    cfe_uniform_sample_range_vec(&dt->x, dt->bound_neg, dt->bound);
+    cfe_uniform_sample_range_vec(&dt->y, dt->bound_neg, dt->bound);
+    cfe_vec_dot(dt->xy_check, &dt->x, &dt->y);
+
+    cfe_damgard_sec_key_init(&dt->msk, &dt->s);
+    cfe_damgard_pub_key_init(&dt->mpk, &dt->s);
+    cfe_damgard_generate_master_keys(&dt->msk, &dt->mpk, &dt->s);
+    cfe_damgard_fe_key_init(&dt->key);
+    err = cfe_damgard_derive_fe_key(&dt->key, &dt->s, &dt->msk, &dt->y);
+    munit_assert(err == 0);
+
+    cfe_damgard_copy(&dt->encryptor, &dt->s);
+    cfe_damgard_copy(&dt->decryptor, &dt->s);
+    cfe_damgard_ciphertext_init(&dt->ciphertext, &dt->encryptor);
+    err = cfe_damgard_encrypt(&dt->ciphertext, &dt->encryptor, &dt->x, &dt->mpk);
+    munit_assert(err == 0);
+}
+
+void damgard_test_free(damgard_test *dt) {
+    mpz_clears(dt->bound, dt->bound_neg, dt->xy_check, NULL);
+    cfe_vec_frees(&dt->x, &dt->y, &dt->mpk, &dt->ciphertext, NULL);
+    cfe_damgard_sec_key_free(&dt->msk);
+    cfe_damgard_fe_key_free(&dt->key);
+    cfe_damgard_free(&dt->s);
+    cfe_damgard_free(&dt->encryptor);
+    cfe_damgard_free(&dt->decryptor);
+}
+
+// checks that the ciphertext decrypts to xy_check
+void damgard_test_check(damgard_test *dt) {
+    mpz_t xy;
+    mpz_init(xy);
+    cfe_error err = cfe_damgard_decrypt(xy, &dt->decryptor, &dt->ciphertext, &dt->key, &dt->y);
+    munit_assert(err == 0);
+    munit_assert(mpz_cmp(xy, dt->xy_check) == 0);
+    mpz_clear(xy);
+}
+
+MunitResult test_damgard_dlog_table(const MunitParameter *params, void *data) {
+    damgard_test dt;
+    damgard_test_init(&dt);
+    mpz_t xy;
+    mpz_init(xy);
+
+    cfe_dlog_table table;
+    cfe_error err = cfe_damgard_dlog_table_init(&table, &dt.decryptor);
+    munit_assert(err == 0);
+    err = cfe_damgard_decrypt_with_table(xy, &dt.decryptor, &dt.ciphertext, &dt.key, &dt.y, &table);
+    munit_assert(err == 0);
+    munit_assert(mpz_cmp(xy, dt.xy_check) == 0);
+    cfe_dlog_table_free(&table);
+
+    mpz_clear(xy);
+    damgard_test_free(&dt);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_damgard_msg_table(const MunitParameter *params, void *data) {
+    damgard_test dt;
+    damgard_test_init(&dt);
+
+    // the powers of g for the coordinates of x are looked up only by the
+    // encryptor which builds them
+    munit_assert(dt.encryptor.msg_table.low_len == 0);
+    cfe_damgard_msg_table_init(&dt.encryptor);
+    munit_assert(dt.encryptor.msg_table.low_len > 0);
+    munit_assert(dt.decryptor.msg_table.low_len == 0);
+    cfe_error err = cfe_damgard_encrypt(&dt.ciphertext, &dt.encryptor, &dt.x, &dt.mpk);
+    munit_assert(err == 0);
+    damgard_test_check(&dt);
+
+    damgard_test_free(&dt);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_damgard_encrypt_prep(const MunitParameter *params, void *data) {
+    damgard_test dt;
+    damgard_test_init(&dt);
+
+    cfe_fixed_base_vec pk;
+    cfe_error err = cfe_damgard_prep_pub_key_init(&pk, &dt.encryptor, &dt.mpk, 0);
+    munit_assert(err == 0);
+    err = cfe_damgard_encrypt_prep(&dt.ciphertext, &dt.encryptor, &dt.x, &pk);
+    munit_assert(err == 0);
+    cfe_fixed_base_vec_free(&pk);
+    damgard_test_check(&dt);
+
+    damgard_test_free(&dt);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_damgard_encrypt_pooled(const MunitParameter *params, void *data) {
+    damgard_test dt;
+    damgard_test_init(&dt);
+
+    // encrypt with randomness precomputed on a background thread
+    cfe_pool pool;
+    cfe_error err = cfe_damgard_pool_init(&pool, &dt.encryptor, &dt.mpk, 4, true);
+    munit_assert(err == 0);
+    for (size_t i = 0; i < 6; i++) {
+        err = cfe_damgard_encrypt_pooled(&dt.ciphertext, &dt.encryptor, &dt.x, &pool);
+        munit_assert(err == 0);
+        damgard_test_check(&dt);
+    }
+    cfe_pool_free(&pool);
+
+    damgard_test_free(&dt);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_damgard_aggregate(const MunitParameter *params, void *data) {
+    damgard_test dt;
+    damgard_test_init(&dt);
+
+    // aggregate many ciphertexts and decrypt the inner product of the sum
+    // of the encrypted vectors at once, also with several threads
+    size_t n = 40;
+    cfe_vec *ciphertexts = (cfe_vec *) malloc(n * sizeof(cfe_vec));
+    cfe_vec sum, aggregate;
+    cfe_vec_init(&sum, dt.l);
+    mpz_t xy, xy_half;
+    mpz_inits(xy, xy_half, NULL);
+    cfe_damgard_ciphertext_init(&aggregate, &dt.encryptor);
+    for (size_t i = 0; i < n; i++) {
+        cfe_uniform_sample_range_vec(&dt.x, dt.bound_neg, dt.bound);
+        cfe_vec_add(&sum, &sum, &dt.x);
+        if (i == n / 2 - 1) {
+            cfe_vec_dot(xy_half, &sum, &dt.y);
+        }
+        cfe_damgard_ciphertext_init(&ciphertexts[i], &dt.encryptor);
+        cfe_error err = cfe_damgard_encrypt(&ciphertexts[i], &dt.encryptor, &dt.x, &dt.mpk);
+        munit_assert(err == 0);
+    }
+    cfe_vec_dot(dt.xy_check, &sum, &dt.y);
+    for (size_t num_threads = 1; num_threads <= 4; num_threads += 3) {
+        cfe_error err = cfe_damgard_ciphertext_aggregate_parallel(&aggregate, &dt.encryptor, ciphertexts, n,
+                                                                  num_threads);
+        munit_assert(err == 0);
+        mpz_set_ui(xy, 0);
+        err = cfe_damgard_decrypt_aggregate(xy, &dt.decryptor, &aggregate, &dt.key, &dt.y, n);
+        munit_assert(err == 0);
+        munit_assert(mpz_cmp(xy, dt.xy_check) == 0);
+    }
+
+    // a table for n ciphertexts decrypts aggregates of fewer of them
+    cfe_dlog_table table;
+    cfe_error err = cfe_damgard_aggregate_dlog_table_init(&table, &dt.decryptor, n);
+    munit_assert(err == 0);
+    err = cfe_damgard_ciphertext_aggregate(&aggregate, &dt.encryptor, ciphertexts, n / 2);
+    munit_assert(err == 0);
+    mpz_set_ui(xy, 0);
+    err = cfe_damgard_decrypt_with_table(xy, &dt.decryptor, &aggregate, &dt.key, &dt.y, &table);
+    munit_assert(err == 0);
+    munit_assert(mpz_cmp(xy, xy_half) == 0);
+    cfe_dlog_table_free(&table);
+
+    for (size_t i = 0; i < n; i++) {
+        cfe_vec_free(&ciphertexts[i]);
+    }
+    free(ciphertexts);
+    cfe_vec_frees(&sum, &aggregate, NULL);
+    mpz_clears(xy, xy_half, NULL);
+    damgard_test_free(&dt);
+
+    return MUNIT_OK;
+}
+
+// samples n vectors ys and derives their keys one by one
+void damgard_test_keys_init(cfe_vec *ys, cfe_damgard_fe_key *keys, size_t n, damgard_test *dt) {
+    for (size_t k = 0; k < n; k++) {
+        cfe_vec_init(&ys[k], dt->l);
+        cfe_uniform_sample_range_vec(&ys[k], dt->bound_neg, dt->bound);
+        cfe_damgard_fe_key_init(&keys[k]);
+        cfe_error err = cfe_damgard_derive_fe_key(&keys[k], &dt->s, &dt->msk, &ys[k]);
+        munit_assert(err == 0);
+    }
+}
+
+void damgard_test_keys_free(cfe_vec *ys, cfe_damgard_fe_key *keys, size_t n) {
+    for (size_t k = 0; k < n; k++) {
+        cfe_vec_free(&ys[k]);
+        cfe_damgard_fe_key_free(&keys[k]);
+    }
+}
+
+MunitResult test_damgard_decrypt_batch(const MunitParameter *params, void *data) {
+    damgard_test dt;
+    damgard_test_init(&dt);
+
+    // decrypt the ciphertext with many keys at once; the last vector is
+    // out of bounds, so only its decryption fails
+    size_t n = 6;
+    cfe_vec ys[6];
+    cfe_damgard_fe_key keys[6];
+    mpz_t xys[6];
+    cfe_error errs[6];
+    damgard_test_keys_init(ys, keys, n, &dt);
+    for (size_t k = 0; k < n; k++) {
+        mpz_init(xys[k]);
+    }
+    mpz_mul_ui(ys[n - 1].vec[0], dt.bound, 2);
+
+    for (int shared = 0; shared < 2; shared++) {
+        cfe_dlog_table table;
+        if (shared) {
+            cfe_error err = cfe_damgard_dlog_table_init(&table, &dt.decryptor);
+            munit_assert(err == 0);
+        }
+        cfe_error err = cfe_damgard_decrypt_batch(xys, errs, &dt.decryptor, &dt.ciphertext, keys, ys, n,
+                                                  shared ? &table : NULL, 2);
+        munit_assert(err == CFE_ERR_BOUND_CHECK_FAILED);
+        munit_assert(errs[n - 1] == CFE_ERR_BOUND_CHECK_FAILED);
+        for (size_t k = 0; k < n - 1; k++) {
+            munit_assert(errs[k] == CFE_ERR_NONE);
+            cfe_vec_dot(dt.xy_check, &dt.x, &ys[k]);
+            munit_assert(mpz_cmp(xys[k], dt.xy_check) == 0);
+        }
+        err = cfe_damgard_decrypt_batch(xys, NULL, &dt.decryptor, &dt.ciphertext, keys, ys, n - 1, NULL, 0);
+        munit_assert(err == 0);
+        if (shared) {
+            cfe_dlog_table_free(&table);
+        }
+    }
+
+    for (size_t k = 0; k < n; k++) {
+        mpz_clear(xys[k]);
+    }
+    damgard_test_keys_free(ys, keys, n);
+    damgard_test_free(&dt);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_damgard_derive_fe_keys(const MunitParameter *params, void *data) {
+    damgard_test dt;
+    damgard_test_init(&dt);
+
+    size_t n = 6;
+    cfe_vec ys[6];
+    cfe_damgard_fe_key keys[6], batch_keys[6];
+    damgard_test_keys_init(ys, keys, n, &dt);
+
+    // derive the same keys at once; an out of bounds vector fails the batch
+    cfe_mat Y;
+    cfe_mat_init(&Y, n, dt.l);
+    for (size_t k = 0; k < n; k++) {
+        cfe_mat_set_vec(&Y, &ys[k], k);
+        cfe_damgard_fe_key_init(&batch_keys[k]);
+    }
+    for (size_t num_threads = 0; num_threads <= 4; num_threads += 4) {
+        cfe_error err = cfe_damgard_derive_fe_keys(batch_keys, &dt.s, &dt.msk, &Y, num_threads);
+        munit_assert(err == 0);
+        for (size_t k = 0; k < n; k++) {
+            munit_assert(mpz_cmp(batch_keys[k].key1, keys[k].key1) == 0);
+            munit_assert(mpz_cmp(batch_keys[k].key2, keys[k].key2) == 0);
+        }
+    }
+    mpz_mul_ui(ys[n - 1].vec[0], dt.bound, 2);
+    cfe_mat_set_vec(&Y, &ys[n - 1], n - 1);
+    cfe_error err = cfe_damgard_derive_fe_keys(batch_keys, &dt.s, &dt.msk, &Y, 2);
+    munit_assert(err == CFE_ERR_BOUND_CHECK_FAILED);
+
+    for (size_t k = 0; k < n; k++) {
+        cfe_damgard_fe_key_free(&batch_keys[k]);
+    }
+    cfe_mat_free(&Y);
+    damgard_test_keys_free(ys, keys, n);
+    damgard_test_free(&dt);
+
+    return MUNIT_OK;
+}
+
 char *damgard_param[] = {
         (char *) "precomputed", (char *) "random", NULL
 };
@@ -94,8 +393,15 @@ MunitParameterEnum damgard_params[] = {
 };
 
 MunitTest simple_ip_damgard_tests[] = {
-        {(char *) "/end-to-end", test_damgard_end_to_end, NULL, NULL, MUNIT_TEST_OPTION_NONE, damgard_params},
-        {NULL,                   NULL,                    NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
+        {(char *) "/end-to-end",     test_damgard_end_to_end,     NULL, NULL, MUNIT_TEST_OPTION_NONE, damgard_params},
+        {(char *) "/dlog-table",     test_damgard_dlog_table,     NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/msg-table",      test_damgard_msg_table,      NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/encrypt-prep",   test_damgard_encrypt_prep,   NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/encrypt-pooled", test_damgard_encrypt_pooled, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/aggregate",      test_damgard_aggregate,      NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/decrypt-batch",  test_damgard_decrypt_batch,  NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/derive-fe-keys", test_damgard_derive_fe_keys, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {NULL,                       NULL,                        NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
 };
 
 MunitSuite damgard_suite = {
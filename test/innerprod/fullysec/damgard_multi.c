@@ -91,6 +91,16 @@ MunitResult test_damgard_multi_end_to_end(const MunitParameter *params, void *da
     cfe_mat_dot(xy_check, &x, &y);
     munit_assert(mpz_cmp(xy, xy_check) == 0);
 
+    // decrypt again with a precomputed table of baby steps
+    cfe_dlog_table table;
+    err = cfe_damgard_multi_dlog_table_init(&table, &decryptor);
+    munit_assert(err == 0);
+    mpz_set_ui(xy, 0);
+    err = cfe_damgard_multi_decrypt_with_table(xy, &decryptor, ciphertext, &fe_key, &y, &table);
+    munit_assert(err == 0);
+    munit_assert(mpz_cmp(xy, xy_check) == 0);
+    cfe_dlog_table_free(&table);
+
     // clear up
     mpz_clears(bound, xy_check, xy, NULL);
     cfe_mat_frees(&x, &y, &mpk, NULL);
@@ -107,6 +117,70 @@ MunitResult test_damgard_multi_end_to_end(const MunitParameter *params, void *da
     return MUNIT_OK;
 }
 
+MunitResult test_damgard_multi_encrypt_prep(const MunitParameter *params, void *data) {
+    size_t l = 2;
+    size_t num_clients = 4;
+    mpz_t bound, xy_check, xy;
+    mpz_inits(bound, xy_check, xy, NULL);
+    mpz_set_ui(bound, 2);
+    mpz_pow_ui(bound, bound, 10);
+
+    cfe_damgard_multi m;
+    cfe_error err = cfe_damgard_multi_precomp_init(&m, num_clients, l, 2048, bound);
+    munit_assert(err == 0);
+
+    cfe_mat x, y, mpk;
+    cfe_mat_inits(num_clients, l, &x, &y, NULL);
+    cfe_damgard_multi_sec_key msk;
+    cfe_damgard_multi_master_keys_init(&mpk, &msk, &m);
+    cfe_damgard_multi_generate_master_keys(&mpk, &msk, &m);
+
+    cfe_damgard_multi_fe_key fe_key;
+    cfe_damgard_multi_fe_key_init(&fe_key, &m);
+    cfe_uniform_sample_mat(&y, bound);
+    err = cfe_damgard_multi_derive_fe_key(&fe_key, &m, &msk, &y);
+    munit_assert(err == 0);
+
+    // every client encrypts with its prepared public key, the last one
+    // with a small memory budget
+    cfe_vec ciphertext[num_clients];
+    cfe_damgard_multi_client clients[num_clients];
+    for (size_t i = 0; i < num_clients; i++) {
+        cfe_vec *x_vec = cfe_mat_get_row_ptr(&x, i);
+        cfe_uniform_sample_vec(x_vec, bound);
+
+        cfe_vec *pub_key = cfe_mat_get_row_ptr(&mpk, i);
+        cfe_vec *otp = cfe_mat_get_row_ptr(&msk.otp, i);
+
+        cfe_damgard_multi_client_init(&clients[i], &m);
+        cfe_damgard_multi_ciphertext_init(&(ciphertext[i]), &clients[i]);
+
+        cfe_fixed_base_vec pk;
+        err = cfe_damgard_multi_prep_pub_key_init(&pk, &clients[i], pub_key, i + 1 < num_clients ? 0 : 1024);
+        munit_assert(err == 0);
+        err = cfe_damgard_multi_encrypt_prep(&(ciphertext[i]), &clients[i], x_vec, &pk, otp);
+        munit_assert(err == 0);
+        cfe_fixed_base_vec_free(&pk);
+    }
+
+    err = cfe_damgard_multi_decrypt(xy, &m, ciphertext, &fe_key, &y);
+    munit_assert(err == 0);
+    cfe_mat_dot(xy_check, &x, &y);
+    munit_assert(mpz_cmp(xy, xy_check) == 0);
+
+    mpz_clears(bound, xy_check, xy, NULL);
+    cfe_mat_frees(&x, &y, &mpk, NULL);
+    cfe_damgard_multi_sec_key_free(&msk);
+    cfe_damgard_multi_fe_key_free(&fe_key);
+    cfe_damgard_multi_free(&m);
+    for (size_t i = 0; i < num_clients; i++) {
+        cfe_damgard_multi_client_free(&clients[i]);
+        cfe_vec_free(&ciphertext[i]);
+    }
+
+    return MUNIT_OK;
+}
+
 char *damgard_multi_param[] = {
         (char *) "precomputed", (char *) "random", NULL
 };
@@ -117,8 +191,9 @@ MunitParameterEnum damgard_multi_params[] = {
 };
 
 MunitTest damgard_multi_damgard_tests[] = {
-        {(char *) "/end-to-end", test_damgard_multi_end_to_end, NULL, NULL, MUNIT_TEST_OPTION_NONE, damgard_multi_params},
-        {NULL,                   NULL,                          NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
+        {(char *) "/end-to-end",   test_damgard_multi_end_to_end,   NULL, NULL, MUNIT_TEST_OPTION_NONE, damgard_multi_params},
+        {(char *) "/encrypt-prep", test_damgard_multi_encrypt_prep, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {NULL,                     NULL,                            NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
 };
 
 MunitSuite damgard_multi_suite = {
@@ -76,8 +76,61 @@ MunitResult test_dmcfe_end_to_end(const MunitParameter *params, void *data) {
     return MUNIT_OK;
 }
 
+MunitResult test_dmcfe_dlog_table(const MunitParameter *params, void *data) {
+    size_t num_clients = 5;
+    mpz_t bound, bound_neg, xy_check, xy;
+    mpz_inits(bound, bound_neg, xy_check, xy, NULL);
+    mpz_set_ui(bound, 2);
+    mpz_pow_ui(bound, bound, 10);
+    mpz_neg(bound_neg, bound);
+
+    cfe_dmcfe_client clients[num_clients];
+    ECP_BN254 pub_keys[num_clients];
+    for (size_t i = 0; i < num_clients; i++) {
+        cfe_dmcfe_client_init(&(clients[i]), i);
+        pub_keys[i] = clients[i].client_pub_key;
+    }
+    for (size_t i = 0; i < num_clients; i++) {
+        cfe_dmcfe_set_share(&(clients[i]), pub_keys, num_clients);
+    }
+
+    cfe_vec x, y;
+    cfe_vec_inits(num_clients, &x, &y, NULL);
+    cfe_uniform_sample_vec(&x, bound);
+    cfe_uniform_sample_range_vec(&y, bound_neg, bound);
+    cfe_vec_dot(xy_check, &x, &y);
+    char label[] = "some label";
+    size_t label_len = 10;
+    ECP_BN254 ciphers[num_clients];
+    cfe_vec_G2 fe_key[num_clients];
+    for (size_t i = 0; i < num_clients; i++) {
+        cfe_dmcfe_encrypt(&(ciphers[i]), &(clients[i]), x.vec[i], label, label_len);
+        cfe_dmcfe_fe_key_part_init(&(fe_key[i]));
+        cfe_dmcfe_derive_fe_key_part(&(fe_key[i]), &(clients[i]), &y);
+    }
+
+    // decrypt with a precomputed table of baby steps
+    cfe_dlog_table_FP12_BN254 t;
+    cfe_error err = cfe_dmcfe_dlog_table_init(&t, num_clients, bound);
+    munit_assert(err == CFE_ERR_NONE);
+    err = cfe_dmcfe_decrypt_with_table(xy, ciphers, fe_key, label, label_len, &y, &t);
+    munit_assert(err == CFE_ERR_NONE);
+    munit_assert(mpz_cmp(xy, xy_check) == 0);
+    cfe_dlog_table_FP12_BN254_free(&t);
+
+    mpz_clears(bound, bound_neg, xy_check, xy, NULL);
+    for (size_t i = 0; i < num_clients; i++) {
+        cfe_dmcfe_client_free(&(clients[i]));
+        cfe_vec_G2_free(&(fe_key[i]));
+    }
+    cfe_vec_frees(&x, &y, NULL);
+
+    return MUNIT_OK;
+}
+
 MunitTest fully_secure_dmcfe_tests[] = {
         {(char *) "/end-to-end", test_dmcfe_end_to_end, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/dlog-table", test_dmcfe_dlog_table, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
         {NULL, NULL,                                      NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
 };
 
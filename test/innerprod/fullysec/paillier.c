@@ -70,9 +70,199 @@ MunitResult test_paillier_end_to_end(const MunitParameter *params, void *data) {
     return MUNIT_OK;
 }
 
+MunitResult test_paillier_sec_params(const MunitParameter *params, void *data) {
+    size_t l = 20;
+    size_t lambda = 128;
+    size_t bit_len = 512;
+    mpz_t bound, bound_neg, fe_key, xy_check, xy, pow_check, pow;
+    mpz_inits(bound, bound_neg, fe_key, xy_check, xy, pow_check, pow, NULL);
+    mpz_set_ui(bound, 1000);
+    mpz_neg(bound_neg, bound);
+
+    cfe_paillier s;
+    cfe_paillier_sec_params sp;
+    cfe_error err = cfe_paillier_init_sec(&s, &sp, l, lambda, bit_len, bound, bound);
+    munit_assert(err == 0);
+
+    cfe_vec msk, mpk, ciphertext, x, y;
+    cfe_vec_inits(l, &x, &y, NULL);
+    cfe_uniform_sample_range_vec(&x, bound_neg, bound);
+    cfe_uniform_sample_range_vec(&y, bound_neg, bound);
+    cfe_vec_dot(xy_check, &x, &y);
+
+    // the master public key computed with the secret parameters is the
+    // same as the one computed modulo n^2
+    cfe_paillier_master_keys_init(&msk, &mpk, &s);
+    err = cfe_paillier_generate_master_keys_sec(&msk, &mpk, &s, &sp);
+    munit_assert(err == 0);
+    for (size_t i = 0; i < l; i++) {
+        mpz_powm(pow_check, s.g, msk.vec[i], s.n_square);
+        munit_assert(mpz_cmp(mpk.vec[i], pow_check) == 0);
+        cfe_paillier_sec_params_powm(pow, &sp, s.g, msk.vec[i]);
+        munit_assert(mpz_cmp(pow, pow_check) == 0);
+    }
+
+    err = cfe_paillier_derive_fe_key(fe_key, &s, &msk, &y);
+    munit_assert(err == 0);
+    cfe_paillier_ciphertext_init(&ciphertext, &s);
+    err = cfe_paillier_encrypt(&ciphertext, &s, &x, &mpk);
+    munit_assert(err == 0);
+    err = cfe_paillier_decrypt(xy, &s, &ciphertext, fe_key, &y);
+    munit_assert(err == 0);
+    munit_assert(mpz_cmp(xy, xy_check) == 0);
+
+    mpz_clears(bound, bound_neg, fe_key, xy_check, xy, pow_check, pow, NULL);
+    cfe_vec_frees(&x, &y, &msk, &mpk, &ciphertext, NULL);
+    cfe_paillier_sec_params_free(&sp);
+    cfe_paillier_free(&s);
+
+    return MUNIT_OK;
+}
+
+// a scheme with its keys and a functional key for y
+typedef struct paillier_test {
+    size_t l;
+    mpz_t bound, bound_neg, fe_key, xy_check, xy;
+    cfe_paillier s, encryptor;
+    cfe_vec msk, mpk, x, y;
+} paillier_test;
+
+void paillier_test_init(paillier_test *pt) {
+    pt->l = 20;
+    mpz_inits(pt->bound, pt->bound_neg, pt->fe_key, pt->xy_check, pt->xy, NULL);
+    mpz_set_ui(pt->bound, 2);
+    mpz_pow_ui(pt->bound, pt->bound, 10);
+    mpz_neg(pt->bound_neg, pt->bound);
+    mpz_add_ui(pt->bound_neg, pt->bound_neg, 1);
+
+    cfe_error err = cfe_paillier_init(&pt->s, pt->l, 128, 512, pt->bound, pt->bound);
+    munit_assert(err == 0);
+
+    cfe_vec_inits(pt->l, &pt->x, &pt->y, NULL);
+    cfe_uniform_sample_range_vec(&pt->x, pt->bound_neg, pt->bound);
+    cfe_uniform_sample_range_vec(&pt->y, pt->bound_neg, pt->bound);
+    cfe_vec_dot(pt->xy_check, &pt->x, &pt->y);
+
+    cfe_paillier_master_keys_init(&pt->msk, &pt->mpk, &pt->s);
+    err = cfe_paillier_generate_master_keys(&pt->msk, &pt->mpk, &pt->s);
+    munit_assert(err == 0);
+    err = cfe_paillier_derive_fe_key(pt->fe_key, &pt->s, &pt->msk, &pt->y);
+    munit_assert(err == 0);
+    cfe_paillier_copy(&pt->encryptor, &pt->s);
+}
+
+void paillier_test_free(paillier_test *pt) {
+    mpz_clears(pt->bound, pt->bound_neg, pt->fe_key, pt->xy_check, pt->xy, NULL);
+    cfe_vec_frees(&pt->x, &pt->y, &pt->msk, &pt->mpk, NULL);
+    cfe_paillier_free(&pt->s);
+    cfe_paillier_free(&pt->encryptor);
+}
+
+// samples n vectors xs and encrypts them one by one
+void paillier_test_ciphertexts_init(cfe_vec *xs, cfe_vec *ciphertexts, size_t n, paillier_test *pt) {
+    for (size_t k = 0; k < n; k++) {
+        cfe_vec_init(&xs[k], pt->l);
+        cfe_uniform_sample_range_vec(&xs[k], pt->bound_neg, pt->bound);
+        cfe_paillier_ciphertext_init(&ciphertexts[k], &pt->encryptor);
+        cfe_error err = cfe_paillier_encrypt(&ciphertexts[k], &pt->encryptor, &xs[k], &pt->mpk);
+        munit_assert(err == 0);
+    }
+}
+
+void paillier_test_ciphertexts_free(cfe_vec *xs, cfe_vec *ciphertexts, size_t n) {
+    for (size_t k = 0; k < n; k++) {
+        cfe_vec_frees(&xs[k], &ciphertexts[k], NULL);
+    }
+}
+
+MunitResult test_paillier_encrypt_prep(const MunitParameter *params, void *data) {
+    paillier_test pt;
+    paillier_test_init(&pt);
+
+    // encrypt with a prepared public key, one vector and then many at once
+    cfe_paillier_prep_pub_key pk;
+    cfe_error err = cfe_paillier_prep_pub_key_init(&pk, &pt.encryptor, &pt.mpk, 0);
+    munit_assert(err == 0);
+    cfe_vec ciphertext;
+    cfe_paillier_ciphertext_init(&ciphertext, &pt.encryptor);
+    err = cfe_paillier_encrypt_prep(&ciphertext, &pt.encryptor, &pt.x, &pk);
+    munit_assert(err == 0);
+    err = cfe_paillier_decrypt(pt.xy, &pt.s, &ciphertext, pt.fe_key, &pt.y);
+    munit_assert(err == 0);
+    munit_assert(mpz_cmp(pt.xy, pt.xy_check) == 0);
+
+    size_t n = 5;
+    cfe_vec xs[5], ciphertexts[5];
+    paillier_test_ciphertexts_init(xs, ciphertexts, n, &pt);
+    for (size_t num_threads = 0; num_threads <= 2; num_threads += 2) {
+        err = cfe_paillier_encrypt_batch(ciphertexts, &pt.encryptor, xs, n, &pk, num_threads);
+        munit_assert(err == 0);
+        for (size_t k = 0; k < n; k++) {
+            cfe_vec_dot(pt.xy_check, &xs[k], &pt.y);
+            err = cfe_paillier_decrypt(pt.xy, &pt.s, &ciphertexts[k], pt.fe_key, &pt.y);
+            munit_assert(err == 0);
+            munit_assert(mpz_cmp(pt.xy, pt.xy_check) == 0);
+        }
+    }
+
+    // an out of bounds vector fails the whole batch
+    mpz_mul_ui(xs[n - 1].vec[0], pt.bound, 2);
+    err = cfe_paillier_encrypt_batch(ciphertexts, &pt.encryptor, xs, n, &pk, 2);
+    munit_assert(err == CFE_ERR_BOUND_CHECK_FAILED);
+
+    paillier_test_ciphertexts_free(xs, ciphertexts, n);
+    cfe_vec_free(&ciphertext);
+    cfe_paillier_prep_pub_key_free(&pk);
+    paillier_test_free(&pt);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_paillier_decrypt_batch(const MunitParameter *params, void *data) {
+    paillier_test pt;
+    paillier_test_init(&pt);
+
+    size_t n = 5;
+    cfe_vec xs[5], ciphertexts[5];
+    mpz_t xys[5];
+    cfe_error errs[5];
+    paillier_test_ciphertexts_init(xs, ciphertexts, n, &pt);
+    for (size_t k = 0; k < n; k++) {
+        mpz_init(xys[k]);
+    }
+
+    // decrypt all the ciphertexts with the same key; once the last one has
+    // a wrong size, only its decryption fails
+    cfe_error err = cfe_paillier_decrypt_batch(xys, NULL, &pt.s, ciphertexts, n, pt.fe_key, &pt.y, 2);
+    munit_assert(err == 0);
+    cfe_vec_free(&ciphertexts[n - 1]);
+    cfe_vec_init(&ciphertexts[n - 1], pt.l);
+    for (size_t num_threads = 0; num_threads <= 3; num_threads += 3) {
+        err = cfe_paillier_decrypt_batch(xys, errs, &pt.s, ciphertexts, n, pt.fe_key, &pt.y, num_threads);
+        munit_assert(err == CFE_ERR_MALFORMED_INPUT);
+        munit_assert(errs[n - 1] == CFE_ERR_MALFORMED_INPUT);
+        for (size_t k = 0; k < n - 1; k++) {
+            munit_assert(errs[k] == CFE_ERR_NONE);
+            cfe_vec_dot(pt.xy_check, &xs[k], &pt.y);
+            munit_assert(mpz_cmp(xys[k], pt.xy_check) == 0);
+        }
+    }
+
+    for (size_t k = 0; k < n; k++) {
+        mpz_clear(xys[k]);
+    }
+    paillier_test_ciphertexts_free(xs, ciphertexts, n);
+    paillier_test_free(&pt);
+
+    return MUNIT_OK;
+}
+
 MunitTest simple_ip_paillier_tests[] = {
-        {(char *) "/end-to-end", test_paillier_end_to_end, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
-        {NULL, NULL,                                       NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
+        {(char *) "/end-to-end",    test_paillier_end_to_end,    NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/sec-params",    test_paillier_sec_params,    NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/encrypt-prep",  test_paillier_encrypt_prep,  NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/decrypt-batch", test_paillier_decrypt_batch, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {NULL, NULL,                                             NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
 };
 
 MunitSuite paillier_suite = {
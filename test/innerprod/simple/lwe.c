@@ -73,9 +73,59 @@ MunitResult test_lwe(const MunitParameter *params, void *data) {
     return MUNIT_OK;
 }
 
+MunitResult test_lwe_derive_fe_keys(const MunitParameter *params, void *data) {
+    size_t l = 4;
+    size_t n = 128;
+    mpz_t B, B_neg;
+    mpz_init_set_ui(B, 10000);
+    mpz_init(B_neg);
+    mpz_neg(B_neg, B);
+
+    cfe_lwe s;
+    cfe_error err = cfe_lwe_init(&s, l, B, B, n);
+    munit_assert(!err);
+
+    cfe_mat SK;
+    cfe_lwe_sec_key_init(&SK, &s);
+    cfe_lwe_generate_sec_key(&SK, &s);
+
+    // derive the keys for many vectors at once and compare them with the
+    // keys derived one by one
+    cfe_vec fe_key;
+    cfe_lwe_fe_key_init(&fe_key, &s);
+    cfe_mat Y, SK_Y;
+    cfe_mat_init(&Y, 5, l);
+    cfe_mat_init(&SK_Y, 5, n);
+    cfe_uniform_sample_range_mat(&Y, B_neg, B);
+    for (size_t num_threads = 0; num_threads <= 2; num_threads += 2) {
+        err = cfe_lwe_derive_fe_keys(&SK_Y, &s, &SK, &Y, num_threads);
+        munit_assert(!err);
+        for (size_t k = 0; k < Y.rows; k++) {
+            err = cfe_lwe_derive_fe_key(&fe_key, &s, &SK, &Y.mat[k]);
+            munit_assert(!err);
+            for (size_t i = 0; i < n; i++) {
+                munit_assert(mpz_cmp(SK_Y.mat[k].vec[i], fe_key.vec[i]) == 0);
+            }
+        }
+    }
+
+    // an out of bounds vector fails the whole batch
+    mpz_mul_ui(Y.mat[3].vec[1], B, 2);
+    err = cfe_lwe_derive_fe_keys(&SK_Y, &s, &SK, &Y, 2);
+    munit_assert(err == CFE_ERR_BOUND_CHECK_FAILED);
+
+    mpz_clears(B, B_neg, NULL);
+    cfe_vec_free(&fe_key);
+    cfe_mat_frees(&SK, &Y, &SK_Y, NULL);
+    cfe_lwe_free(&s);
+
+    return MUNIT_OK;
+}
+
 MunitTest lwe_tests[] = {
-        {(char *) "/end-to-end", test_lwe, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
-        {NULL, NULL,                       NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
+        {(char *) "/end-to-end",     test_lwe,                NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/derive-fe-keys", test_lwe_derive_fe_keys, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {NULL, NULL,                                          NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
 };
 
 MunitSuite lwe_suite = {
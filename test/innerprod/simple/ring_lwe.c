@@ -85,6 +85,26 @@ MunitResult test_ring_lwe(const MunitParameter *params, void *data) {
         munit_assert(mpz_cmp(res.vec[i], expect.vec[i]) == 0);
     }
 
+    // derive the keys for many vectors at once, the first one being y
+    cfe_mat Y, SK_Y;
+    cfe_mat_init(&Y, 3, l);
+    cfe_mat_init(&SK_Y, 3, n);
+    cfe_uniform_sample_range_mat(&Y, B_neg, B);
+    cfe_mat_set_vec(&Y, &y, 0);
+    err = cfe_ring_lwe_derive_fe_keys(&SK_Y, &s, &SK, &Y, 2);
+    munit_assert(!err);
+    for (size_t k = 0; k < Y.rows; k++) {
+        err = cfe_ring_lwe_derive_fe_key(&fe_key, &s, &SK, &Y.mat[k]);
+        munit_assert(!err);
+        for (size_t i = 0; i < n; i++) {
+            munit_assert(mpz_cmp(SK_Y.mat[k].vec[i], fe_key.vec[i]) == 0);
+        }
+    }
+    mpz_mul_ui(Y.mat[2].vec[1], B, 2);
+    err = cfe_ring_lwe_derive_fe_keys(&SK_Y, &s, &SK, &Y, 2);
+    munit_assert(err == CFE_ERR_BOUND_CHECK_FAILED);
+    cfe_mat_frees(&Y, &SK_Y, NULL);
+
     cfe_mat_frees(&X, &CT, &SK, &PK, NULL);
     cfe_vec_frees(&y, &fe_key, &expect, &res, NULL);
     mpz_clears(B, B_neg, p, q, NULL);
@@ -14,10 +14,12 @@
  * limitations under the License.
  */
 
+#include <stdio.h>
 #include <amcl/pair_BN254.h>
 
 #include "cifer/internal/common.h"
 #include "cifer/internal/big.h"
+#include "cifer/data/vec_curve.h"
 #include "cifer/internal/keygen.h"
 #include "cifer/sample/uniform.h"
 #include "cifer/test.h"
@@ -133,6 +135,288 @@ MunitResult test_baby_step_giant_step_with_neg(const MunitParameter params[], vo
     munit_assert(err == 0);
     munit_assert(mpz_cmp(res, dp.x) == 0);
 
+    // a negative solution is found with the same single table search
+    mpz_add_ui(dp.x, bound_neg, 1);
+    mpz_powm(dp.h, dp.g, dp.x, dp.p);
+
+    err = cfe_baby_giant_with_neg_parallel(res, dp.h, dp.g, dp.p, dp.q, bound, 4);
+
+    munit_assert(err == 0);
+    munit_assert(mpz_cmp(res, dp.x) == 0);
+
+    mpz_clears(dp.h, dp.g, dp.p, dp.x, dp.q, res, bound, bound_neg, NULL);
+    return MUNIT_OK;
+}
+
+MunitResult test_dlog_table(const MunitParameter params[], void *data) {
+    dlog_params dp;
+    random_dlog_params(&dp, 128);
+    mpz_t res, bound, bound_neg;
+    mpz_inits(res, bound, bound_neg, NULL);
+    mpz_set_ui(bound, 2);
+    mpz_pow_ui(bound, bound, 20);
+    mpz_neg(bound_neg, bound);
+
+    // the table is built once and reused for many elements
+    cfe_dlog_table t;
+    cfe_error err = cfe_dlog_table_init(&t, dp.g, dp.p, dp.q, bound);
+    munit_assert(err == 0);
+
+    for (int i = 0; i < 10; i++) {
+        cfe_uniform_sample(dp.x, bound);
+        mpz_powm(dp.h, dp.g, dp.x, dp.p);
+
+        err = cfe_dlog_table_solve(res, dp.h, &t);
+        munit_assert(err == 0);
+        munit_assert(mpz_cmp(res, dp.x) == 0);
+
+        cfe_uniform_sample_range(dp.x, bound_neg, bound);
+        mpz_powm(dp.h, dp.g, dp.x, dp.p);
+
+        err = cfe_dlog_table_solve_with_neg(res, dp.h, &t);
+        munit_assert(err == 0);
+        munit_assert(mpz_cmp(res, dp.x) == 0);
+    }
+
+    cfe_dlog_table_free(&t);
+    mpz_clears(dp.h, dp.g, dp.p, dp.x, dp.q, res, bound, bound_neg, NULL);
+    return MUNIT_OK;
+}
+
+MunitResult test_dlog_table_batch(const MunitParameter params[], void *data) {
+    dlog_params dp;
+    random_dlog_params(&dp, 128);
+    mpz_t bound, bound_neg;
+    mpz_inits(bound, bound_neg, NULL);
+    mpz_set_ui(bound, 2);
+    mpz_pow_ui(bound, bound, 20);
+    mpz_neg(bound_neg, bound);
+
+    size_t n = 10;
+    mpz_t h[10], res[10], x[10];
+    cfe_error errs[10];
+    for (size_t k = 0; k < n; k++) {
+        mpz_inits(h[k], res[k], x[k], NULL);
+        cfe_uniform_sample_range(x[k], bound_neg, bound);
+        if (mpz_sgn(x[k]) < 0) {
+            mpz_neg(x[k], x[k]);
+            mpz_powm(h[k], dp.g, x[k], dp.p);
+            mpz_invert(h[k], h[k], dp.p);
+            mpz_neg(x[k], x[k]);
+        } else {
+            mpz_powm(h[k], dp.g, x[k], dp.p);
+        }
+    }
+    // the last element has no solution within the bound
+    mpz_mul_ui(x[n - 1], bound, 4);
+    mpz_powm(h[n - 1], dp.g, x[n - 1], dp.p);
+
+    cfe_dlog_table t;
+    cfe_error err = cfe_dlog_table_init(&t, dp.g, dp.p, dp.q, bound);
+    munit_assert(err == 0);
+
+    err = cfe_dlog_table_solve_batch_with_neg(res, errs, h, n, &t);
+    munit_assert(err == CFE_ERR_DLOG_NOT_FOUND);
+    munit_assert(errs[n - 1] == CFE_ERR_DLOG_NOT_FOUND);
+    for (size_t k = 0; k < n - 1; k++) {
+        munit_assert(errs[k] == CFE_ERR_NONE);
+        munit_assert(mpz_cmp(res[k], x[k]) == 0);
+    }
+
+    // the same with the elements split among threads
+    t.num_threads = 3;
+    err = cfe_dlog_table_solve_batch_with_neg(res, NULL, h, n - 1, &t);
+    munit_assert(err == 0);
+    for (size_t k = 0; k < n - 1; k++) {
+        munit_assert(mpz_cmp(res[k], x[k]) == 0);
+    }
+
+    cfe_dlog_table_free(&t);
+    for (size_t k = 0; k < n; k++) {
+        mpz_clears(h[k], res[k], x[k], NULL);
+    }
+    mpz_clears(dp.h, dp.g, dp.p, dp.x, dp.q, bound, bound_neg, NULL);
+    return MUNIT_OK;
+}
+
+MunitResult test_dlog_config(const MunitParameter params[], void *data) {
+    dlog_params dp;
+    random_dlog_params(&dp, 128);
+    mpz_t res, bound, bound_neg;
+    mpz_inits(res, bound, bound_neg, NULL);
+    mpz_set_ui(bound, 2);
+    mpz_pow_ui(bound, bound, 24);
+    mpz_neg(bound_neg, bound);
+
+    // by default the table has sqrt(bound) + 1 baby steps
+    cfe_dlog_config c;
+    cfe_dlog_config_init(&c);
+    cfe_dlog_prediction pr;
+    cfe_error err = cfe_dlog_predict(&pr, bound, &c);
+    munit_assert(err == 0);
+    munit_assert(pr.algorithm == CFE_DLOG_BSGS);
+    munit_assert(pr.baby_steps == 4097);
+    munit_assert(pr.giant_steps == 4096);
+
+    // a memory budget limits the table and the giant steps take over
+    c.memory_budget = 32 * 1024;
+    c.algorithm = CFE_DLOG_BSGS;
+    err = cfe_dlog_predict(&pr, bound, &c);
+    munit_assert(err == 0);
+    munit_assert(pr.baby_steps == 1024);
+    munit_assert(pr.giant_steps == 16385);
+    munit_assert(pr.table_bytes <= c.memory_budget);
+
+    // automatically, the kangaroo method is used instead
+    c.algorithm = CFE_DLOG_AUTO;
+    err = cfe_dlog_predict(&pr, bound, &c);
+    munit_assert(err == 0);
+    munit_assert(pr.algorithm == CFE_DLOG_KANGAROO);
+
+    // an explicit number of baby steps must fit into the budget
+    c.algorithm = CFE_DLOG_BSGS;
+    c.baby_steps = 4097;
+    err = cfe_dlog_predict(&pr, bound, &c);
+    munit_assert(err == CFE_ERR_DLOG_CALC_FAILED);
+
+    cfe_dlog_algorithm algorithms[] = {CFE_DLOG_AUTO, CFE_DLOG_BSGS, CFE_DLOG_KANGAROO};
+    c.baby_steps = 0;
+    for (int i = 0; i < 3; i++) {
+        c.algorithm = algorithms[i];
+        c.num_threads = i + 1;
+        cfe_uniform_sample_range(dp.x, bound_neg, bound);
+        mpz_powm(dp.h, dp.g, dp.x, dp.p);
+
+        err = cfe_dlog_with_neg(res, dp.h, dp.g, dp.p, dp.q, bound, &c);
+        munit_assert(err == 0);
+        munit_assert(mpz_cmp(res, dp.x) == 0);
+    }
+
+    // a table with fewer baby steps than the default
+    c.baby_steps = 100;
+    cfe_dlog_table t;
+    err = cfe_dlog_table_init_with_config(&t, dp.g, dp.p, dp.q, bound, &c);
+    munit_assert(err == 0);
+    munit_assert(t.giant_steps == 167773);
+    err = cfe_dlog_table_solve_with_neg(res, dp.h, &t);
+    munit_assert(err == 0);
+    munit_assert(mpz_cmp(res, dp.x) == 0);
+    cfe_dlog_table_free(&t);
+
+    mpz_clears(dp.h, dp.g, dp.p, dp.x, dp.q, res, bound, bound_neg, NULL);
+    return MUNIT_OK;
+}
+
+MunitResult test_baby_step_giant_step_parallel(const MunitParameter params[], void *data) {
+    dlog_params dp;
+    random_dlog_params(&dp, 128);
+    mpz_t res, bound, bound_neg;
+    mpz_inits(res, bound, bound_neg, NULL);
+    mpz_set_ui(bound, 2);
+    mpz_pow_ui(bound, bound, 24);
+    mpz_neg(bound_neg, bound);
+
+    cfe_uniform_sample_range(dp.x, bound_neg, bound);
+    mpz_powm(dp.h, dp.g, dp.x, dp.p);
+
+    cfe_error err = cfe_baby_giant_with_neg_parallel(res, dp.h, dp.g, dp.p, dp.q, bound, 4);
+
+    munit_assert(err == 0);
+    munit_assert(mpz_cmp(res, dp.x) == 0);
+
+    // the same with the number of threads set globally
+    cfe_dlog_set_num_threads(3);
+    munit_assert(cfe_dlog_get_num_threads() == 3);
+    mpz_set_ui(res, 0);
+    err = cfe_baby_giant_with_neg(res, dp.h, dp.g, dp.p, dp.q, bound);
+    cfe_dlog_set_num_threads(1);
+
+    munit_assert(err == 0);
+    munit_assert(mpz_cmp(res, dp.x) == 0);
+
+    mpz_clears(dp.h, dp.g, dp.p, dp.x, dp.q, res, bound, bound_neg, NULL);
+    return MUNIT_OK;
+}
+
+// cancels the computation after the first report
+static int cancel_progress(uint64_t steps, uint64_t expected_steps, void *data) {
+    int *calls = (int *) data;
+    (*calls)++;
+    return 1;
+}
+
+MunitResult test_pollard_rho_parallel(const MunitParameter params[], void *data) {
+    dlog_params dp;
+    random_dlog_params(&dp, 40);
+
+    mpz_t res;
+    mpz_init(res);
+
+    cfe_error err = cfe_pollard_rho_parallel(res, dp.h, dp.g, dp.p, dp.q, 4, NULL, NULL);
+
+    munit_assert(err == 0);
+    munit_assert(mpz_cmp(res, dp.x) == 0);
+
+    // a large group, in which the computation gets cancelled
+    dlog_params dp_large;
+    random_dlog_params(&dp_large, 128);
+    int calls = 0;
+    err = cfe_pollard_rho_parallel(res, dp_large.h, dp_large.g, dp_large.p, dp_large.q, 2, cancel_progress, &calls);
+
+    munit_assert(err == CFE_ERR_CANCELLED);
+    munit_assert(calls == 1);
+
+    mpz_clears(dp.h, dp.g, dp.p, dp.x, dp.q, res, NULL);
+    mpz_clears(dp_large.h, dp_large.g, dp_large.p, dp_large.x, dp_large.q, NULL);
+    return MUNIT_OK;
+}
+
+MunitResult test_kangaroo(const MunitParameter params[], void *data) {
+    dlog_params dp;
+    random_dlog_params(&dp, 128);
+    mpz_t res, bound, bound_neg;
+    mpz_inits(res, bound, bound_neg, NULL);
+    mpz_set_ui(bound, 2);
+    mpz_pow_ui(bound, bound, 30);
+    mpz_neg(bound_neg, bound);
+
+    cfe_uniform_sample_range(dp.x, bound_neg, bound);
+    mpz_powm(dp.h, dp.g, dp.x, dp.p);
+
+    cfe_error err = cfe_kangaroo_with_neg(res, dp.h, dp.g, dp.p, bound);
+
+    munit_assert(err == 0);
+    munit_assert(mpz_cmp(res, dp.x) == 0);
+
+    // the solution is not in the interval
+    mpz_set_ui(bound, 1000);
+    mpz_set_ui(dp.x, 1000000);
+    mpz_powm(dp.h, dp.g, dp.x, dp.p);
+
+    err = cfe_kangaroo_with_neg(res, dp.h, dp.g, dp.p, bound);
+    munit_assert(err == CFE_ERR_DLOG_NOT_FOUND);
+
+    mpz_clears(dp.h, dp.g, dp.p, dp.x, dp.q, res, bound, bound_neg, NULL);
+    return MUNIT_OK;
+}
+
+MunitResult test_kangaroo_parallel(const MunitParameter params[], void *data) {
+    dlog_params dp;
+    random_dlog_params(&dp, 128);
+    mpz_t res, bound, bound_neg;
+    mpz_inits(res, bound, bound_neg, NULL);
+    mpz_set_ui(bound, 2);
+    mpz_pow_ui(bound, bound, 32);
+    mpz_neg(bound_neg, bound);
+
+    cfe_uniform_sample_range(dp.x, bound_neg, bound);
+    mpz_powm(dp.h, dp.g, dp.x, dp.p);
+
+    cfe_error err = cfe_kangaroo_with_neg_parallel(res, dp.h, dp.g, dp.p, bound, 4);
+
+    munit_assert(err == 0);
+    munit_assert(mpz_cmp(res, dp.x) == 0);
+
     mpz_clears(dp.h, dp.g, dp.p, dp.x, dp.q, res, bound, bound_neg, NULL);
     return MUNIT_OK;
 }
@@ -222,14 +506,285 @@ MunitResult test_baby_step_giant_step_BN254(const MunitParameter params[], void
     return MUNIT_OK;
 }
 
+MunitResult test_baby_step_giant_step_BN254_batch(const MunitParameter params[], void *data) {
+    size_t n = 6;
+    dlog_BN254_params dp[6];
+    FP12_BN254 h[6];
+    mpz_t res[6];
+    for (size_t k = 0; k < n; k++) {
+        random_dlog_BN254_params(&dp[k]);
+        FP12_BN254_copy(&h[k], &dp[k].h);
+        mpz_init(res[k]);
+    }
+
+    cfe_error err = cfe_baby_giant_FP12_BN256_batch_with_neg(res, NULL, h, n, &dp[0].g, dp[0].bound);
+    munit_assert(err == 0);
+    for (size_t k = 0; k < n; k++) {
+        munit_assert(mpz_cmp(res[k], dp[k].x) == 0);
+    }
+
+    for (size_t k = 0; k < n; k++) {
+        mpz_clears(dp[k].x, dp[k].bound, res[k], NULL);
+    }
+    return MUNIT_OK;
+}
+
+MunitResult test_dlog_config_BN254(const MunitParameter params[], void *data) {
+    dlog_BN254_params dp;
+    random_dlog_BN254_params(&dp);
+    mpz_t res;
+    mpz_init(res);
+
+    cfe_dlog_config c;
+    cfe_dlog_config_init(&c);
+    c.baby_steps = 8;
+    c.algorithm = CFE_DLOG_BSGS;
+    cfe_error err = cfe_dlog_FP12_BN254_with_neg(res, &dp.h, &dp.g, dp.bound, &c);
+    munit_assert(err == 0);
+    munit_assert(mpz_cmp(res, dp.x) == 0);
+
+    c.algorithm = CFE_DLOG_KANGAROO;
+    err = cfe_dlog_FP12_BN254_with_neg(res, &dp.h, &dp.g, dp.bound, &c);
+    munit_assert(err == 0);
+    munit_assert(mpz_cmp(res, dp.x) == 0);
+
+    mpz_clears(dp.x, dp.bound, res, NULL);
+    return MUNIT_OK;
+}
+
+MunitResult test_dlog_table_BN254(const MunitParameter params[], void *data) {
+    dlog_BN254_params dp;
+    random_dlog_BN254_params(&dp);
+    mpz_t res;
+    mpz_init(res);
+
+    // build the table once and use it for several elements
+    cfe_dlog_table_FP12_BN254 t;
+    cfe_error err = cfe_dlog_table_FP12_BN254_init(&t, &dp.g, dp.bound);
+    munit_assert(err == 0);
+
+    for (int i = 0; i < 5; i++) {
+        err = cfe_dlog_table_FP12_BN254_solve_with_neg(res, &dp.h, &t);
+        munit_assert(err == 0);
+        munit_assert(mpz_cmp(res, dp.x) == 0);
+
+        mpz_clears(dp.x, dp.bound, NULL);
+        random_dlog_BN254_params(&dp);
+    }
+
+    // the same with the giant steps split among threads
+    t.num_threads = 4;
+    err = cfe_dlog_table_FP12_BN254_solve_with_neg(res, &dp.h, &t);
+    munit_assert(err == 0);
+    munit_assert(mpz_cmp(res, dp.x) == 0);
+
+    cfe_dlog_table_FP12_BN254_free(&t);
+    mpz_clears(dp.x, dp.bound, res, NULL);
+    return MUNIT_OK;
+}
+
+// sets h = x*g for the generator g of the group ECP_BN254
+static void G1_from_mpz(ECP_BN254 *h, mpz_t x) {
+    cfe_vec x_vec;
+    cfe_vec_G1 h_vec;
+    cfe_vec_init(&x_vec, 1);
+    cfe_vec_G1_init(&h_vec, 1);
+    cfe_vec_set(&x_vec, x, 0);
+    cfe_vec_mul_G1(&h_vec, &x_vec);
+    ECP_BN254_copy(h, &h_vec.vec[0]);
+    cfe_vec_free(&x_vec);
+    cfe_vec_G1_free(&h_vec);
+}
+
+MunitResult test_dlog_table_ECP_BN254(const MunitParameter params[], void *data) {
+    mpz_t bound, bound_neg, x, res;
+    mpz_inits(bound, bound_neg, x, res, NULL);
+    mpz_set_ui(bound, 1024);
+    mpz_neg(bound_neg, bound);
+    ECP_BN254 g, h;
+    ECP_BN254_generator(&g);
+
+    // a table with the default number of baby steps, and one with only a
+    // few of them, so that giant steps in both directions are needed
+    cfe_dlog_config conf;
+    cfe_dlog_config_init(&conf);
+    conf.baby_steps = 7;
+    cfe_dlog_config *confs[] = {NULL, &conf};
+    long fixed[] = {0, 1, -1, 7, -7, 13, -13, 1024, -1024};
+
+    for (size_t k = 0; k < 2; k++) {
+        cfe_dlog_table_ECP_BN254 t;
+        cfe_error err = cfe_dlog_table_ECP_BN254_init_with_config(&t, &g, bound, confs[k]);
+        munit_assert(err == 0);
+
+        for (size_t i = 0; i < sizeof(fixed) / sizeof(fixed[0]) + 5; i++) {
+            if (i < sizeof(fixed) / sizeof(fixed[0])) {
+                mpz_set_si(x, fixed[i]);
+            } else {
+                cfe_uniform_sample_range(x, bound_neg, bound);
+            }
+            G1_from_mpz(&h, x);
+
+            err = cfe_dlog_table_ECP_BN254_solve_with_neg(res, &h, &t);
+            munit_assert(err == 0);
+            munit_assert(mpz_cmp(res, x) == 0);
+        }
+
+        // the same with the giant steps split among threads
+        t.num_threads = 4;
+        err = cfe_dlog_table_ECP_BN254_solve_with_neg(res, &h, &t);
+        munit_assert(err == 0);
+        munit_assert(mpz_cmp(res, x) == 0);
+
+        // a solution far outside of the bound is not found
+        mpz_set_ui(x, 1000000);
+        G1_from_mpz(&h, x);
+        err = cfe_dlog_table_ECP_BN254_solve_with_neg(res, &h, &t);
+        munit_assert(err == CFE_ERR_DLOG_NOT_FOUND);
+
+        cfe_dlog_table_ECP_BN254_free(&t);
+    }
+
+    mpz_set_si(x, -555);
+    G1_from_mpz(&h, x);
+    cfe_error err = cfe_baby_giant_ECP_BN254_with_neg(res, &h, &g, bound);
+    munit_assert(err == 0);
+    munit_assert(mpz_cmp(res, x) == 0);
+
+    mpz_clears(bound, bound_neg, x, res, NULL);
+    return MUNIT_OK;
+}
+
+MunitResult test_dlog_table_BN254_file(const MunitParameter params[], void *data) {
+    dlog_BN254_params dp;
+    random_dlog_BN254_params(&dp);
+    mpz_t res, other_bound;
+    mpz_inits(res, other_bound, NULL);
+    const char *path = "cifer_dlog_table_test.bin";
+
+    cfe_dlog_table_FP12_BN254 t, t_loaded;
+    cfe_error err = cfe_dlog_table_FP12_BN254_init(&t, &dp.g, dp.bound);
+    munit_assert(err == 0);
+    err = cfe_dlog_table_FP12_BN254_save(&t, path);
+    munit_assert(err == 0);
+    cfe_dlog_table_FP12_BN254_free(&t);
+
+    err = cfe_dlog_table_FP12_BN254_load(&t_loaded, path, &dp.g, dp.bound);
+    munit_assert(err == 0);
+    err = cfe_dlog_table_FP12_BN254_solve_with_neg(res, &dp.h, &t_loaded);
+    munit_assert(err == 0);
+    munit_assert(mpz_cmp(res, dp.x) == 0);
+    cfe_dlog_table_FP12_BN254_free(&t_loaded);
+
+    // the file does not match a different bound or generator
+    mpz_mul_ui(other_bound, dp.bound, 2);
+    err = cfe_dlog_table_FP12_BN254_load(&t_loaded, path, &dp.g, other_bound);
+    munit_assert(err == CFE_ERR_MALFORMED_INPUT);
+    FP12_BN254_sqr(&dp.h, &dp.g);
+    err = cfe_dlog_table_FP12_BN254_load(&t_loaded, path, &dp.h, dp.bound);
+    munit_assert(err == CFE_ERR_MALFORMED_INPUT);
+
+    remove(path);
+    err = cfe_dlog_table_FP12_BN254_load(&t_loaded, path, &dp.g, dp.bound);
+    munit_assert(err == CFE_ERR_INIT);
+
+    mpz_clears(dp.x, dp.bound, res, other_bound, NULL);
+    return MUNIT_OK;
+}
+
+// overwrites the index of the first filled slot of a table file, or of
+// all the slots if all is true; the indices fill the end of the file
+void damage_dlog_table_file(const char *path, cfe_dlog_table_FP12_BN254 *t, uint32_t val, bool all) {
+    size_t capacity = (size_t) 1 << t->T.log_capacity;
+    FILE *f = fopen(path, "r+b");
+    munit_assert(f != NULL);
+    for (size_t i = 0; i < capacity; i++) {
+        if (all || t->T.vals[i] != UINT32_MAX) {
+            long offset = (long) ((capacity - i) * sizeof(uint32_t));
+            munit_assert(fseek(f, -offset, SEEK_END) == 0);
+            munit_assert(fwrite(&val, sizeof(uint32_t), 1, f) == 1);
+            if (!all) {
+                break;
+            }
+        }
+    }
+    fclose(f);
+}
+
+MunitResult test_dlog_table_BN254_file_damaged(const MunitParameter params[], void *data) {
+    dlog_BN254_params dp;
+    random_dlog_BN254_params(&dp);
+    const char *path = "cifer_dlog_table_test.bin";
+
+    cfe_dlog_table_FP12_BN254 t, t_loaded;
+    cfe_error err = cfe_dlog_table_FP12_BN254_init(&t, &dp.g, dp.bound);
+    munit_assert(err == 0);
+
+    // a table without an empty slot would make the lookups loop forever
+    err = cfe_dlog_table_FP12_BN254_save(&t, path);
+    munit_assert(err == 0);
+    damage_dlog_table_file(path, &t, 0, true);
+    err = cfe_dlog_table_FP12_BN254_load(&t_loaded, path, &dp.g, dp.bound);
+    munit_assert(err == CFE_ERR_MALFORMED_INPUT);
+
+    // an index of a baby step must be below the number of baby steps
+    err = cfe_dlog_table_FP12_BN254_save(&t, path);
+    munit_assert(err == 0);
+    damage_dlog_table_file(path, &t, (uint32_t) t.m, false);
+    err = cfe_dlog_table_FP12_BN254_load(&t_loaded, path, &dp.g, dp.bound);
+    munit_assert(err == CFE_ERR_MALFORMED_INPUT);
+
+    cfe_dlog_table_FP12_BN254_free(&t);
+    remove(path);
+    mpz_clears(dp.x, dp.bound, NULL);
+    return MUNIT_OK;
+}
+
+MunitResult test_kangaroo_BN254(const MunitParameter params[], void *data) {
+    dlog_BN254_params dp;
+    random_dlog_BN254_params(&dp);
+    mpz_t res;
+    mpz_init(res);
+
+    cfe_error err = cfe_kangaroo_FP12_BN254_with_neg(res, &dp.h, &dp.g, dp.bound);
+
+    munit_assert(err == 0);
+    munit_assert(mpz_cmp(res, dp.x) == 0);
+
+    mpz_set_ui(res, 0);
+    err = cfe_kangaroo_FP12_BN254_with_neg_parallel(res, &dp.h, &dp.g, dp.bound, 3);
+
+    munit_assert(err == 0);
+    munit_assert(mpz_cmp(res, dp.x) == 0);
+
+    mpz_clears(dp.x, dp.bound, res, NULL);
+    return MUNIT_OK;
+}
+
 MunitTest dlog_tests[] = {
         {(char *) "/baby-giant-fixed",    test_baby_step_giant_step_fixed,    NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
         {(char *) "/baby-giant-bounded",  test_baby_step_giant_step_bounded,  NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
         {(char *) "/baby-giant",          test_baby_step_giant_step,          NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
         {(char *) "/baby-giant-with-neg", test_baby_step_giant_step_with_neg, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/baby-giant-parallel", test_baby_step_giant_step_parallel, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/dlog-table",          test_dlog_table,                    NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/dlog-table-batch",    test_dlog_table_batch,              NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/dlog-config",         test_dlog_config,                   NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/kangaroo",            test_kangaroo,                      NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/kangaroo-parallel",   test_kangaroo_parallel,             NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
         {(char *) "/pollard-rho-fixed",   test_pollard_rho_fixed,             NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
         {(char *) "/pollard-rho",         test_pollard_rho,                   NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/pollard-rho-parallel", test_pollard_rho_parallel,         NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
         {(char *) "/baby-giant-BN254",    test_baby_step_giant_step_BN254,    NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/baby-giant-BN254-batch", test_baby_step_giant_step_BN254_batch, NULL, NULL, MUNIT_TEST_OPTION_NONE,
+         NULL},
+        {(char *) "/dlog-config-BN254",   test_dlog_config_BN254,             NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/dlog-table-BN254",    test_dlog_table_BN254,              NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/kangaroo-BN254",      test_kangaroo_BN254,                NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/dlog-table-BN254-file", test_dlog_table_BN254_file,       NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/dlog-table-BN254-file-damaged", test_dlog_table_BN254_file_damaged, NULL, NULL,
+         MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/dlog-table-ECP-BN254", test_dlog_table_ECP_BN254,       NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
         {NULL, NULL,                                                          NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
 };
 
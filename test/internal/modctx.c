@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2018 XLAB d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+
+#include "munit.h"
+
+#include "cifer/internal/modctx.h"
+#include "cifer/sample/uniform.h"
+
+MunitResult test_modctx_mul(const MunitParameter params[], void *data) {
+    mpz_t m, a, b, res, expected;
+    mpz_inits(m, a, b, res, expected, NULL);
+
+    // a single limb, a modulus with the top bit of its top limb set, and
+    // a few limbs
+    size_t bits[] = {61, 256, 1027};
+    for (size_t k = 0; k < 3; k++) {
+        mpz_set_ui(m, 0);
+        mpz_setbit(m, bits[k] - 1);
+        cfe_uniform_sample(res, m);
+        mpz_add(m, m, res);
+        mpz_setbit(m, 0);
+
+        cfe_modctx ctx, ctx_copy;
+        munit_assert(cfe_modctx_init(&ctx, m) == CFE_ERR_NONE);
+        cfe_modctx_copy(&ctx_copy, &ctx);
+        mp_limb_t *x = cfe_modctx_alloc(&ctx, 3);
+        mp_limb_t *y = x + ctx.n;
+        mp_limb_t *z = y + ctx.n;
+
+        for (int i = 0; i < 20; i++) {
+            cfe_uniform_sample(a, m);
+            cfe_uniform_sample(b, m);
+            // negative and unreduced integers
+            if (i % 4 == 1) {
+                mpz_neg(a, a);
+            } else if (i % 4 == 2) {
+                mpz_mul(b, b, m);
+                mpz_add_ui(b, b, i);
+            }
+
+            cfe_modctx_set(&ctx, x, a);
+            cfe_modctx_set(&ctx, y, b);
+            cfe_modctx_get(&ctx, res, x);
+            mpz_mod(expected, a, m);
+            munit_assert(mpz_cmp(res, expected) == 0);
+
+            cfe_modctx_mul(&ctx, z, x, y);
+            cfe_modctx_get(&ctx_copy, res, z);
+            mpz_mul(expected, a, b);
+            mpz_mod(expected, expected, m);
+            munit_assert(mpz_cmp(res, expected) == 0);
+
+            cfe_modctx_sqr(&ctx, x, x);
+            cfe_modctx_mul(&ctx, y, y, y);
+            cfe_modctx_mul(&ctx, x, x, y);
+            cfe_modctx_get(&ctx, res, x);
+            mpz_powm_ui(expected, expected, 2, m);
+            munit_assert(mpz_cmp(res, expected) == 0);
+        }
+
+        // the largest element
+        mpz_sub_ui(a, m, 1);
+        cfe_modctx_set(&ctx, x, a);
+        cfe_modctx_sqr(&ctx, x, x);
+        munit_assert(cfe_modctx_is_one(&ctx, x));
+        cfe_modctx_get(&ctx, res, x);
+        munit_assert(mpz_cmp_ui(res, 1) == 0);
+
+        mpz_set_ui(a, 0);
+        cfe_modctx_set(&ctx, x, a);
+        cfe_modctx_get(&ctx, res, x);
+        munit_assert(mpz_cmp_ui(res, 0) == 0);
+        cfe_modctx_set_one(&ctx, y);
+        munit_assert(!cfe_modctx_is_one(&ctx, x));
+        munit_assert(cfe_modctx_is_one(&ctx, y));
+
+        free(x);
+        cfe_modctx_free(&ctx);
+        cfe_modctx_free(&ctx_copy);
+    }
+
+    mpz_clears(m, a, b, res, expected, NULL);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_modctx_even(const MunitParameter params[], void *data) {
+    mpz_t m;
+    mpz_init(m);
+    cfe_modctx ctx;
+
+    long moduli[] = {1024, 2, 1, 0, -7};
+    for (size_t k = 0; k < 5; k++) {
+        mpz_set_si(m, moduli[k]);
+        munit_assert(cfe_modctx_init(&ctx, m) == CFE_ERR_MALFORMED_INPUT);
+    }
+
+    mpz_clear(m);
+
+    return MUNIT_OK;
+}
+
+MunitTest modctx_tests[] = {
+        {(char *) "/mul", test_modctx_mul,   NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/even", test_modctx_even, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {NULL, NULL,                         NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
+};
+
+MunitSuite modctx_suite = {
+        (char *) "/internal/modctx", modctx_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE
+};
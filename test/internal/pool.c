@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2018 XLAB d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdatomic.h>
+
+#include "munit.h"
+
+#include "cifer/internal/pool.h"
+
+// fills the value with consecutive numbers from a shared counter, so that
+// every value ever computed is different
+static void counter_fill(cfe_vec *elem, void *data) {
+    atomic_ulong *counter = (atomic_ulong *) data;
+    unsigned long c = atomic_fetch_add(counter, 1);
+    for (size_t i = 0; i < elem->size; i++) {
+        mpz_set_ui(elem->vec[i], c);
+    }
+}
+
+MunitResult test_pool(const MunitParameter params[], void *data) {
+    size_t n = 200;
+    cfe_vec elem;
+    cfe_vec_init(&elem, 2);
+    mpz_t seen[n];
+
+    for (int background = 0; background < 2; background++) {
+        atomic_ulong counter = 0;
+        cfe_pool pool;
+        cfe_pool_init(&pool, 16, 2, counter_fill, NULL, &counter, background);
+        if (!background) {
+            munit_assert(cfe_pool_len(&pool) == 0);
+            cfe_pool_fill(&pool);
+            munit_assert(cfe_pool_len(&pool) == 16);
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            cfe_pool_take(&elem, &pool);
+            munit_assert(mpz_cmp(elem.vec[0], elem.vec[1]) == 0);
+            mpz_init_set(seen[i], elem.vec[0]);
+            for (size_t j = 0; j < i; j++) {
+                munit_assert(mpz_cmp(seen[i], seen[j]) != 0);
+            }
+        }
+
+        cfe_pool_free(&pool);
+        for (size_t i = 0; i < n; i++) {
+            mpz_clear(seen[i]);
+        }
+    }
+
+    cfe_vec_free(&elem);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_pool_try_take(const MunitParameter params[], void *data) {
+    atomic_ulong counter = 0;
+    cfe_pool pool;
+    cfe_pool_init(&pool, 3, 1, counter_fill, NULL, &counter, false);
+
+    cfe_vec elem;
+    cfe_vec_init(&elem, 1);
+
+    // an empty pool does not compute a value
+    munit_assert(!cfe_pool_try_take(&elem, &pool));
+    munit_assert(atomic_load(&counter) == 0);
+
+    // values come out first in, first out
+    cfe_pool_fill(&pool);
+    for (unsigned long i = 0; i < 3; i++) {
+        munit_assert(cfe_pool_try_take(&elem, &pool));
+        munit_assert(mpz_cmp_ui(elem.vec[0], i) == 0);
+    }
+    munit_assert(!cfe_pool_try_take(&elem, &pool));
+
+    cfe_vec_free(&elem);
+    cfe_pool_free(&pool);
+
+    return MUNIT_OK;
+}
+
+MunitTest pool_tests[] = {
+        {(char *) "/take",     test_pool,          NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/try-take", test_pool_try_take, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {NULL, NULL,                               NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
+};
+
+MunitSuite pool_suite = {
+        (char *) "/internal/pool", pool_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE
+};
@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2018 XLAB d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+
+#include "munit.h"
+
+#include "cifer/internal/keygen.h"
+#include "cifer/internal/powm.h"
+#include "cifer/sample/uniform.h"
+
+MunitResult test_fixed_base_powm(const MunitParameter params[], void *data) {
+    cfe_elgamal key;
+    cfe_elgamal_init(&key, 256);
+    size_t bits = mpz_sizeinbase(key.q, 2);
+
+    cfe_fixed_base fb, fb_small, fb_copy;
+    cfe_fixed_base_init(&fb, key.g, key.p, bits);
+    // parameters where the blocks do not divide the pieces evenly
+    cfe_fixed_base_init_params(&fb_small, key.g, key.p, bits, 3, 5);
+    cfe_fixed_base_copy(&fb_copy, &fb);
+
+    mpz_t e, res, expected, bound;
+    mpz_inits(e, res, expected, bound, NULL);
+    mpz_set_ui(bound, 1);
+    mpz_mul_2exp(bound, bound, bits);
+
+    for (int i = 0; i < 50; i++) {
+        cfe_uniform_sample(e, bound);
+        // small, negative and too long exponents
+        if (i % 5 == 1) {
+            mpz_set_si(e, i - 25);
+        } else if (i % 5 == 2) {
+            mpz_neg(e, e);
+        } else if (i % 5 == 3) {
+            mpz_mul(e, e, bound);
+        }
+        mpz_powm(expected, key.g, e, key.p);
+
+        cfe_fixed_base_powm(res, &fb, e);
+        munit_assert(mpz_cmp(res, expected) == 0);
+        cfe_fixed_base_powm(res, &fb_small, e);
+        munit_assert(mpz_cmp(res, expected) == 0);
+        cfe_fixed_base_powm(e, &fb_copy, e);
+        munit_assert(mpz_cmp(e, expected) == 0);
+    }
+
+    mpz_set_ui(e, 0);
+    cfe_fixed_base_powm(res, &fb, e);
+    munit_assert(mpz_cmp_ui(res, 1) == 0);
+
+    mpz_clears(e, res, expected, bound, NULL);
+    cfe_fixed_base_free(&fb);
+    cfe_fixed_base_free(&fb_small);
+    cfe_fixed_base_free(&fb_copy);
+    cfe_elgamal_free(&key);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_fixed_base_vec_batch(const MunitParameter params[], void *data) {
+    cfe_elgamal key;
+    cfe_elgamal_init(&key, 256);
+    size_t size = 4, n = 7;
+
+    cfe_vec bases;
+    cfe_vec_init(&bases, size);
+    cfe_uniform_sample_vec(&bases, key.p);
+    cfe_vec *exps = (cfe_vec *) malloc(n * sizeof(cfe_vec));
+    mpz_t *res = (mpz_t *) malloc(n * sizeof(mpz_t));
+    cfe_error errs[7];
+
+    // a long exponent for the first base and short signed ones for the
+    // others, as when decrypting with many keys
+    mpz_t bound, expected;
+    mpz_inits(bound, expected, NULL);
+    size_t bits[] = {256, 10, 10, 10};
+    for (size_t k = 0; k < n; k++) {
+        cfe_vec_init(&exps[k], size);
+        mpz_init(res[k]);
+        for (size_t i = 0; i < size; i++) {
+            mpz_set_ui(bound, 1);
+            mpz_mul_2exp(bound, bound, bits[i]);
+            cfe_uniform_sample(exps[k].vec[i], bound);
+            if ((k + i) % 2 == 1) {
+                mpz_neg(exps[k].vec[i], exps[k].vec[i]);
+            }
+        }
+    }
+
+    cfe_fixed_base_vec fbv;
+    cfe_fixed_base_vec_init_batch(&fbv, &bases, key.p, bits, n);
+    for (size_t num_threads = 0; num_threads <= 3; num_threads++) {
+        cfe_error err = cfe_fixed_base_vec_powm_batch(res, errs, &fbv, exps, n, num_threads);
+        munit_assert(err == CFE_ERR_NONE);
+        for (size_t k = 0; k < n; k++) {
+            munit_assert(errs[k] == CFE_ERR_NONE);
+            err = cfe_multi_powm(expected, &bases, &exps[k], key.p);
+            munit_assert(err == CFE_ERR_NONE);
+            munit_assert(mpz_cmp(res[k], expected) == 0);
+        }
+    }
+    cfe_vec_free(&exps[0]);
+    cfe_vec_init(&exps[0], size + 1);
+    munit_assert(cfe_fixed_base_vec_powm(res[0], &fbv, &exps[0]) == CFE_ERR_MALFORMED_INPUT);
+
+    for (size_t k = 0; k < n; k++) {
+        cfe_vec_free(&exps[k]);
+        mpz_clear(res[k]);
+    }
+    free(exps);
+    free(res);
+    mpz_clears(bound, expected, NULL);
+    cfe_fixed_base_vec_free(&fbv);
+    cfe_vec_free(&bases);
+    cfe_elgamal_free(&key);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_small_powers(const MunitParameter params[], void *data) {
+    cfe_elgamal key;
+    cfe_elgamal_init(&key, 256);
+
+    mpz_t k, res, expected, bound;
+    mpz_inits(k, res, expected, bound, NULL);
+
+    // a single table, a split table and a bound too large for the tables
+    unsigned long bounds[] = {100, 100000, 1UL << CFE_SMALL_POWERS_MAX_BITS};
+    for (size_t b = 0; b < 3; b++) {
+        mpz_set_ui(bound, bounds[b]);
+        cfe_small_powers t, t_copy;
+        cfe_small_powers_init(&t, key.g, key.p, bound);
+        cfe_small_powers_copy(&t_copy, &t);
+
+        for (long i = -1000; i <= 1000; i++) {
+            mpz_set_si(k, i * (long) bounds[b] / 1000);
+            if (i == 1000) {
+                mpz_add_ui(k, k, 1);
+            }
+            mpz_powm(expected, key.g, k, key.p);
+
+            bool in_table = b < 2 && i < 1000;
+            munit_assert(cfe_small_powers_get(res, &t, k) == in_table);
+            if (in_table) {
+                munit_assert(mpz_cmp(res, expected) == 0);
+                munit_assert(cfe_small_powers_get(k, &t_copy, k));
+                munit_assert(mpz_cmp(k, expected) == 0);
+            }
+        }
+
+        cfe_small_powers_free(&t);
+        cfe_small_powers_free(&t_copy);
+    }
+
+    mpz_clears(k, res, expected, bound, NULL);
+    cfe_elgamal_free(&key);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_multi_powm(const MunitParameter params[], void *data) {
+    cfe_elgamal key;
+    cfe_elgamal_init(&key, 256);
+
+    mpz_t res, expected, t, bound, n_square;
+    mpz_inits(res, expected, t, bound, n_square, NULL);
+    // a composite modulus, like in Paillier
+    mpz_mul(n_square, key.p, key.q);
+    mpz_mul(n_square, n_square, n_square);
+
+    size_t k = 12;
+    cfe_vec bases, exps;
+    cfe_vec_inits(k, &bases, &exps, NULL);
+    mpz_t *moduli[] = {&key.p, &n_square};
+    for (size_t m = 0; m < 2; m++) {
+        mpz_t *mod = moduli[m];
+        cfe_uniform_sample_vec(&bases, *mod);
+        // exponents of all sizes and signs, including zero
+        for (size_t i = 0; i < k; i++) {
+            mpz_set_ui(bound, 1);
+            mpz_mul_2exp(bound, bound, 1 + 30 * i);
+            cfe_uniform_sample(exps.vec[i], bound);
+            if (i % 2 == 1) {
+                mpz_neg(exps.vec[i], exps.vec[i]);
+            }
+        }
+        mpz_set_ui(exps.vec[0], 0);
+
+        // the second time with one exponent much longer than the others
+        for (size_t v = 0; v < 2; v++) {
+            if (v == 1) {
+                mpz_mul_2exp(exps.vec[1], exps.vec[1], 2000);
+            }
+            mpz_set_ui(expected, 1);
+            for (size_t i = 0; i < k; i++) {
+                mpz_powm(t, bases.vec[i], exps.vec[i], *mod);
+                mpz_mul(expected, expected, t);
+                mpz_mod(expected, expected, *mod);
+            }
+
+            cfe_error err = cfe_multi_powm(res, &bases, &exps, *mod);
+            munit_assert(err == 0);
+            munit_assert(mpz_cmp(res, expected) == 0);
+        }
+
+        // a base with a negative exponent that cannot be inverted
+        mpz_set(bases.vec[1], key.p);
+        cfe_error err = cfe_multi_powm(res, &bases, &exps, *mod);
+        munit_assert(err == CFE_ERR_NO_INVERSE);
+    }
+
+    cfe_vec_frees(&bases, &exps, NULL);
+    mpz_clears(res, expected, t, bound, n_square, NULL);
+    cfe_elgamal_free(&key);
+
+    return MUNIT_OK;
+}
+
+MunitTest powm_tests[] = {
+        {(char *) "/fixed-base", test_fixed_base_powm,                NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/fixed-base-vec-batch", test_fixed_base_vec_batch, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/small-powers", test_small_powers,                 NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/multi-powm", test_multi_powm,                     NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {NULL, NULL,                                                  NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
+};
+
+MunitSuite powm_suite = {
+        (char *) "/internal/powm", powm_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE
+};
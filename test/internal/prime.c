@@ -72,11 +72,39 @@ MunitResult test_get_safe_prime(const MunitParameter params[], void *data) {
     return MUNIT_OK;
 }
 
+MunitResult test_get_prime_parallel(const MunitParameter params[], void *data) {
+    mpz_t p;
+    mpz_init(p);
+
+    cfe_error err = cfe_get_prime_parallel(p, 512, true, 4);
+    munit_assert(!err);
+    munit_assert(mpz_sizeinbase(p, 2) == 512);
+    munit_assert(cfe_is_safe_prime(p));
+
+    // small bit lengths, for which only some of the small primes are sieved
+    for (size_t bits = 10; bits <= 24; bits++) {
+        err = cfe_get_prime_parallel(p, bits, false, 2);
+        munit_assert(!err);
+        munit_assert(mpz_sizeinbase(p, 2) == bits);
+        munit_assert(mpz_probab_prime_p(p, 20));
+
+        err = cfe_get_prime_parallel(p, bits, true, 2);
+        munit_assert(!err);
+        munit_assert(mpz_sizeinbase(p, 2) == bits);
+        munit_assert(cfe_is_safe_prime(p));
+    }
+
+    mpz_clear(p);
+
+    return MUNIT_OK;
+}
+
 MunitTest prime_tests[] = {
-        {(char *) "/prime-generation/common", test_get_prime,      NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
-        {(char *) "/prime-generation/safe",   test_get_safe_prime, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
-        {(char *) "/safe-prime-check",        test_is_safe_prime,  NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
-        {NULL, NULL,                                               NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
+        {(char *) "/prime-generation/common",   test_get_prime,          NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/prime-generation/safe",     test_get_safe_prime,     NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/prime-generation/parallel", test_get_prime_parallel, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/safe-prime-check",          test_is_safe_prime,      NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {NULL, NULL,                                                     NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
 };
 
 MunitSuite prime_suite = {
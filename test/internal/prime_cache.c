@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2018 XLAB d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+
+#include "munit.h"
+
+#include "cifer/internal/prime.h"
+#include "cifer/internal/prime_cache.h"
+
+// counts the primes kept in the file
+static size_t count_primes(const char *path) {
+    FILE *f = fopen(path, "r");
+    munit_assert(f != NULL);
+    mpz_t p;
+    mpz_init(p);
+    size_t n = 0;
+    while (mpz_inp_str(p, f, 16) > 0) {
+        n++;
+    }
+    mpz_clear(p);
+    fclose(f);
+
+    return n;
+}
+
+MunitResult test_prime_cache_file(const MunitParameter params[], void *data) {
+    const char *path = "cifer_prime_cache_test.txt";
+    remove(path);
+
+    mpz_t p, q;
+    mpz_inits(p, q, NULL);
+
+    cfe_prime_cache c;
+    cfe_error err = cfe_prime_cache_init(&c, 128, true, 3, path, false);
+    munit_assert(!err);
+    munit_assert(cfe_prime_cache_len(&c) == 0);
+    err = cfe_prime_cache_fill(&c);
+    munit_assert(!err);
+    munit_assert(cfe_prime_cache_len(&c) == 3);
+    munit_assert(count_primes(path) == 3);
+
+    // the file cannot be used by another cache while it is open
+    cfe_prime_cache other;
+    err = cfe_prime_cache_init(&other, 128, true, 3, path, false);
+    munit_assert(err == CFE_ERR_INIT);
+    cfe_prime_cache_free(&c);
+
+    // the primes are loaded in the next run, and every prime taken is
+    // removed from the file
+    err = cfe_prime_cache_init(&c, 128, true, 3, path, false);
+    munit_assert(!err);
+    munit_assert(cfe_prime_cache_len(&c) == 3);
+    cfe_prime_cache_take(p, &c);
+    munit_assert(mpz_sizeinbase(p, 2) == 128);
+    munit_assert(cfe_is_safe_prime(p));
+    munit_assert(count_primes(path) == 2);
+    cfe_prime_cache_free(&c);
+
+    // primes of a different bit length or kind and corrupted lines are
+    // dropped
+    FILE *f = fopen(path, "a");
+    munit_assert(f != NULL);
+    cfe_get_prime_parallel(q, 128, false, 1);
+    mpz_out_str(f, 16, q);
+    fputs("\nzz\n", f);
+    mpz_sub_ui(q, p, 2);
+    mpz_out_str(f, 16, q);
+    fputs("\n", f);
+    fclose(f);
+    err = cfe_prime_cache_init(&c, 128, true, 5, path, false);
+    munit_assert(!err);
+    munit_assert(cfe_prime_cache_len(&c) == 2);
+    cfe_prime_cache_free(&c);
+    munit_assert(count_primes(path) == 2);
+
+    err = cfe_prime_cache_init(&c, 2, true, 1, NULL, false);
+    munit_assert(err == CFE_ERR_PRECONDITION_FAILED);
+
+    remove(path);
+    remove("cifer_prime_cache_test.txt.lock");
+    mpz_clears(p, q, NULL);
+
+    return MUNIT_OK;
+}
+
+MunitResult test_prime_cache_registered(const MunitParameter params[], void *data) {
+    mpz_t p, first;
+    mpz_inits(p, first, NULL);
+
+    for (int background = 0; background < 2; background++) {
+        cfe_prime_cache c;
+        cfe_error err = cfe_prime_cache_init(&c, 256, false, 2, NULL, background);
+        munit_assert(!err);
+        cfe_prime_cache_register(&c);
+
+        // cfe_get_prime takes the primes from the cache while it has any
+        // of the requested bit length and kind
+        if (!background) {
+            cfe_prime_cache_fill(&c);
+            cfe_prime_cache_take(first, &c);
+            cfe_prime_cache_fill(&c);
+            err = cfe_get_prime(p, 256, false);
+            munit_assert(!err);
+            munit_assert(cfe_prime_cache_len(&c) == 1);
+            munit_assert(mpz_cmp(p, first) != 0);
+            err = cfe_get_prime(p, 256, true);
+            munit_assert(!err);
+            munit_assert(cfe_is_safe_prime(p));
+            munit_assert(cfe_prime_cache_len(&c) == 1);
+        }
+        for (size_t i = 0; i < 3; i++) {
+            err = cfe_get_prime(p, 256, false);
+            munit_assert(!err);
+            munit_assert(mpz_sizeinbase(p, 2) == 256);
+            munit_assert(mpz_probab_prime_p(p, 20));
+        }
+
+        cfe_prime_cache_free(&c);
+    }
+
+    mpz_clears(p, first, NULL);
+
+    return MUNIT_OK;
+}
+
+MunitTest prime_cache_tests[] = {
+        {(char *) "/file",       test_prime_cache_file,       NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/registered", test_prime_cache_registered, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {NULL, NULL,                                          NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
+};
+
+MunitSuite prime_cache_suite = {
+        (char *) "/internal/prime-cache", prime_cache_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE
+};
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2018 XLAB d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+
+#include "munit.h"
+
+#include "cifer/internal/keygen.h"
+#include "cifer/internal/prod.h"
+#include "cifer/sample/uniform.h"
+
+MunitResult test_vec_prod_mod(const MunitParameter params[], void *data) {
+    cfe_elgamal key;
+    cfe_elgamal_init(&key, 256);
+    size_t size = 3;
+
+    mpz_t tmp;
+    mpz_init(tmp);
+    size_t max_n = 100;
+    cfe_vec *vecs = (cfe_vec *) malloc(max_n * sizeof(cfe_vec));
+    for (size_t i = 0; i < max_n; i++) {
+        cfe_vec_init(&vecs[i], size);
+        cfe_uniform_sample_vec(&vecs[i], key.p);
+    }
+    // negative and unreduced coordinates
+    mpz_neg(vecs[1].vec[0], vecs[1].vec[0]);
+    mpz_mul(vecs[2].vec[1], vecs[2].vec[1], key.p);
+    mpz_add_ui(vecs[2].vec[1], vecs[2].vec[1], 7);
+
+    cfe_vec res, expected;
+    cfe_vec_inits(size, &res, &expected, NULL);
+
+    size_t lens[] = {1, 17, max_n};
+    for (size_t k = 0; k < 3; k++) {
+        size_t n = lens[k];
+        for (size_t j = 0; j < size; j++) {
+            mpz_set_ui(expected.vec[j], 1);
+            for (size_t i = 0; i < n; i++) {
+                mpz_mul(expected.vec[j], expected.vec[j], vecs[i].vec[j]);
+                mpz_mod(expected.vec[j], expected.vec[j], key.p);
+            }
+        }
+
+        for (size_t num_threads = 0; num_threads <= 5; num_threads++) {
+            cfe_error err = cfe_vec_prod_mod(&res, vecs, n, key.p, num_threads);
+            munit_assert(err == CFE_ERR_NONE);
+            for (size_t j = 0; j < size; j++) {
+                munit_assert(mpz_cmp(res.vec[j], expected.vec[j]) == 0);
+            }
+        }
+    }
+
+    munit_assert(cfe_vec_prod_mod(&res, vecs, 0, key.p, 1) == CFE_ERR_MALFORMED_INPUT);
+    mpz_mul_ui(tmp, key.p, 2);
+    munit_assert(cfe_vec_prod_mod(&res, vecs, 2, tmp, 1) == CFE_ERR_MALFORMED_INPUT);
+    cfe_vec_free(&vecs[1]);
+    cfe_vec_init(&vecs[1], size + 1);
+    munit_assert(cfe_vec_prod_mod(&res, vecs, 2, key.p, 1) == CFE_ERR_MALFORMED_INPUT);
+
+    for (size_t i = 0; i < max_n; i++) {
+        cfe_vec_free(&vecs[i]);
+    }
+    free(vecs);
+    cfe_vec_frees(&res, &expected, NULL);
+    mpz_clear(tmp);
+    cfe_elgamal_free(&key);
+
+    return MUNIT_OK;
+}
+
+MunitTest prod_tests[] = {
+        {(char *) "/vec-prod-mod", test_vec_prod_mod, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {NULL, NULL,                                  NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
+};
+
+MunitSuite prod_suite = {
+        (char *) "/internal/prod", prod_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE
+};
@@ -90,8 +90,59 @@ MunitResult test_sgp_end_to_end(const MunitParameter *params, void *data) {
     return MUNIT_OK;
 }
 
+MunitResult test_sgp_dlog_table(const MunitParameter *params, void *data) {
+    size_t l = 5;
+    mpz_t b, b_neg, dec, xy;
+    mpz_inits(b, b_neg, dec, xy, NULL);
+    mpz_set_si(b, 8);
+    mpz_neg(b_neg, b);
+
+    cfe_sgp s;
+    cfe_error err = cfe_sgp_init(&s, l, b);
+    munit_assert(err == 0);
+    cfe_sgp_sec_key msk;
+    cfe_sgp_sec_key_init(&msk, &s);
+    cfe_sgp_generate_sec_key(&msk, &s);
+
+    cfe_vec x, y;
+    cfe_vec_inits(s.l, &x, &y, NULL);
+    cfe_uniform_sample_range_vec(&x, b_neg, b);
+    cfe_uniform_sample_range_vec(&y, b_neg, b);
+    cfe_sgp_cipher cipher;
+    cfe_sgp_cipher_init(&cipher, &s);
+    err = cfe_sgp_encrypt(&cipher, &s, &x, &y, &msk);
+    munit_assert(err == 0);
+
+    cfe_mat m;
+    cfe_mat_init(&m, l, l);
+    cfe_uniform_sample_range_mat(&m, b_neg, b);
+    ECP2_BN254 key;
+    err = cfe_sgp_derive_fe_key(&key, &s, &msk, &m);
+    munit_assert(err == 0);
+    cfe_mat_mul_x_mat_y(xy, &m, &x, &y);
+
+    // decrypt with a precomputed table of baby steps
+    cfe_dlog_table_FP12_BN254 t;
+    err = cfe_sgp_dlog_table_init(&t, &s);
+    munit_assert(err == 0);
+    err = cfe_sgp_decrypt_with_table(dec, &cipher, &key, &m, &t);
+    munit_assert(err == 0);
+    munit_assert(mpz_cmp(dec, xy) == 0);
+    cfe_dlog_table_FP12_BN254_free(&t);
+
+    cfe_vec_frees(&x, &y, NULL);
+    cfe_mat_free(&m);
+    cfe_sgp_free(&s);
+    cfe_sgp_sec_key_free(&msk);
+    cfe_sgp_cipher_free(&cipher);
+    mpz_clears(b, b_neg, dec, xy, NULL);
+
+    return MUNIT_OK;
+}
+
 MunitTest simple_sgp_tests[] = {
         {(char *) "/end-to-end", test_sgp_end_to_end, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+        {(char *) "/dlog-table", test_sgp_dlog_table, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
         {NULL, NULL,                                  NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}
 };
 
@@ -23,16 +23,23 @@ int main(int argc, char *argv[]) {
             keygen_suite,
             matrix_suite,
             prime_suite,
+            prime_cache_suite,
             vector_suite,
             dlog_suite,
+            modctx_suite,
+            pool_suite,
+            powm_suite,
+            prod_suite,
             big_suite,
             string_suite,
             ddh_suite,
             ddh_multi_suite,
+            ddh_ec_suite,
             lwe_suite,
             ring_lwe_suite,
             damgard_suite,
             damgard_multi_suite,
+            damgard_ec_suite,
             lwe_fully_secure_suite,
             paillier_suite,
             dmcfe_suite,
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2018 XLAB d.o.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Generates a file with a table of baby steps for computing discrete
+ * logarithms of base e(g1, g2) in the pairing group FP12_BN254, which can
+ * be mapped into memory with cfe_dlog_table_FP12_BN254_load (or
+ * cfe_sgp_dlog_table_load and cfe_dmcfe_dlog_table_load).
+ *
+ * Usage: cifer_dlog_table_gen <file> <bound> [<threads>]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <gmp.h>
+#include <amcl/pair_BN254.h>
+
+#include "cifer/internal/dlog.h"
+
+int main(int argc, char *argv[]) {
+    if (argc < 3 || argc > 4) {
+        fprintf(stderr, "usage: %s <file> <bound> [<threads>]\n", argv[0]);
+        return 1;
+    }
+
+    mpz_t bound;
+    if (mpz_init_set_str(bound, argv[2], 10) != 0 || mpz_sgn(bound) < 0) {
+        fprintf(stderr, "invalid bound: %s\n", argv[2]);
+        mpz_clear(bound);
+        return 1;
+    }
+
+    if (argc == 4) {
+        cfe_dlog_set_num_threads((size_t) strtoul(argv[3], NULL, 10));
+    }
+
+    ECP_BN254 g1;
+    ECP2_BN254 g2;
+    FP12_BN254 gt;
+    ECP_BN254_generator(&g1);
+    ECP2_BN254_generator(&g2);
+    PAIR_BN254_ate(&gt, &g2, &g1);
+    PAIR_BN254_fexp(&gt);
+
+    cfe_dlog_table_FP12_BN254 t;
+    cfe_error err = cfe_dlog_table_FP12_BN254_init(&t, &gt, bound);
+    if (err) {
+        fprintf(stderr, "the bound is too large\n");
+        mpz_clear(bound);
+        return 1;
+    }
+
+    err = cfe_dlog_table_FP12_BN254_save(&t, argv[1]);
+    if (err) {
+        fprintf(stderr, "could not write %s\n", argv[1]);
+    }
+
+    cfe_dlog_table_FP12_BN254_free(&t);
+    mpz_clear(bound);
+
+    return err ? 1 : 0;
+}